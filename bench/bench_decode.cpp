@@ -0,0 +1,95 @@
+#include <filesystem>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "texture_loader.h"
+
+using Clock = std::chrono::high_resolution_clock;
+
+static auto collect_images(const std::string& directory) -> std::vector<std::string>;
+
+// decodes count images from a directory (cycling through its jpeg/png files when it holds fewer) on
+// a texture loader with 1, 2, 4, ... decode threads and prints the throughput of each; --mips builds
+// the cpu mip chain on the decode threads too, as the loader does when mipmaps cannot be blitted
+//
+// vulkan_bench_decode [--dir path] [--count n] [--mips]
+auto main(int argc, char** argv) -> int {
+  std::string directory = "../textures";
+  std::size_t count = 64;
+  bool mips = false;
+
+  for(int i = 1; i < argc; ++i) {
+    if(std::strcmp(argv[i], "--dir") == 0 && i + 1 < argc) {
+      directory = argv[++i];
+    } else if(std::strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+      count = std::max<std::size_t>(std::stoul(argv[++i]), 1);
+    } else if(std::strcmp(argv[i], "--mips") == 0) {
+      mips = true;
+    } else {
+      std::cerr << "usage: " << argv[0] << " [--dir path] [--count n] [--mips]" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  auto files = collect_images(directory);
+  if(files.empty()) {
+    std::cerr << "no jpeg or png files in " << directory << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  auto max_threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  std::cout << count << " decodes of " << files.size() << " file(s) from " << directory << (mips ? ", with mip chains" : "") << "\n";
+  std::cout << "threads | ms | images/s | decoded MB/s | speedup\n";
+
+  auto baseline = 0.0;
+  for(std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+    thread_pool::ThreadPool pool(threads);
+    texture_loader::TextureLoader loader;
+    loader.create(pool, mips);
+
+    auto start = Clock::now();
+    for(std::size_t i = 0; i < count; ++i)
+      loader.request(i, files[i % files.size()]);
+    loader.wait();
+    auto milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::vector<texture_loader::Completed> completed;
+    loader.take_completed(completed);
+    std::size_t bytes = 0;
+    for(const auto& image : completed) {
+      if(!image.error.empty()) {
+        std::cerr << image.error << std::endl;
+        return EXIT_FAILURE;
+      }
+      bytes += image.image.pixels.size();
+    }
+    loader.destroy();
+
+    if(threads == 1) baseline = milliseconds;
+    std::cout << std::setw(7) << threads << " | " << std::fixed << std::setprecision(1) << milliseconds << " | "
+              << static_cast<double>(count) / (milliseconds / 1000.0) << " | "
+              << static_cast<double>(bytes) / (1024.0 * 1024.0) / (milliseconds / 1000.0) << " | "
+              << std::setprecision(2) << baseline / milliseconds << "x\n";
+  }
+
+  return EXIT_SUCCESS;
+}
+
+static auto collect_images(const std::string& directory) -> std::vector<std::string> {
+  std::vector<std::string> files;
+  std::error_code error;
+  for(const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+    auto extension = entry.path().extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if(entry.is_regular_file() && (extension == ".jpg" || extension == ".jpeg" || extension == ".png"))
+      files.push_back(entry.path().string());
+  }
+  std::sort(files.begin(), files.end());
+  return files;
+}
@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cmath>
+
+#include "job_system.h"
+
+// scheduler microbenchmarks; only the job system is linked, so these run without a gpu
+using Clock = std::chrono::high_resolution_clock;
+
+static auto spawn_overhead(std::size_t threads, std::size_t job_count) -> double {
+  auto jobs = job_system::JobSystem(threads);
+  job_system::Counter counter;
+
+  auto start = Clock::now();
+  for(std::size_t i = 0; i < job_count; ++i)
+    jobs.spawn([]{}, &counter);
+  jobs.wait(counter);
+  auto end = Clock::now();
+
+  return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(job_count);
+}
+
+static auto parallel_for_time(std::size_t threads, std::vector<float>& values) -> double {
+  auto jobs = job_system::JobSystem(threads);
+
+  auto start = Clock::now();
+  jobs.parallel_for(0, values.size(), 4096, [&values](std::size_t begin, std::size_t end) {
+    for(auto i = begin; i < end; ++i)
+      values[i] = std::sqrt(values[i] * 1.0001f + 1.0f);
+  });
+  auto end = Clock::now();
+
+  return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+auto main(void) -> int {
+  constexpr std::size_t JOB_COUNT = 1000000;
+  constexpr std::size_t ELEMENT_COUNT = 1 << 24;
+
+  // worker counts; the calling thread helps as well, so n workers use n + 1 threads
+  auto max_workers = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+  std::vector<std::size_t> worker_counts{0};
+  for(std::size_t workers = 1; workers <= max_workers; workers *= 2)
+    worker_counts.push_back(workers);
+
+  std::cout << "spawn + wait, " << JOB_COUNT << " empty jobs\n";
+  std::cout << "workers | ns/job\n";
+  for(auto workers : worker_counts)
+    std::cout << std::setw(7) << workers << " | " << std::fixed << std::setprecision(1) << spawn_overhead(workers, JOB_COUNT) << "\n";
+
+  std::vector<float> values(ELEMENT_COUNT, 1.0f);
+  std::cout << "\nparallel_for, " << ELEMENT_COUNT << " elements\n";
+  std::cout << "workers | us | speedup\n";
+  auto baseline = 0.0;
+  for(auto workers : worker_counts) {
+    auto micros = parallel_for_time(workers, values);
+    if(workers == 0) baseline = micros;
+    std::cout << std::setw(7) << workers << " | " << std::fixed << std::setprecision(1) << micros << " | " << std::setprecision(2) << baseline / micros << "x\n";
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,147 @@
+#include <filesystem>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+#include "asset_pack.h"
+
+struct Result {
+  double open_milliseconds{0.0};
+  double stage_milliseconds{0.0};
+  std::size_t bytes_copied{0};
+};
+
+static auto make_pack(const std::string& path, std::size_t megabytes) -> void;
+static auto drop_page_cache(const std::string& path) -> bool;
+static auto load(const std::string& path, asset_pack::LoadMode mode, std::vector<unsigned char>& staging) -> Result;
+
+// opens an asset pack both ways, reading it into memory and mapping it, then copies every asset
+// through a staging-sized buffer the way UploadContext does, and prints the time taken and the
+// bytes copied on the cpu; a pack of the requested size is cooked first when path does not exist.
+// --cold evicts the pack from the page cache before every run (linux), so the disk is measured too
+//
+// vulkan_bench_packs [--pack path] [--size mb] [--runs n] [--cold]
+auto main(int argc, char** argv) -> int {
+  std::string path = "bench.pack";
+  std::size_t megabytes = 1024;
+  std::size_t runs = 3;
+  bool cold = false;
+
+  for(int i = 1; i < argc; ++i) {
+    if(std::strcmp(argv[i], "--pack") == 0 && i + 1 < argc) {
+      path = argv[++i];
+    } else if(std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+      megabytes = std::stoul(argv[++i]);
+    } else if(std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+      runs = std::max<std::size_t>(std::stoul(argv[++i]), 1);
+    } else if(std::strcmp(argv[i], "--cold") == 0) {
+      cold = true;
+    } else {
+      std::cerr << "usage: " << argv[0] << " [--pack path] [--size mb] [--runs n] [--cold]" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  try {
+    if(!std::filesystem::exists(path))
+      make_pack(path, megabytes);
+
+    // the same capacity as the upload context's staging ring
+    std::vector<unsigned char> staging(32ull * 1024 * 1024);
+
+    std::cout << "pack: " << path << ", " << std::filesystem::file_size(path) << " bytes, " << (cold ? "cold" : "warm") << " page cache\n";
+    std::cout << "mode | open ms | stage ms | total ms | bytes copied\n";
+    for(auto mode : {asset_pack::LoadMode::Read, asset_pack::LoadMode::Map}) {
+      Result best{};
+      for(std::size_t run = 0; run < runs; ++run) {
+        if(cold && !drop_page_cache(path))
+          std::cerr << "unable to evict " << path << " from the page cache\n";
+
+        auto result = load(path, mode, staging);
+        if(run == 0 || result.open_milliseconds + result.stage_milliseconds < best.open_milliseconds + best.stage_milliseconds)
+          best = result;
+      }
+
+      std::cout << (mode == asset_pack::LoadMode::Read ? "read" : "map ") << " | "
+                << std::fixed << std::setprecision(1) << std::setw(7) << best.open_milliseconds << " | "
+                << std::setw(8) << best.stage_milliseconds << " | "
+                << std::setw(8) << best.open_milliseconds + best.stage_milliseconds << " | "
+                << best.bytes_copied << "\n";
+    }
+  } catch(const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+// 64 mb meshes of arbitrary vertices; cooking textures would spend most of the time filtering mips
+static auto make_pack(const std::string& path, std::size_t megabytes) -> void {
+  constexpr std::size_t VERTICES = UINT16_MAX + 1;
+  constexpr std::size_t MESH_BYTES = VERTICES * sizeof(asset_pack::Vertex);
+
+  std::vector<asset_pack::Vertex> vertices(VERTICES);
+  for(std::size_t i = 0; i < vertices.size(); ++i)
+    vertices[i].position[0] = static_cast<float>(i);
+  std::vector<uint16_t> indices;
+
+  std::vector<asset_pack::CookedAsset> assets;
+  for(std::size_t bytes = 0, i = 0; bytes < megabytes * 1024 * 1024; bytes += MESH_BYTES, ++i)
+    assets.push_back(asset_pack::cook_mesh("mesh_" + std::to_string(i), i, vertices, indices));
+
+  std::cout << "cooking " << assets.size() << " meshes into " << path << "\n";
+  asset_pack::write(path, assets);
+}
+
+static auto drop_page_cache(const std::string& path) -> bool {
+#ifdef _WIN32
+  (void)path;
+  return false;
+#else
+  auto descriptor = open(path.c_str(), O_RDONLY);
+  if(descriptor < 0) return false;
+  auto dropped = fdatasync(descriptor) == 0 && posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED) == 0;
+  close(descriptor);
+  return dropped;
+#endif
+}
+
+static auto load(const std::string& path, asset_pack::LoadMode mode, std::vector<unsigned char>& staging) -> Result {
+  Result result{};
+  auto start = std::chrono::high_resolution_clock::now();
+
+  asset_pack::Pack pack;
+  pack.create(path, mode);
+  auto opened = std::chrono::high_resolution_clock::now();
+
+  // every asset is copied into staging once, wrapping like the ring does
+  std::size_t staged = 0;
+  std::size_t head = 0;
+  for(const auto& entry : pack.entries()) {
+    const auto* data = pack.data(entry);
+    for(std::size_t offset = 0; offset < entry.size;) {
+      if(head == staging.size()) head = 0;
+      auto chunk = std::min<std::size_t>(static_cast<std::size_t>(entry.size) - offset, staging.size() - head);
+      memcpy(staging.data() + head, data + offset, chunk);
+      head += chunk;
+      offset += chunk;
+      staged += chunk;
+    }
+  }
+  auto finished = std::chrono::high_resolution_clock::now();
+
+  result.open_milliseconds = std::chrono::duration<double, std::milli>(opened - start).count();
+  result.stage_milliseconds = std::chrono::duration<double, std::milli>(finished - opened).count();
+  result.bytes_copied = pack.bytes_copied() + staged;
+  return result;
+}
@@ -0,0 +1,53 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+
+#include "cpu_profiler.h"
+
+// cost of a cpu_profiler::Scope; only the profiler is linked, so this runs without a gpu
+using Clock = std::chrono::high_resolution_clock;
+
+static auto scope_overhead(std::size_t scope_count) -> double {
+  auto start = Clock::now();
+  for(std::size_t i = 0; i < scope_count; ++i)
+    auto scope = cpu_profiler::Scope("bench");
+  auto end = Clock::now();
+
+  return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(scope_count);
+}
+
+// the floor under a scope, which reads the ticks twice; far more under a hypervisor that traps rdtsc
+static auto tick_overhead(std::size_t read_count) -> double {
+  auto start = Clock::now();
+  for(std::size_t i = 0; i < read_count; ++i)
+    cpu_profiler::now_ticks(); // rdtsc and the clock are never optimised away
+  auto end = Clock::now();
+
+  return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(read_count);
+}
+
+auto main(void) -> int {
+  constexpr std::size_t SCOPE_COUNT = 10000000;
+
+  scope_overhead(SCOPE_COUNT / 10); // registers this thread and warms the ring
+
+  auto tick = tick_overhead(SCOPE_COUNT);
+  auto enabled = scope_overhead(SCOPE_COUNT);
+  cpu_profiler::set_enabled(false);
+  auto disabled = scope_overhead(SCOPE_COUNT);
+  cpu_profiler::set_enabled(true);
+
+  auto trace = std::ostringstream();
+  auto dump_start = Clock::now();
+  auto events = cpu_profiler::write_chrome_trace(trace, 0, UINT64_MAX);
+  auto dump_end = Clock::now();
+
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << "tick read       | " << tick << " ns\n";
+  std::cout << "scope, enabled  | " << enabled << " ns\n";
+  std::cout << "scope, disabled | " << disabled << " ns\n";
+  std::cout << "trace of " << events << " scope(s) | " << std::chrono::duration<double, std::milli>(dump_end - dump_start).count() << " ms\n";
+
+  return EXIT_SUCCESS;
+}
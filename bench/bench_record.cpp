@@ -0,0 +1,41 @@
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+
+#include "vulkan.h"
+
+using namespace vulkan;
+
+// renders a fixed number of frames of a large scene once per recording thread count and prints
+// the average cpu time spent in record_command_buffer; run from the build directory so the
+// shader paths resolve the same way they do for vulkan_run
+auto main(void) -> int {
+  constexpr std::size_t OBJECT_COUNT = 50000;
+  constexpr std::size_t FRAME_COUNT = 200;
+
+  auto max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+  std::cout << "objects: " << OBJECT_COUNT << ", frames: " << FRAME_COUNT << "\n";
+  std::cout << "threads | record us/frame\n";
+
+  try {
+    for(uint32_t threads = 1; threads <= max_threads; threads *= 2) {
+      ApplicationConfig config{};
+      config.record_threads = threads;
+      config.worker_threads = threads - 1; // the render thread records a partition as well
+      config.object_count = OBJECT_COUNT;
+      config.frame_limit = FRAME_COUNT;
+
+      VulkanApplication app(config);
+      app.run();
+
+      std::cout << std::setw(7) << threads << " | " << std::fixed << std::setprecision(1) << app.average_record_microseconds() << "\n";
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
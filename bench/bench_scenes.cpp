@@ -0,0 +1,179 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "vulkan.h"
+
+using namespace vulkan;
+
+struct Scene {
+  std::string name;
+  std::size_t objects{0};
+  std::size_t meshes{0};
+  std::size_t textures{0};
+  std::size_t materials{0};
+  uint32_t texture_size{256};
+};
+
+struct Result {
+  Scene scene;
+  std::size_t frames{0};
+  double frames_per_second{0.0};
+  frame_stats::Histogram cpu_frame;
+  frame_stats::Histogram gpu_frame;
+  uint64_t hitches{0};
+  double record_microseconds{0.0};
+  double upload_milliseconds{0.0};
+  memory::BlockStats memory{};
+};
+
+static auto run_scene(const Scene& scene, std::size_t frames, bool depth_prepass) -> Result;
+static auto write_histogram(std::ostream& out, const frame_stats::Histogram& histogram) -> void;
+static auto write_json(std::ostream& out, const std::vector<Result>& results, bool depth_prepass) -> void;
+
+// renders synthetic scenes headlessly for a fixed number of frames each and writes the timings and
+// memory use as json, so runs of two versions can be diffed; run from the build directory so the
+// shader paths resolve the same way they do for vulkan_run. a software device (lavapipe) is fine
+//
+// vulkan_bench [--frames n] [--output path] [--scene objects meshes textures materials] [--depth-prepass]
+auto main(int argc, char** argv) -> int {
+  std::size_t frames = 300;
+  std::string output = "bench.json";
+  bool depth_prepass = false;
+  std::vector<Scene> scenes = {
+    {"small", 256, 4, 4, 4, 256},
+    {"medium", 4096, 32, 32, 64, 256},
+    {"large", 32768, 128, 128, 256, 512}
+  };
+
+  try {
+    auto custom = false;
+    for(int i = 1; i < argc; ++i) {
+      if(std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+        frames = std::stoul(argv[++i]);
+      } else if(std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+        output = argv[++i];
+      } else if(std::strcmp(argv[i], "--depth-prepass") == 0) {
+        depth_prepass = true;
+      } else if(std::strcmp(argv[i], "--scene") == 0 && i + 4 < argc) {
+        // replaces the presets; may be given more than once
+        if(!custom) scenes.clear();
+        custom = true;
+
+        Scene scene{};
+        scene.objects = std::stoul(argv[++i]);
+        scene.meshes = std::stoul(argv[++i]);
+        scene.textures = std::stoul(argv[++i]);
+        scene.materials = std::stoul(argv[++i]);
+        scene.name = "custom_" + std::to_string(scenes.size());
+        scenes.push_back(scene);
+      } else {
+        throw std::invalid_argument(argv[i]);
+      }
+    }
+  } catch (const std::exception&) {
+    std::cerr << "usage: " << argv[0] << " [--frames n] [--output path] [--scene objects meshes textures materials] [--depth-prepass]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<Result> results;
+  try {
+    for(const auto& scene : scenes)
+      results.push_back(run_scene(scene, frames, depth_prepass));
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::ofstream file(output);
+  if(!file.is_open()) {
+    std::cerr << "Error - unable to open " << output << std::endl;
+    return EXIT_FAILURE;
+  }
+  write_json(file, results, depth_prepass);
+
+  // the application logs plenty of its own; a summary to compare at a glance
+  std::cout << "\nscene  | frame p50/p99 ms | record us | upload ms | memory MiB\n" << std::fixed << std::setprecision(2);
+  for(const auto& result : results) {
+    std::cout << std::setw(6) << result.scene.name << " | "
+              << result.cpu_frame.percentile(50.0) / 1e6 << " / " << result.cpu_frame.percentile(99.0) / 1e6 << " | "
+              << result.record_microseconds << " | " << result.upload_milliseconds << " | "
+              << static_cast<double>(result.memory.capacity) / (1024.0 * 1024.0) << "\n";
+  }
+  std::cout << "results written to " << output << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+static auto run_scene(const Scene& scene, std::size_t frames, bool depth_prepass) -> Result {
+  ApplicationConfig config{};
+  config.headless = true;
+  config.validation = false; // the layers would be most of the cpu frame, and may not be installed
+  config.frame_limit = frames;
+  config.object_count = scene.objects;
+  config.scene_meshes = scene.meshes;
+  config.scene_textures = scene.textures;
+  config.scene_materials = scene.materials;
+  config.scene_texture_size = scene.texture_size;
+  config.depth_prepass = depth_prepass;
+
+  VulkanApplication app(config);
+  app.run();
+
+  Result result{};
+  result.scene = scene;
+  result.frames = app.frame_statistics().frames();
+  result.frames_per_second = app.frames_per_second();
+  result.cpu_frame = app.frame_statistics().histogram(frame_stats::Metric::CpuFrame);
+  result.gpu_frame = app.frame_statistics().histogram(frame_stats::Metric::Gpu);
+  result.hitches = app.frame_statistics().hitches();
+  result.record_microseconds = app.average_record_microseconds();
+  result.upload_milliseconds = app.upload_milliseconds();
+  result.memory = app.memory_usage();
+  return result;
+}
+
+// milliseconds; null when nothing was recorded (no timestamp support for the gpu)
+static auto write_histogram(std::ostream& out, const frame_stats::Histogram& histogram) -> void {
+  if(histogram.count() == 0) {
+    out << "null";
+    return;
+  }
+
+  out << "{\"mean\": " << histogram.mean() / 1e6
+      << ", \"min\": " << histogram.min() / 1e6
+      << ", \"p50\": " << histogram.percentile(50.0) / 1e6
+      << ", \"p95\": " << histogram.percentile(95.0) / 1e6
+      << ", \"p99\": " << histogram.percentile(99.0) / 1e6
+      << ", \"max\": " << histogram.max() / 1e6 << "}";
+}
+
+static auto write_json(std::ostream& out, const std::vector<Result>& results, bool depth_prepass) -> void {
+  out << std::fixed << std::setprecision(4);
+  out << "{\n  \"depth_prepass\": " << (depth_prepass ? "true" : "false") << ",\n  \"scenes\": [\n";
+  for(std::size_t i = 0; i < results.size(); ++i) {
+    const auto& result = results[i];
+    const auto& scene = result.scene;
+
+    out << "    {\n";
+    out << "      \"name\": \"" << scene.name << "\",\n";
+    out << "      \"objects\": " << scene.objects << ", \"meshes\": " << scene.meshes << ", \"textures\": " << scene.textures
+        << ", \"materials\": " << scene.materials << ", \"texture_size\": " << scene.texture_size << ",\n";
+    out << "      \"frames\": " << result.frames << ",\n";
+    out << "      \"frames_per_second\": " << result.frames_per_second << ",\n";
+    out << "      \"cpu_frame_ms\": "; write_histogram(out, result.cpu_frame); out << ",\n";
+    out << "      \"gpu_frame_ms\": "; write_histogram(out, result.gpu_frame); out << ",\n";
+    out << "      \"hitches\": " << result.hitches << ",\n";
+    out << "      \"record_us\": " << result.record_microseconds << ",\n";
+    out << "      \"upload_ms\": " << result.upload_milliseconds << ",\n";
+    out << "      \"memory\": {\"reserved_bytes\": " << result.memory.capacity
+        << ", \"allocated_bytes\": " << result.memory.allocated_bytes
+        << ", \"requested_bytes\": " << result.memory.requested_bytes
+        << ", \"allocations\": " << result.memory.allocation_count << "}\n";
+    out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n}\n";
+}
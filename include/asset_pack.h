@@ -0,0 +1,127 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "upload.h"
+
+namespace asset_pack {
+
+// FileHeader, the asset data (each piece DATA_ALIGNMENT aligned), then the table of contents: an
+// array of entry_count Entry. everything is stored the way it is uploaded, so loading a pack is
+// one read and a copy of the table, with nothing to decode or parse per asset
+struct FileHeader {
+  static constexpr uint32_t MAGIC = 0x50414b56; // "VKAP"
+  static constexpr uint32_t VERSION = 1; // bump when cooking changes, older packs are then recooked whole
+
+  uint32_t magic{MAGIC};
+  uint32_t version{VERSION};
+  uint32_t entry_count{0};
+  uint32_t reserved{0};
+  uint64_t toc_offset{0};
+};
+
+enum class AssetType : uint32_t {
+  Texture = 1, // every mip level, largest first
+  Mesh = 2 // vertex_count Vertex, then index_count uint16_t
+};
+
+// same layout as the vertices the pipeline binds: position, colour, texture coordinate
+struct Vertex {
+  float position[3];
+  float colour[3];
+  float uv[2];
+};
+
+static constexpr std::size_t NAME_SIZE = 64;
+static constexpr uint64_t DATA_ALIGNMENT = 16;
+
+struct Entry {
+  char name[NAME_SIZE]{}; // the source file name, nul terminated
+  uint64_t source_hash{0}; // of the source file's bytes, unchanged sources are not cooked again
+  uint64_t offset{0}; // into the file
+  uint64_t size{0};
+  AssetType type{AssetType::Texture};
+  uint32_t format{0}; // VkFormat of a texture
+  uint32_t width{0};
+  uint32_t height{0};
+  uint32_t mip_levels{0};
+  uint32_t vertex_count{0};
+  uint32_t index_count{0};
+  uint32_t reserved{0};
+};
+
+// an entry and its data before it is placed in a pack; the entry's offset is set by write
+struct CookedAsset {
+  Entry entry{};
+  std::vector<unsigned char> data;
+};
+
+// fnv-1a, 64 bit
+auto content_hash(const void* data, std::size_t size) -> uint64_t;
+
+// rgba8 srgb pixels with their full mip chain
+auto cook_texture(const std::string& name, uint64_t source_hash, const unsigned char* pixels, uint32_t width, uint32_t height) -> CookedAsset;
+auto cook_mesh(const std::string& name, uint64_t source_hash, const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices) -> CookedAsset;
+// wavefront obj: positions, texture coordinates and polygonal faces (fanned into triangles); a
+// vertex is emitted per distinct position/texture coordinate pair, coloured white. throws
+// std::runtime_error on malformed faces or more vertices than 16 bit indices reach
+auto parse_obj(const std::string& text, std::vector<Vertex>& vertices, std::vector<uint16_t>& indices) -> void;
+// the levels of a texture entry, offsets relative to its data
+auto texture_levels(const Entry& entry) -> std::vector<upload::ImageLevel>;
+
+// written to a temporary file and renamed over path, so a failed cook never leaves half a pack
+auto write(const std::string& path, const std::vector<CookedAsset>& assets) -> void;
+
+enum class LoadMode {
+  Map, // mapped read-only, pages are read in as they are first touched and nothing is copied
+  Read // read into memory with one read; for filesystems that cannot be mapped, and for comparison
+};
+
+// a pack opened in one go; the table is validated once when opened (bounds, formats, mip counts and
+// every entry's size against its dimensions) and the data of every entry is handed out in place, so
+// staging an asset copies it straight from the file's pages
+struct Pack {
+  Pack() = default;
+  ~Pack();
+  Pack(const Pack&) = delete;
+  Pack& operator=(const Pack&) = delete;
+
+// ---- Start of Utility Functions ----
+public:
+  auto create(const std::string& path, LoadMode mode = LoadMode::Map) -> void; // throws std::runtime_error when missing or malformed
+  auto destroy(void) -> void;
+
+  auto is_open(void) const -> bool;
+  auto entries(void) const -> const std::vector<Entry>&;
+  auto count(AssetType type) const -> std::size_t;
+  auto find(const std::string& name) const -> const Entry*;
+  auto data(const Entry& entry) const -> const unsigned char*;
+  auto size(void) const -> std::size_t; // bytes in the file
+  auto bytes_copied(void) const -> std::size_t; // into process memory while opening, the whole file when read
+private:
+  auto map(const std::string& path) -> bool;
+  auto unmap(void) -> void;
+  auto read_table(const std::string& path) -> void;
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  const unsigned char* base{nullptr};
+  std::size_t length{0};
+  void* mapping{nullptr}; // the view when mapped
+  void* mapping_handle{nullptr}; // windows only, the file mapping object behind the view
+  std::vector<unsigned char> bytes; // the file when read
+  std::vector<Entry> table;
+// ---- End of Class Members ----
+};
+
+} // end of namespace asset_pack
+
+#endif // ASSET_PACK_H
@@ -0,0 +1,48 @@
+#ifndef BINDLESS_H
+#define BINDLESS_H
+
+#include <optional>
+#include <cstdint>
+#include <vector>
+
+namespace bindless {
+
+// hands out indices into the bindless texture array. a freed slot may still be read by frames in
+// flight, so it only becomes free again retire_frames calls to next_frame later; fresh slots are
+// handed out in order and freed ones are reused first, so the written part of the array stays dense
+struct SlotAllocator {
+  SlotAllocator() = default;
+  SlotAllocator(uint32_t capacity, uint32_t retire_frames);
+
+// ---- Start of Utility Functions ----
+public:
+  auto allocate(void) -> std::optional<uint32_t>; // nullopt when every slot is taken or retiring
+  auto free(uint32_t slot) -> void;
+  auto next_frame(void) -> void; // once per frame, after its fence
+  auto in_use(void) const -> uint32_t; // allocated, retiring slots included
+  auto high_water_mark(void) const -> uint32_t; // slots ever handed out, the array is written up to here
+private:
+  // N/A
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  uint32_t capacity{0};
+  uint32_t retire_frames{0};
+private:
+  struct Retiring {
+    uint32_t slot{0};
+    uint64_t frame{0}; // freed during this frame
+  };
+
+  uint64_t frame{0};
+  uint32_t fresh{0}; // slots below this have been handed out at least once
+  uint32_t allocated{0};
+  std::vector<uint32_t> free_slots;
+  std::vector<Retiring> retiring; // oldest first
+// ---- End of Class Members ----
+};
+
+} // end of namespace bindless
+
+#endif // BINDLESS_H
@@ -6,6 +6,12 @@
 
 namespace camera {
 
+// reverse-z perspective with the far plane at infinity, for vulkan's [0, 1] depth range: the near
+// plane maps to depth 1 and depth falls towards 0 with distance. float depth is most precise near
+// 0, which is where reverse-z puts the far away geometry, so there is no far plane to pull in
+// (clear depth to 0, test with GREATER). right handed, looking down -z like glm::lookAt
+auto reverse_z_perspective(float fovy, float aspect, float near_plane) -> glm::mat4;
+
 struct Camera {
   Camera() = default;
   Camera(glm::vec3 p);
@@ -0,0 +1,150 @@
+#ifndef CPU_PROFILER_H
+#define CPU_PROFILER_H
+
+#include <filesystem>
+#include <iostream>
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <array>
+
+#if defined(__x86_64__) || defined(_M_X64)
+  #ifdef _MSC_VER
+    #include <intrin.h>
+  #else
+    #include <x86intrin.h>
+  #endif
+  #define CPU_PROFILER_TSC
+#endif
+
+namespace cpu_profiler {
+
+// one thread's most recent scopes. only the owning thread writes; a reader copies events out and
+// then checks claimed to find the ones that may have been overwritten under it (a seqlock per slot)
+struct ThreadBuffer {
+  static constexpr std::size_t CAPACITY = 1 << 14; // events kept per thread, a few hundred frames' worth
+
+  struct Event {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> begin{0}; // ticks
+    std::atomic<uint64_t> end{0};
+  };
+
+  std::array<Event, CAPACITY> events;
+  std::atomic<uint64_t> claimed{0}; // events started, the slot of the last one may be mid-write
+  std::atomic<uint64_t> written{0}; // events complete
+  uint32_t thread_index{0};
+  std::string thread_name; // guarded by the registry's lock
+};
+
+// everything a scope touches is inline below, so an enabled scope is two tick reads and a few
+// stores with no calls; only a thread's first scope goes out of line, to register its buffer
+inline std::atomic<bool> profiling_enabled{true};
+inline thread_local ThreadBuffer* local_buffer = nullptr;
+
+auto register_thread(void) -> ThreadBuffer&;
+
+// steady clock, nanoseconds since an arbitrary epoch shared by every thread
+auto now_nanoseconds(void) -> uint64_t;
+
+// what scopes are stamped with; the time stamp counter on x86-64 (a few ns to read on bare metal,
+// against tens for the steady clock) and steady clock nanoseconds elsewhere. converted to
+// nanoseconds only when a trace is written, against a calibration taken at startup
+inline auto now_ticks(void) -> uint64_t {
+#ifdef CPU_PROFILER_TSC
+  return __rdtsc();
+#else
+  return now_nanoseconds();
+#endif
+}
+
+// a span of ticks in nanoseconds, for timing with one clock read at each end; the rate is measured
+// once, the first call may wait up to a millisecond after startup for it
+auto ticks_to_nanoseconds(uint64_t ticks) -> uint64_t;
+
+// on by default; scopes cost two tick reads and a handful of stores, cheap enough to leave on in
+// release builds, and switching it off leaves them a single relaxed load. bench_profiler times a
+// scope against a lone tick read; under a hypervisor that traps rdtsc the two reads are most of it
+inline auto set_enabled(bool enabled) -> void {
+  profiling_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+inline auto enabled(void) -> bool {
+  return profiling_enabled.load(std::memory_order_relaxed);
+}
+
+// shown instead of "thread <n>" in traces; copied
+auto set_thread_name(const std::string& name) -> void;
+
+// a finished scope on the calling thread; name must have static storage (a string literal)
+inline auto record(const char* name, uint64_t begin_ticks, uint64_t end_ticks) -> void {
+  auto* buffer = local_buffer;
+  if(buffer == nullptr)
+    buffer = &register_thread();
+  auto index = buffer->written.load(std::memory_order_relaxed); // only this thread writes it
+
+  // claim first; a reader that saw any of the stores below is guaranteed to see the claim too
+  buffer->claimed.store(index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  auto& event = buffer->events[index % ThreadBuffer::CAPACITY];
+  event.name.store(name, std::memory_order_relaxed);
+  event.begin.store(begin_ticks, std::memory_order_relaxed);
+  event.end.store(end_ticks, std::memory_order_relaxed);
+
+  buffer->written.store(index + 1, std::memory_order_release);
+}
+
+// times the enclosing block on the calling thread
+struct Scope {
+  Scope(const char* name): name(name) {
+    if(enabled())
+      begin = now_ticks();
+  }
+
+  ~Scope() {
+    if(begin != 0)
+      record(name, begin, now_ticks());
+  }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+private:
+  const char* name;
+  uint64_t begin{0}; // ticks, 0 when profiling was off at the start of the scope
+};
+
+// every thread's scopes overlapping [begin, end), in now_nanoseconds time, as chrome tracing /
+// perfetto json; returns the number of scopes written. events a thread overwrote while they were
+// being read are left out
+auto write_chrome_trace(std::ostream& out, uint64_t begin_nanoseconds, uint64_t end_nanoseconds) -> std::size_t;
+
+// captures the next n frames into a trace file; frame() is called once per frame by whoever
+// drives the frames, the file is written by the frame() that ends the capture
+struct Capture {
+  Capture() = default;
+
+// ---- Start of Utility Functions ----
+public:
+  auto start(std::size_t frames, const std::filesystem::path& path) -> void;
+  auto frame(void) -> bool; // true when this call wrote the file
+  auto finish(void) -> bool; // writes what was captured so far, e.g. when the frames stop early
+  auto active(void) const -> bool;
+private:
+  // N/A
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  std::filesystem::path path;
+  std::size_t frames_left{0};
+  uint64_t begin{0};
+// ---- End of Class Members ----
+};
+
+} // end of namespace cpu_profiler
+
+#endif // CPU_PROFILER_H
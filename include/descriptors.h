@@ -0,0 +1,161 @@
+#ifndef DESCRIPTORS_H
+#define DESCRIPTORS_H
+
+#include <vulkan/vulkan.h>
+
+#include <unordered_map>
+#include <cstdint>
+#include <vector>
+
+namespace descriptors {
+
+// descriptors of one type per set; a pool for n sets holds n * per_set of them
+struct PoolRatio {
+  VkDescriptorType type{};
+  uint32_t per_set{1};
+};
+
+auto pool_sizes(const std::vector<PoolRatio>& ratios, uint32_t sets) -> std::vector<VkDescriptorPoolSize>;
+// sets in the pool that follows a full one of this size; doubles, up to MAX_POOL_SETS
+auto next_pool_sets(uint32_t sets) -> uint32_t;
+
+constexpr uint32_t MAX_POOL_SETS = 4096;
+
+// hands out sets from a chain of pools. when the current pool runs out (VK_ERROR_OUT_OF_POOL_MEMORY
+// or VK_ERROR_FRAGMENTED_POOL) the next one is taken, a pool left over from the last reset if there is
+// one, otherwise a new one twice the size; so pools are only created while the high water mark grows,
+// and reset puts every pool back in one vkResetDescriptorPool each. for per-frame sets, keep one
+// allocator per frame in flight and reset it after the frame's fence
+struct DescriptorAllocator {
+  DescriptorAllocator() = default;
+
+// ---- Start of Utility Functions ----
+public:
+  auto create(VkDevice device, std::vector<PoolRatio> ratios, uint32_t initial_sets, VkDescriptorPoolCreateFlags flags = 0) -> void;
+  auto destroy(void) -> void; // frees every set allocated
+
+  auto allocate(VkDescriptorSetLayout layout) -> VkDescriptorSet; // throws when even an empty pool cannot hold the set
+  auto reset(void) -> void; // every set allocated before is freed
+  auto pool_count(void) const -> std::size_t;
+  auto allocated_sets(void) const -> std::size_t; // since the last reset
+private:
+  auto take_pool(void) -> VkDescriptorPool;
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  VkDevice device{VK_NULL_HANDLE};
+  std::vector<PoolRatio> ratios;
+  VkDescriptorPoolCreateFlags flags{0};
+  uint32_t next_sets{0}; // size of the next pool created
+
+  VkDescriptorPool current{VK_NULL_HANDLE};
+  std::vector<VkDescriptorPool> full_pools; // allocated from since the last reset
+  std::vector<VkDescriptorPool> free_pools; // reset, reused before creating more
+  std::size_t set_count{0};
+// ---- End of Class Members ----
+};
+
+// a layout's bindings sorted by binding number, with their binding flags (empty or one per binding);
+// immutable samplers are not part of the key, layouts using them are not cached
+struct LayoutKey {
+  std::vector<VkDescriptorSetLayoutBinding> bindings;
+  std::vector<VkDescriptorBindingFlags> binding_flags;
+  VkDescriptorSetLayoutCreateFlags flags{0};
+
+public:
+  auto operator==(const LayoutKey& other) const -> bool;
+};
+
+auto make_layout_key(std::vector<VkDescriptorSetLayoutBinding> bindings, std::vector<VkDescriptorBindingFlags> binding_flags = {}, VkDescriptorSetLayoutCreateFlags flags = 0) -> LayoutKey;
+
+struct LayoutKeyHash {
+  auto operator()(const LayoutKey& key) const -> std::size_t;
+};
+
+// one VkDescriptorSetLayout per distinct set of bindings, owned by the cache
+struct LayoutCache {
+  LayoutCache() = default;
+
+// ---- Start of Utility Functions ----
+public:
+  auto create(VkDevice device) -> void;
+  auto destroy(void) -> void;
+
+  auto get(const LayoutKey& key) -> VkDescriptorSetLayout; // created on the first request
+  auto size(void) const -> std::size_t;
+private:
+  // N/A
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  VkDevice device{VK_NULL_HANDLE};
+  std::unordered_map<LayoutKey, VkDescriptorSetLayout, LayoutKeyHash> layouts;
+// ---- End of Class Members ----
+};
+
+// what one binding of a set points at; buffer, offset and range for buffer types, view, sampler and
+// image_layout for image types. a single descriptor per binding
+struct SetWrite {
+  uint32_t binding{0};
+  VkDescriptorType type{};
+  VkBuffer buffer{VK_NULL_HANDLE};
+  VkDeviceSize offset{0};
+  VkDeviceSize range{0};
+  VkImageView view{VK_NULL_HANDLE};
+  VkSampler sampler{VK_NULL_HANDLE};
+  VkImageLayout image_layout{};
+
+public:
+  auto operator==(const SetWrite& other) const -> bool;
+};
+
+struct SetKey {
+  VkDescriptorSetLayout layout{VK_NULL_HANDLE};
+  std::vector<SetWrite> writes;
+
+public:
+  auto operator==(const SetKey& other) const -> bool;
+};
+
+struct SetKeyHash {
+  auto operator()(const SetKey& key) const -> std::size_t;
+};
+
+// sets that are written once and never changed, shared by everything asking for the same layout
+// and contents; a miss allocates from the given allocator and writes the set, a hit touches nothing
+// on the device. render thread only. the cached sets stay valid until the allocator is reset
+struct SetCache {
+  SetCache() = default;
+
+// ---- Start of Utility Functions ----
+public:
+  auto create(VkDevice device, DescriptorAllocator& allocator) -> void;
+  auto destroy(void) -> void; // forgets the sets, they are freed with the allocator's pools
+
+  auto get(const SetKey& key) -> VkDescriptorSet;
+  auto size(void) const -> std::size_t;
+  auto hits(void) const -> std::size_t;
+private:
+  // N/A
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  VkDevice device{VK_NULL_HANDLE};
+  DescriptorAllocator* allocator{nullptr};
+  std::unordered_map<SetKey, VkDescriptorSet, SetKeyHash> sets;
+  std::size_t hit_count{0};
+// ---- End of Class Members ----
+};
+
+} // end of namespace descriptors
+
+#endif // DESCRIPTORS_H
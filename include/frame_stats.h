@@ -0,0 +1,137 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <filesystem>
+#include <optional>
+#include <iostream>
+#include <fstream>
+#include <cstdint>
+#include <string>
+#include <array>
+
+namespace frame_stats {
+
+// log-linear buckets in the style of HdrHistogram: exact below SUB_BUCKETS, above that every
+// power of two is split into SUB_BUCKETS / 2 buckets, so any value is kept to within 1/64 (~1.6%)
+// of itself. fixed size, recording is a couple of shifts and an increment
+struct Histogram {
+  static constexpr uint32_t SUB_BUCKET_BITS = 7;
+  static constexpr uint64_t SUB_BUCKETS = 1ull << SUB_BUCKET_BITS;
+  static constexpr uint32_t MAX_VALUE_BITS = 40; // 2^40ns is ~18 minutes, larger values are clamped
+  static constexpr std::size_t BUCKET_COUNT = SUB_BUCKETS + (MAX_VALUE_BITS - SUB_BUCKET_BITS) * (SUB_BUCKETS / 2);
+
+  Histogram() = default;
+
+// ---- Start of Utility Functions ----
+public:
+  static auto bucket_for(uint64_t value) -> std::size_t;
+  static auto highest_in_bucket(std::size_t bucket) -> uint64_t;
+
+  auto record(uint64_t value) -> void;
+  auto reset(void) -> void;
+
+  auto count(void) const -> uint64_t;
+  auto min(void) const -> uint64_t;
+  auto max(void) const -> uint64_t;
+  auto mean(void) const -> double;
+  // the value below which percentile% of the recorded values fall, within the bucket precision
+  auto percentile(double percentile) const -> uint64_t;
+private:
+  // N/A
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  std::array<uint64_t, BUCKET_COUNT> buckets{};
+  uint64_t total{0};
+  uint64_t smallest{UINT64_MAX};
+  uint64_t largest{0};
+  double sum{0.0}; // exact, for the mean
+// ---- End of Class Members ----
+};
+
+enum class Metric {
+  CpuFrame, // one iteration of the main loop
+  Gpu, // the frame's command buffer on the gpu, arrives a couple of frames late
+  FenceWait,
+  Acquire,
+  Count
+};
+
+auto metric_name(Metric metric) -> const char*;
+
+struct Config {
+  double hitch_milliseconds{50.0}; // a cpu frame longer than this is logged as a hitch, 0 disables
+  std::size_t report_interval{0}; // frames between percentile reports, 0 only reports at the end
+  std::filesystem::path csv_path; // reports go here as csv rows instead of stdout when set
+};
+
+// per-frame timings fed in by the main loop. every metric has a histogram per report interval and
+// one for the whole run; a frame's named phases are kept until it ends so a hitch can be blamed on
+// its longest one
+struct FrameStats {
+  FrameStats() = default;
+
+// ---- Start of Utility Functions ----
+public:
+  auto create(const Config& config) -> void;
+  auto destroy(void) -> void;
+
+  auto record(Metric metric, uint64_t nanoseconds) -> void; // adds to the current frame's value
+  auto record_phase(const char* name, uint64_t nanoseconds) -> void; // name must be a string literal
+  // true when the frame was a hitch; reports when the interval is up
+  auto end_frame(uint64_t frame_nanoseconds) -> bool;
+
+  auto histogram(Metric metric) const -> const Histogram&; // whole run
+  auto frames(void) const -> uint64_t;
+  auto hitches(void) const -> uint64_t;
+  auto report(std::ostream& out) const -> void; // whole run, human readable
+private:
+  using Histograms = std::array<Histogram, static_cast<std::size_t>(Metric::Count)>;
+
+  auto write_report(const Histograms& histograms, uint64_t first_frame, uint64_t hitch_count) -> void;
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  Config config{};
+  std::ofstream csv;
+
+  Histograms totals{};
+  Histograms interval{};
+  uint64_t frame_count{0};
+  uint64_t interval_first_frame{0};
+  uint64_t hitch_count{0};
+  uint64_t interval_hitches{0};
+
+  // the frame being recorded
+  std::array<std::optional<uint64_t>, static_cast<std::size_t>(Metric::Count)> current{};
+  const char* slowest_phase{nullptr};
+  uint64_t slowest_phase_nanoseconds{0};
+// ---- End of Class Members ----
+};
+
+// times the enclosing block as a phase of the current frame (and, optionally, into a metric); it
+// also shows up in cpu traces under the same name
+struct Phase {
+  Phase(FrameStats& stats, const char* name, std::optional<Metric> metric = std::nullopt);
+  ~Phase();
+
+  Phase(const Phase&) = delete;
+  Phase& operator=(const Phase&) = delete;
+
+private:
+  FrameStats& stats;
+  const char* name;
+  std::optional<Metric> metric;
+  uint64_t begin; // ticks
+  bool profiled; // also a cpu_profiler scope, profiling was on at the start
+};
+
+} // end of namespace frame_stats
+
+#endif // FRAME_STATS_H
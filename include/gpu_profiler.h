@@ -0,0 +1,127 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <vulkan/vulkan.h>
+
+#include <optional>
+#include <iostream>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <array>
+
+namespace gpu_profiler {
+
+// min/avg/max over the last WINDOW samples
+struct RollingStats {
+  static constexpr std::size_t WINDOW = 128;
+
+  RollingStats() = default;
+
+// ---- Start of Utility Functions ----
+public:
+  auto push(double sample) -> void;
+  auto min(void) const -> double;
+  auto avg(void) const -> double;
+  auto max(void) const -> double;
+  auto last(void) const -> double;
+  auto count(void) const -> std::size_t; // samples in the window
+private:
+  // N/A
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  std::array<double, WINDOW> samples{};
+  std::size_t next{0};
+  std::size_t filled{0};
+  double sum{0.0};
+// ---- End of Class Members ----
+};
+
+// ticks between two raw timestamps, where only the low valid_bits of each are meaningful (the
+// counter wraps at that width), converted with the device's timestampPeriod (ns per tick)
+auto elapsed_milliseconds(uint64_t begin, uint64_t end, uint32_t valid_bits, float period) -> double;
+
+struct ScopeStats {
+  std::string name;
+  RollingStats milliseconds;
+  uint64_t collection{0}; // the collection its last sample came from
+};
+
+// timestamp queries around named regions of a frame's command buffer. every frame in flight
+// has its own query pool; a frame's results are read back when that frame comes round again,
+// after its fence was waited on, so reading them never stalls. on queues without timestamp
+// support (timestampValidBits == 0) it stays disabled and every call is a no-op
+struct GpuProfiler {
+  static constexpr uint32_t DEFAULT_MAX_SCOPES = 32; // per frame
+  static constexpr uint32_t INVALID_SCOPE = UINT32_MAX;
+
+  GpuProfiler() = default;
+
+// ---- Start of Utility Functions ----
+public:
+  auto create(VkPhysicalDevice physical_device, VkDevice device, uint32_t queue_family_index, uint32_t frames_in_flight, uint32_t max_scopes = DEFAULT_MAX_SCOPES) -> void;
+  auto destroy(void) -> void;
+
+  auto enabled(void) const -> bool;
+  // first thing in the frame's command buffer, outside any render pass, after its fence wait;
+  // collects what the frame recorded last time round and resets its queries
+  auto begin_frame(VkCommandBuffer command_buffer, uint32_t frame_in_flight) -> void;
+  // name must outlive the frame (a string literal); scopes may nest
+  auto begin_scope(VkCommandBuffer command_buffer, const char* name) -> uint32_t;
+  auto end_scope(VkCommandBuffer command_buffer, uint32_t scope) -> void;
+
+  auto scopes(void) const -> const std::vector<ScopeStats>&; // in the order first seen
+  // milliseconds, when the last begin_frame collected a sample for the scope
+  auto latest(const char* name) const -> std::optional<double>;
+  auto report(std::ostream& out) const -> void;
+private:
+  struct PendingScope {
+    const char* name{nullptr};
+    uint32_t first_query{0}; // begin, end is the next one
+    bool ended{false};
+  };
+
+  auto collect(uint32_t frame_in_flight) -> void;
+  auto stats_for(const char* name) -> ScopeStats&;
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  VkDevice device{VK_NULL_HANDLE};
+  uint32_t valid_bits{0};
+  float period{1.0f}; // nanoseconds per tick
+  uint32_t max_scopes{0};
+
+  std::vector<VkQueryPool> query_pools; // one per frame in flight
+  std::vector<std::vector<PendingScope>> pending; // per frame in flight, recorded but not read back yet
+  uint32_t recording_frame{0};
+  std::vector<uint64_t> results; // scratch for collect, [timestamp, availability] pairs
+
+  std::vector<ScopeStats> stats;
+  uint64_t collections{0};
+// ---- End of Class Members ----
+};
+
+// begin_scope/end_scope for a block
+struct Scope {
+  Scope(GpuProfiler& profiler, VkCommandBuffer command_buffer, const char* name);
+  ~Scope();
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+private:
+  GpuProfiler& profiler;
+  VkCommandBuffer command_buffer;
+  uint32_t scope;
+};
+
+} // end of namespace gpu_profiler
+
+#endif // GPU_PROFILER_H
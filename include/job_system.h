@@ -0,0 +1,110 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+
+namespace job_system {
+
+using Job = std::function<void(void)>;
+using RangeFunction = std::function<void(std::size_t, std::size_t)>; // [begin, end)
+
+struct JobSystem;
+
+// number of jobs spawned against it that have not finished yet; jobs queued behind it with
+// JobSystem::then() are spawned once it drops back to zero
+struct Counter {
+  Counter() = default;
+
+  Counter(const Counter&) = delete;
+  Counter& operator=(const Counter&) = delete;
+
+// ---- Start of Utility Functions ----
+public:
+  auto done(void) const -> bool;
+  auto value(void) const -> std::size_t;
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  friend struct JobSystem;
+
+  struct Continuation {
+    Job job;
+    Counter* counter{nullptr};
+  };
+
+  std::atomic<std::size_t> pending{0};
+  std::mutex mutex; // taken on every decrement, so a waiter can tell the last finisher has let go
+  std::vector<Continuation> continuations;
+// ---- End of Class Members ----
+};
+
+// fine grained fork/join scheduler for per-frame work. every worker owns a deque; it pushes and
+// pops its own jobs at the back (most recent first, still warm in cache) and steals from the
+// front of the others when it runs dry. threads outside the pool push into a shared queue and,
+// like the workers, run jobs while they wait on a counter instead of blocking
+struct JobSystem {
+  JobSystem(std::size_t thread_count = default_thread_count());
+  ~JobSystem();
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+// ---- Start of Utility Functions ----
+public:
+  static auto default_thread_count(void) -> std::size_t;
+
+  auto spawn(Job job, Counter* counter = nullptr) -> void;
+  auto then(Counter& dependency, Job job, Counter* counter = nullptr) -> void; // spawned once dependency is done
+  auto wait(Counter& counter) -> void; // runs other jobs until counter is done
+  // splits [begin, end) into chunks of grain and blocks until all of them ran; the first
+  // exception thrown by a chunk is rethrown here
+  auto parallel_for(std::size_t begin, std::size_t end, std::size_t grain, const RangeFunction& function) -> void;
+
+  auto size(void) const -> std::size_t; // workers, not counting threads helping from wait()
+private:
+  struct Entry {
+    Job job;
+    Counter* counter{nullptr};
+  };
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Entry> entries;
+  };
+
+  auto push(Entry entry) -> void;
+  auto find(Entry& entry) -> bool; // own queue first, then steal
+  auto run(Entry& entry) -> void;
+  auto finish(Counter& counter) -> void;
+  auto worker_loop(std::size_t index) -> void;
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  std::vector<std::thread> workers;
+  std::vector<std::unique_ptr<Queue>> queues; // one per worker, the last one shared by outside threads
+  std::atomic<std::size_t> queued{0}; // entries sitting in any queue
+  std::atomic<std::size_t> sleeping{0};
+  std::atomic<bool> stopping{false};
+
+  std::mutex sleep_mutex;
+  std::condition_variable work_available;
+// ---- End of Class Members ----
+};
+
+} // end of namespace job_system
+
+#endif // JOB_SYSTEM_H
@@ -0,0 +1,59 @@
+#ifndef KTX_H
+#define KTX_H
+
+#include <vulkan/vulkan.h>
+
+#include <filesystem>
+#include <optional>
+#include <cstdint>
+#include <vector>
+
+#include "upload.h"
+
+namespace ktx {
+
+// the texel blocks a format is stored in; 1x1 blocks for uncompressed formats
+struct FormatInfo {
+  uint32_t block_width{1};
+  uint32_t block_height{1};
+  uint32_t block_bytes{4};
+};
+
+// block compressed (bc1-7, etc2/eac, astc ldr) and 8 bit rgba formats; nullopt for anything else
+auto format_info(VkFormat format) -> std::optional<FormatInfo>;
+auto level_size(const FormatInfo& info, uint32_t width, uint32_t height) -> VkDeviceSize;
+
+// lower is preferred when several variants of a texture are available: bc7, astc, etc2/eac, the
+// other bc formats, then uncompressed rgba8
+auto format_preference(VkFormat format) -> uint32_t;
+
+// what a ktx2 file holds, from its first bytes alone; enough to choose between variants
+struct Header {
+  VkFormat format{VK_FORMAT_UNDEFINED};
+  uint32_t width{0};
+  uint32_t height{0};
+  uint32_t level_count{0}; // as stored, 0 when only level 0 is and the rest are generated on load
+};
+
+// a 2d texture straight out of a ktx2 container, every level ready for UploadContext::upload_image_levels
+struct Texture {
+  VkFormat format{VK_FORMAT_UNDEFINED};
+  uint32_t width{0};
+  uint32_t height{0};
+  std::vector<upload::ImageLevel> levels; // largest first, into data
+  std::vector<unsigned char> data;
+};
+
+// ktx2 stores levels smallest first, they are repacked largest first. only containers that can be
+// uploaded as they are are accepted: a single 2d image (no array layers, cube faces or depth) in a
+// format from format_info, without supercompression (basis/zstd would need transcoding first).
+// a level count of 0 has the rest of the chain box filtered from level 0, which only uncompressed
+// formats can have. throws std::runtime_error on anything else, or when the data is truncated
+auto parse_header(const unsigned char* bytes, std::size_t size) -> Header;
+auto load_header(const std::filesystem::path& path) -> Header;
+auto parse(const unsigned char* bytes, std::size_t size) -> Texture;
+auto load(const std::filesystem::path& path) -> Texture;
+
+} // end of namespace ktx
+
+#endif // KTX_H
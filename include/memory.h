@@ -0,0 +1,190 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <vulkan/vulkan.h>
+
+#include <optional>
+#include <iostream>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <array>
+#include <mutex>
+
+namespace memory {
+
+// bufferImageGranularity only matters between "linear" resources (buffers, linear images)
+// and "optimal" resources (optimally tiled images) that land on the same memory page
+enum class ResourceKind {
+  Linear,
+  Optimal
+};
+
+struct BlockRange {
+  VkDeviceSize offset{0};
+  VkDeviceSize size{0}; // size handed out, may be larger than requested (granularity rounding)
+  uint32_t node{0}; // handle used to give the range back
+};
+
+struct BlockStats {
+  VkDeviceSize capacity{0};
+  VkDeviceSize requested_bytes{0}; // sum of the sizes callers asked for
+  VkDeviceSize allocated_bytes{0}; // bytes taken out of the block, including rounding and padding
+  VkDeviceSize free_bytes{0};
+  VkDeviceSize largest_free_range{0};
+  std::size_t allocation_count{0};
+  std::size_t free_range_count{0};
+
+public:
+  // bytes lost to alignment/granularity padding
+  auto wasted_bytes(void) const -> VkDeviceSize;
+  // 0 when all free memory is one contiguous range, approaching 1 as it splinters
+  auto fragmentation(void) const -> double;
+};
+
+// Two-Level Segregated Fit (TLSF) placement over the range [0, capacity); knows nothing
+// about vulkan objects, so a single instance describes the layout of one VkDeviceMemory block.
+// free ranges are bucketed by a first level (power of two) and a second level (linear
+// subdivision of that power of two); two bitmaps make finding a big enough bucket O(1)
+struct BlockAllocator {
+  static constexpr uint32_t SL_BITS = 4;
+  static constexpr uint32_t SL_COUNT = 1u << SL_BITS;
+  static constexpr uint32_t FL_COUNT = 64 - SL_BITS + 1;
+  static constexpr uint32_t NULL_NODE = UINT32_MAX;
+
+  BlockAllocator() = default;
+  BlockAllocator(VkDeviceSize capacity, VkDeviceSize granularity = 1);
+
+// ---- Start of Utility Functions ----
+public:
+  auto allocate(VkDeviceSize size, VkDeviceSize alignment, ResourceKind kind) -> std::optional<BlockRange>;
+  auto free(uint32_t node) -> void;
+  auto stats(void) const -> BlockStats;
+  auto empty(void) const -> bool;
+private:
+  auto new_node(void) -> uint32_t;
+  auto insert_free(uint32_t node) -> void;
+  auto remove_free(uint32_t node) -> void;
+  auto split(uint32_t node, VkDeviceSize size) -> uint32_t;
+  auto merge(uint32_t left, uint32_t right) -> void;
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  VkDeviceSize capacity{0};
+  VkDeviceSize granularity{1};
+private:
+  struct Node {
+    VkDeviceSize offset{0};
+    VkDeviceSize size{0};
+    VkDeviceSize requested{0};
+    uint32_t prev_physical{NULL_NODE};
+    uint32_t next_physical{NULL_NODE};
+    uint32_t prev_free{NULL_NODE};
+    uint32_t next_free{NULL_NODE};
+    bool is_free{false};
+  };
+
+  std::vector<Node> nodes;
+  std::vector<uint32_t> recycled_nodes; // node slots that can be reused, keeps handles stable
+  uint64_t fl_bitmap{0};
+  std::array<uint32_t, FL_COUNT> sl_bitmaps{};
+  std::array<std::array<uint32_t, SL_COUNT>, FL_COUNT> free_heads{};
+  std::size_t allocation_count{0};
+// ---- End of Class Members ----
+};
+
+// bump allocator over [0, capacity); every allocation is an offset past the previous one and
+// nothing is freed individually, the whole range is recycled at once with reset(). used for
+// per-frame transient data, where reset() happens once the frame's fence has signalled
+struct LinearAllocator {
+  LinearAllocator() = default;
+  LinearAllocator(VkDeviceSize capacity);
+
+// ---- Start of Utility Functions ----
+public:
+  auto allocate(VkDeviceSize size, VkDeviceSize alignment) -> std::optional<VkDeviceSize>;
+  auto reset(void) -> void;
+  auto used(void) const -> VkDeviceSize;
+  auto high_water_mark(void) const -> VkDeviceSize;
+private:
+  // N/A
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  VkDeviceSize capacity{0};
+private:
+  VkDeviceSize head{0};
+  VkDeviceSize peak{0}; // largest head seen since creation, used to size the arena
+// ---- End of Class Members ----
+};
+
+// a sub-allocated piece of a VkDeviceMemory block; the (block, node) pair is the handle
+struct Allocation {
+  static constexpr uint32_t DEDICATED = UINT32_MAX;
+
+  VkDeviceMemory memory{VK_NULL_HANDLE};
+  VkDeviceSize offset{0};
+  VkDeviceSize size{0};
+  void* mapped{nullptr}; // non-null when the memory type is host visible (blocks stay mapped)
+  uint32_t memory_type{0};
+  uint32_t block{0};
+  uint32_t node{0};
+};
+
+// owns every VkDeviceMemory in the application; resources are placed inside large blocks
+// (one pool of blocks per memory type), so vkAllocateMemory is only called when a pool runs dry
+struct DeviceAllocator {
+  static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+  DeviceAllocator() = default;
+
+// ---- Start of Utility Functions ----
+public:
+  auto create(VkPhysicalDevice physical_device, VkDevice device, VkDeviceSize preferred_block_size = DEFAULT_BLOCK_SIZE) -> void;
+  auto destroy(void) -> void;
+
+  // a type with every preferred flag as well when there is one, the first with the required ones otherwise
+  auto find_memory_type(uint32_t type_filter, VkMemoryPropertyFlags properties, VkMemoryPropertyFlags preferred = 0) const -> uint32_t;
+  auto allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind, VkMemoryPropertyFlags preferred = 0) -> Allocation;
+  auto free(Allocation& allocation) -> void;
+  auto memory_type_flags(uint32_t memory_type) const -> VkMemoryPropertyFlags;
+  auto non_coherent_atom_size(void) const -> VkDeviceSize; // what flushes and invalidates of non-coherent memory align to
+
+  auto dump_stats(std::ostream& out) const -> void;
+  auto device_memory_count(void) const -> std::size_t;
+  // every block and dedicated allocation summed up; capacity is the bytes reserved from the driver
+  auto total_stats(void) const -> BlockStats;
+private:
+  struct Block {
+    VkDeviceMemory memory{VK_NULL_HANDLE};
+    void* mapped{nullptr};
+    BlockAllocator placement{};
+  };
+
+  auto allocate_device_memory(uint32_t memory_type, VkDeviceSize size, void** mapped) -> VkDeviceMemory;
+  auto block_size_for(uint32_t memory_type) const -> VkDeviceSize;
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  VkDevice device{VK_NULL_HANDLE};
+  VkPhysicalDeviceMemoryProperties memory_properties{};
+  VkDeviceSize preferred_block_size{DEFAULT_BLOCK_SIZE};
+  VkDeviceSize buffer_image_granularity{1};
+  uint32_t max_allocation_count{0};
+  VkDeviceSize non_coherent_atom{1};
+
+  std::array<std::vector<Block>, VK_MAX_MEMORY_TYPES> pools{}; // blocks with a null memory handle are released slots
+  std::unordered_map<VkDeviceMemory, Allocation> dedicated; // allocations too big to share a block
+
+  mutable std::mutex mutex;
+// ---- End of Class Members ----
+};
+
+} // end of namespace memory
+
+#endif // MEMORY_H
@@ -0,0 +1,65 @@
+#ifndef PIPELINE_CACHE_H
+#define PIPELINE_CACHE_H
+
+#include <vulkan/vulkan.h>
+
+#include <optional>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pipeline_cache {
+
+// prefixed to the driver's blob on disk; the vulkan header inside the blob carries vendor, device
+// and cache uuid but not the driver version, and nothing guards against a truncated file
+struct FileHeader {
+  static constexpr uint32_t MAGIC = 0x43504b56; // "VKPC"
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t magic{MAGIC};
+  uint32_t version{VERSION};
+  uint32_t driver_version{0};
+  uint32_t reserved{0};
+  uint64_t data_size{0};
+  uint64_t data_hash{0};
+};
+
+// true when the blob begins with a VkPipelineCacheHeaderVersionOne matching this device
+auto is_compatible(const std::vector<char>& blob, const VkPhysicalDeviceProperties& properties) -> bool;
+// FileHeader followed by the blob
+auto wrap(const std::vector<char>& blob, const VkPhysicalDeviceProperties& properties) -> std::vector<char>;
+// the blob, when the file is intact and was written by this device and driver
+auto unwrap(const std::vector<char>& file, const VkPhysicalDeviceProperties& properties) -> std::optional<std::vector<char>>;
+
+// a VkPipelineCache seeded from disk at startup and written back (atomically) on destroy;
+// a cache that is missing, corrupt or from another device/driver is dropped and starts empty
+struct PipelineCache {
+  PipelineCache() = default;
+
+// ---- Start of Utility Functions ----
+public:
+  auto create(VkPhysicalDevice physical_device, VkDevice device, const std::string& path) -> void;
+  auto destroy(void) -> void;
+  auto save(void) const -> bool;
+
+  auto handle(void) const -> VkPipelineCache;
+  auto is_warm(void) const -> bool; // loaded with usable data from disk
+private:
+  // N/A
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  VkDevice device{VK_NULL_HANDLE};
+  VkPhysicalDeviceProperties properties{};
+  VkPipelineCache cache{VK_NULL_HANDLE};
+  std::string path;
+  bool warm{false};
+// ---- End of Class Members ----
+};
+
+} // end of namespace pipeline_cache
+
+#endif // PIPELINE_CACHE_H
@@ -0,0 +1,94 @@
+#ifndef PIPELINE_MANAGER_H
+#define PIPELINE_MANAGER_H
+
+#include <vulkan/vulkan.h>
+
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <atomic>
+#include <vector>
+#include <deque>
+#include <mutex>
+
+#include "thread_pool.h"
+
+namespace pipeline_manager {
+
+using PipelineHandle = uint32_t;
+constexpr PipelineHandle INVALID_PIPELINE = UINT32_MAX;
+
+enum class PipelineState {
+  Pending, // nothing to bind yet
+  Ready,
+  Failed // the first build failed; a failed replacement leaves the previous pipeline Ready
+};
+
+// builds one pipeline against the given cache; runs on a worker thread, so it may only touch
+// thread safe state (the device, a copy of its inputs) and reports failure by throwing
+using BuildFunction = std::function<VkPipeline(VkPipelineCache)>;
+
+// compiles pipelines on a thread pool so the render thread never blocks in vkCreate*Pipelines.
+// handles are returned immediately; recording code asks for the pipeline each frame and gets
+// VK_NULL_HANDLE (or the fallback it passes in) until the build has finished
+struct PipelineManager {
+  PipelineManager() = default;
+
+// ---- Start of Utility Functions ----
+public:
+  auto create(VkDevice device, VkPipelineCache cache, thread_pool::ThreadPool& pool, uint32_t frames_in_flight) -> void;
+  auto destroy(void) -> void;
+
+  auto request(BuildFunction build) -> PipelineHandle;
+  auto replace(PipelineHandle handle, BuildFunction build) -> void; // old pipeline stays bound until the new one is ready
+
+  auto get(PipelineHandle handle) const -> VkPipeline;
+  auto resolve(PipelineHandle handle, VkPipeline fallback) const -> VkPipeline;
+  auto state(PipelineHandle handle) const -> PipelineState;
+  auto compile_milliseconds(PipelineHandle handle) const -> double; // of the latest finished build
+
+  auto wait(PipelineHandle handle) -> void;
+  auto collect(void) -> void; // once per frame, after the frame's fence wait; frees retired pipelines
+  auto pending_count(void) const -> std::size_t;
+private:
+  struct Slot {
+    std::atomic<VkPipeline> pipeline{VK_NULL_HANDLE};
+    std::atomic<PipelineState> state{PipelineState::Pending};
+    std::atomic<double> compile_ms{0.0};
+    // guarded by mutex
+    uint64_t generation{0}; // latest build requested
+    uint64_t applied{0}; // generation of the pipeline currently in the slot
+    uint32_t building{0};
+  };
+
+  struct Retired {
+    VkPipeline pipeline{VK_NULL_HANDLE};
+    uint64_t frame{0};
+  };
+
+  auto launch(Slot& slot, BuildFunction build) -> void;
+  auto finish(Slot& slot, uint64_t generation, VkPipeline pipeline, double compile_ms, bool failed) -> void;
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  VkDevice device{VK_NULL_HANDLE};
+  VkPipelineCache cache{VK_NULL_HANDLE};
+  thread_pool::ThreadPool* pool{nullptr};
+  uint32_t frames_in_flight{1};
+
+  std::deque<Slot> slots; // deque keeps slot addresses stable for in-flight builds
+  std::vector<Retired> retired; // replaced pipelines, possibly still referenced by frames in flight
+  uint64_t frame{0};
+  std::atomic<std::size_t> pending{0};
+
+  mutable std::mutex mutex; // guards generations, retired and build completion
+  std::condition_variable built;
+// ---- End of Class Members ----
+};
+
+} // end of namespace pipeline_manager
+
+#endif // PIPELINE_MANAGER_H
@@ -0,0 +1,149 @@
+#ifndef READBACK_H
+#define READBACK_H
+
+#include <vulkan/vulkan.h>
+
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <cstdint>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+
+#include "memory.h"
+
+namespace readback {
+
+enum class ExportFormat {
+  None,
+  Png, // one file per frame
+  Ppm, // one file per frame
+  Raw, // one file per frame, pixels exactly as copied out (4 bytes each, no header)
+  Stream // every frame's raw pixels appended to one file or named pipe, e.g. for ffmpeg
+};
+
+enum class PixelOrder {
+  Rgba,
+  Bgra
+};
+
+// a tightly packed 4 byte per pixel image; only valid until the exporter releases it
+struct Frame {
+  const uint8_t* pixels{nullptr};
+  uint32_t width{0};
+  uint32_t height{0};
+  PixelOrder order{PixelOrder::Rgba};
+  uint64_t number{0};
+};
+
+auto crc32(const uint8_t* data, std::size_t size, uint32_t crc = 0) -> uint32_t;
+// rgb png, deflate stored blocks (no compression); cheap enough to keep up with rendering
+auto encode_png(const Frame& frame) -> std::vector<uint8_t>;
+auto encode_ppm(const Frame& frame) -> std::vector<uint8_t>;
+// nullopt for formats readback cannot swizzle to 8 bit rgb
+auto pixel_order_for(VkFormat format) -> std::optional<PixelOrder>;
+
+// encodes and writes frames on its own thread, in submission order; release is called once a
+// frame's pixels are no longer needed
+struct FrameExporter {
+  using Release = std::function<void(void)>;
+
+  FrameExporter() = default;
+  ~FrameExporter();
+
+// ---- Start of Utility Functions ----
+public:
+  // path is a directory for per-frame formats, a file (or fifo) for ExportFormat::Stream
+  auto create(ExportFormat format, const std::filesystem::path& path) -> void;
+  auto destroy(void) -> void; // writes everything submitted before returning
+
+  auto submit(const Frame& frame, Release release) -> void;
+  auto wait_idle(void) -> void;
+  auto frames_written(void) const -> std::size_t;
+private:
+  auto export_loop(void) -> void;
+  auto write(const Frame& frame) -> void;
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  ExportFormat format{ExportFormat::None};
+  std::filesystem::path path;
+  std::ofstream stream; // ExportFormat::Stream only
+  std::vector<uint8_t> encoded; // reused between frames
+
+  std::thread exporter;
+  std::deque<std::pair<Frame, Release>> queue;
+  bool stopping{false};
+  bool busy{false};
+  std::size_t written{0};
+
+  mutable std::mutex mutex;
+  std::condition_variable frame_available;
+  std::condition_variable idle;
+// ---- End of Class Members ----
+};
+
+// copies the final colour target of a frame into a ring of persistently mapped host visible
+// buffers. nothing ever waits on the gpu for it; a copy is handed to the exporter once the
+// fence of the frame that recorded it has been waited on anyway, frames_in_flight frames later.
+// the only wait is on the exporter, when it falls more than the ring's slack behind
+struct Readback {
+  static constexpr uint32_t EXTRA_SLOTS = 2; // buffers beyond one per frame in flight, the exporter's slack
+
+  Readback() = default;
+
+// ---- Start of Utility Functions ----
+public:
+  auto create(VkDevice device, memory::DeviceAllocator& allocator, VkExtent2D extent, VkFormat format, uint32_t frames_in_flight, ExportFormat export_format, const std::filesystem::path& path) -> void;
+  auto destroy(void) -> void; // the device must be idle
+  auto resize(VkExtent2D extent) -> void; // the device must be idle, e.g. swap chain recreation
+
+  auto enabled(void) const -> bool;
+  // after a render pass with an external dependency into transfer reads of the image; the image is
+  // returned to layout afterwards
+  auto record_copy(VkCommandBuffer command_buffer, VkImage image, VkImageLayout layout, uint32_t frame_in_flight) -> void;
+  auto frame_complete(uint32_t frame_in_flight) -> void; // after that frame's fence wait
+  auto frames_exported(void) const -> std::size_t;
+private:
+  struct Slot {
+    VkBuffer buffer{VK_NULL_HANDLE};
+    memory::Allocation memory{};
+    bool coherent{true}; // otherwise the mapping is invalidated before the exporter reads it
+  };
+
+  auto create_slots(void) -> void;
+  auto destroy_slots(void) -> void;
+  auto acquire_slot(void) -> uint32_t;
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  VkDevice device{VK_NULL_HANDLE};
+  memory::DeviceAllocator* allocator{nullptr};
+  VkExtent2D extent{0, 0};
+  PixelOrder order{PixelOrder::Rgba};
+  uint32_t frames_in_flight{1};
+  uint64_t next_frame_number{0};
+
+  std::vector<Slot> slots;
+  std::vector<std::optional<std::pair<uint32_t, uint64_t>>> in_flight; // per frame in flight; slot, frame number
+  FrameExporter exporter;
+
+  std::mutex mutex; // guards free_slots, returned by the exporter thread
+  std::condition_variable slot_returned;
+  std::vector<uint32_t> free_slots;
+// ---- End of Class Members ----
+};
+
+} // end of namespace readback
+
+#endif // READBACK_H
@@ -0,0 +1,66 @@
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include <condition_variable>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include <set>
+#include <map>
+
+#include "thread_pool.h"
+
+namespace shader_watcher {
+
+// glslc -fshader-stage value for a source file, from its name (vert.glsl -> vertex, same as
+// shaders/compile.sh); nullopt when the name does not say
+auto stage_for(const std::filesystem::path& source) -> std::optional<std::string>;
+// vert.glsl -> vert.spv, next to the source
+auto output_for(const std::filesystem::path& source) -> std::filesystem::path;
+
+// watches one directory (inotify on linux, modification times elsewhere). edited .glsl files
+// are recompiled with glslc on the thread pool; every .spv that changes, whether rebuilt here or
+// by comp_shaders, is reported by poll(). a failed compile leaves the old .spv untouched
+struct ShaderWatcher {
+  ShaderWatcher() = default;
+  ~ShaderWatcher();
+
+// ---- Start of Utility Functions ----
+public:
+  auto create(const std::filesystem::path& directory, thread_pool::ThreadPool& pool) -> void;
+  auto destroy(void) -> void;
+
+  auto poll(std::vector<std::filesystem::path>& changed) -> void; // appends .spv files changed since the last poll
+private:
+  auto watch_loop(void) -> void;
+  auto on_file_changed(const std::filesystem::path& file) -> void;
+  auto compile(const std::filesystem::path& source) -> void;
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  std::filesystem::path directory;
+  thread_pool::ThreadPool* pool{nullptr};
+
+  std::thread watcher;
+  std::atomic<bool> stopping{false};
+  int inotify_fd{-1};
+  std::map<std::filesystem::path, std::filesystem::file_time_type> write_times; // polling fallback
+
+  std::mutex mutex; // guards everything below
+  std::set<std::filesystem::path> changed_outputs;
+  std::set<std::filesystem::path> compiling;
+  std::set<std::filesystem::path> recompile; // edited again while compiling
+  std::condition_variable compiles_done;
+// ---- End of Class Members ----
+};
+
+} // end of namespace shader_watcher
+
+#endif // SHADER_WATCHER_H
@@ -0,0 +1,75 @@
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mutex>
+
+#include "upload.h"
+#include "thread_pool.h"
+
+namespace texture_loader {
+
+// rgba8 pixels; levels is empty when only level 0 is there, otherwise the whole mip chain is
+struct Image {
+  std::vector<unsigned char> pixels;
+  uint32_t width{0};
+  uint32_t height{0};
+  std::vector<upload::ImageLevel> levels;
+};
+
+// produces an image on a decode thread, throws on failure
+using Source = std::function<Image(void)>;
+
+// decodes a jpeg, png, tga or bmp file with stb_image; throws std::runtime_error when it cannot
+auto decode_file(const std::string& path) -> Image;
+
+struct Completed {
+  std::size_t id{0}; // as given to request
+  Image image;
+  std::string error; // set when the source threw, image is then empty
+};
+
+// decodes images on a thread pool and hands them back as they finish, so nothing waits on a
+// decode unless it asks to. with generate_mips the cpu mip chain is built on the decode thread too
+struct TextureLoader {
+  TextureLoader() = default;
+  ~TextureLoader();
+
+  TextureLoader(const TextureLoader&) = delete;
+  TextureLoader& operator=(const TextureLoader&) = delete;
+
+// ---- Start of Utility Functions ----
+public:
+  auto create(thread_pool::ThreadPool& pool, bool generate_mips) -> void;
+  auto destroy(void) -> void; // waits for the decodes still running, their results are dropped
+
+  auto request(std::size_t id, const std::string& path) -> void;
+  auto request(std::size_t id, Source source) -> void;
+  auto take_completed(std::vector<Completed>& completed) -> void; // appends, never blocks
+  auto wait(void) -> void; // until every request has completed
+  auto outstanding(void) const -> std::size_t; // requested and not yet taken
+private:
+  auto finish(Completed completed) -> void;
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  thread_pool::ThreadPool* pool{nullptr};
+  bool generate_mips{false};
+
+  mutable std::mutex mutex;
+  std::condition_variable all_done;
+  std::size_t running{0}; // submitted to the pool, not finished
+  std::vector<Completed> done; // finished, not taken
+// ---- End of Class Members ----
+};
+
+} // end of namespace texture_loader
+
+#endif // TEXTURE_LOADER_H
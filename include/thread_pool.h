@@ -0,0 +1,53 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <queue>
+
+namespace thread_pool {
+
+// fixed set of worker threads pulling tasks from one fifo queue; meant for coarse, independent
+// jobs (pipeline compiles, file io) rather than fine grained parallel loops
+struct ThreadPool {
+  using Task = std::function<void(void)>;
+
+  ThreadPool(std::size_t thread_count = default_thread_count());
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+// ---- Start of Utility Functions ----
+public:
+  static auto default_thread_count(void) -> std::size_t;
+
+  auto submit(Task task) -> void;
+  auto wait_idle(void) -> void; // blocks until the queue is empty and no task is running
+  auto size(void) const -> std::size_t;
+private:
+  auto worker_loop(void) -> void;
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  std::vector<std::thread> workers;
+  std::queue<Task> tasks;
+  std::size_t running{0};
+  bool stopping{false};
+
+  std::mutex mutex;
+  std::condition_variable task_available;
+  std::condition_variable idle;
+// ---- End of Class Members ----
+};
+
+} // end of namespace thread_pool
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,65 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <cstdint>
+#include <atomic>
+#include <array>
+
+namespace triple_buffer {
+
+// lock-free handoff of whole values from one producer thread to one consumer thread. the
+// producer fills its back slot and publishes it; the consumer always gets the latest published
+// slot. neither side ever waits on the other, a fast producer simply overwrites values the
+// consumer never looked at. the three slots are reused forever, so containers inside T keep
+// their capacity once they have grown
+template<typename T>
+struct TripleBuffer {
+  TripleBuffer() = default;
+  TripleBuffer(const T& initial): slots{initial, initial, initial} {}
+
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+// ---- Start of Utility Functions ----
+public:
+  // producer side; the slot is private to the producer until publish()
+  auto write_slot(void) -> T& {
+    return slots[back];
+  }
+
+  auto publish(void) -> void {
+    auto previous = middle.exchange(static_cast<uint8_t>(back | FRESH), std::memory_order_acq_rel);
+    back = previous & INDEX;
+  }
+
+  // consumer side; the returned slot stays untouched by the producer until the next read()
+  auto read(void) -> const T& {
+    if(middle.load(std::memory_order_relaxed) & FRESH) {
+      auto previous = middle.exchange(front, std::memory_order_acq_rel);
+      front = previous & INDEX;
+    }
+    return slots[front];
+  }
+
+  auto has_fresh(void) const -> bool {
+    return (middle.load(std::memory_order_relaxed) & FRESH) != 0;
+  }
+private:
+  static constexpr uint8_t INDEX = 0x3;
+  static constexpr uint8_t FRESH = 0x4; // the middle slot was published and not read yet
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  std::array<T, 3> slots{};
+  uint8_t back{0}; // owned by the producer
+  std::atomic<uint8_t> middle{1}; // exchanged by both
+  uint8_t front{2}; // owned by the consumer
+// ---- End of Class Members ----
+};
+
+} // end of namespace triple_buffer
+
+#endif // TRIPLE_BUFFER_H
@@ -0,0 +1,166 @@
+#ifndef UPLOAD_H
+#define UPLOAD_H
+
+#include <vulkan/vulkan.h>
+
+#include <optional>
+#include <cstdint>
+#include <vector>
+#include <deque>
+
+#include "memory.h"
+
+namespace upload {
+
+// levels in a full mip chain of an image this size, down to 1x1
+auto mip_level_count(uint32_t width, uint32_t height) -> uint32_t;
+
+// one mip level of image data packed into a single upload, largest level first
+struct ImageLevel {
+  VkDeviceSize offset{0}; // into the data
+  VkDeviceSize size{0};
+  uint32_t width{0};
+  uint32_t height{0};
+};
+
+// the cpu fallback for when mipmaps cannot be blitted: box filters rgba8 pixels down to 1x1 (odd
+// sizes repeat the edge texel) and returns every level packed together, the original first, with
+// their places in levels. srgb pixels are averaged in linear space, like a blit would
+auto generate_mip_chain(const unsigned char* pixels, uint32_t width, uint32_t height, bool srgb, std::vector<ImageLevel>& levels) -> std::vector<unsigned char>;
+
+// identifies one submitted batch; tickets increase monotonically, so every ticket at or
+// below the last completed one has finished on the gpu
+using Ticket = uint64_t;
+
+// circular placement over a staging buffer of capacity bytes. head and tail are running
+// byte counts (never wrapped), a batch remembers head() when it is submitted and hands
+// it to release() once its fence signals, which frees everything staged before it
+struct StagingRing {
+  StagingRing() = default;
+  StagingRing(VkDeviceSize capacity);
+
+// ---- Start of Utility Functions ----
+public:
+  auto allocate(VkDeviceSize size, VkDeviceSize alignment) -> std::optional<VkDeviceSize>;
+  auto release(VkDeviceSize mark) -> void;
+  auto head(void) const -> VkDeviceSize;
+  auto in_use(void) const -> VkDeviceSize;
+private:
+  // N/A
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  VkDeviceSize capacity{0};
+private:
+  VkDeviceSize head_position{0};
+  VkDeviceSize tail_position{0};
+// ---- End of Class Members ----
+};
+
+// queue family ownership acquire half for everything a batch released; has to be recorded on
+// the destination queue after waiting on the semaphores, see UploadContext::take_acquires
+struct Acquire {
+  // stages that read uploaded resources; the semaphores are waited on and the barriers recorded at these
+  static constexpr VkPipelineStageFlags STAGES = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+  std::vector<VkSemaphore> semaphores;
+  std::vector<VkBufferMemoryBarrier> buffer_barriers;
+  std::vector<VkImageMemoryBarrier> image_barriers;
+
+public:
+  auto empty(void) const -> bool;
+  auto record(VkCommandBuffer command_buffer) const -> void;
+  auto clear(void) -> void;
+};
+
+// records copies and layout transitions for any number of resources into one command
+// buffer, then submits them together with a fence instead of draining the queue per copy.
+// source data is copied into the staging ring as soon as it is recorded, so callers can
+// free their memory straight away. when the upload queue belongs to a different family than
+// the queue that uses the resources, every resource is released to that family at the end
+// of the copy and the matching acquire barriers are collected for the consumer to record
+struct UploadContext {
+  static constexpr VkDeviceSize DEFAULT_STAGING_SIZE = 32ull * 1024 * 1024;
+
+  UploadContext() = default;
+
+// ---- Start of Utility Functions ----
+public:
+  auto create(VkDevice device, memory::DeviceAllocator& allocator, VkQueue queue, uint32_t queue_family, uint32_t destination_family, VkDeviceSize staging_size = DEFAULT_STAGING_SIZE) -> void;
+  auto destroy(void) -> void;
+
+  auto upload_buffer(VkBuffer destination, const void* data, VkDeviceSize size, VkDeviceSize destination_offset = 0) -> void;
+  // data is level 0; the rest of mip_levels are blitted down from it, which needs can_generate_mipmaps
+  auto upload_image(VkImage image, const void* data, VkDeviceSize size, uint32_t width, uint32_t height, uint32_t mip_levels = 1) -> void;
+  // every level is in data already, e.g. from generate_mip_chain; one copy for the lot
+  auto upload_image_levels(VkImage image, const void* data, VkDeviceSize size, const std::vector<ImageLevel>& levels) -> void;
+  auto copy_buffer(VkBuffer source, VkBuffer destination, VkDeviceSize size) -> void;
+  // the first mip_levels levels, all in the same layout
+  auto transition_image_layout(VkImage image, VkImageLayout old_layout, VkImageLayout new_layout, uint32_t mip_levels = 1) -> void;
+  // blits need a graphics queue, which the upload queue only is when it belongs to the destination family
+  auto can_generate_mipmaps(void) const -> bool;
+
+  auto submit(void) -> Ticket; // returns the ticket of the last batch when nothing was recorded
+  auto is_complete(Ticket ticket) -> bool; // non-blocking, also retires finished batches
+  auto wait(Ticket ticket) -> void;
+  auto flush(void) -> void; // submit and wait for everything
+  auto submit_count(void) const -> std::size_t;
+  auto bytes_staged(void) const -> VkDeviceSize; // copied into staging memory, every upload's source passes through once
+
+  auto transfers_ownership(void) const -> bool;
+  auto take_acquires(Acquire& acquire) -> void; // appends, the caller waits on and then owns the semaphores
+  auto recycle_semaphores(std::vector<VkSemaphore>& semaphores) -> void; // once the waits have completed
+private:
+  struct Batch {
+    VkCommandBuffer command_buffer{VK_NULL_HANDLE};
+    VkFence fence{VK_NULL_HANDLE};
+    Ticket ticket{0};
+    VkDeviceSize ring_mark{0}; // ring head when submitted
+    std::vector<std::pair<VkBuffer, memory::Allocation>> oversized; // staging too big for the ring
+    Acquire acquire; // only filled when ownership is transferred
+  };
+
+  auto recording(void) -> VkCommandBuffer;
+  auto stage(const void* data, VkDeviceSize size, VkBuffer& buffer) -> VkDeviceSize;
+  auto retire(bool block) -> void;
+  auto release_batch(Batch& batch) -> void;
+  auto release_buffer(VkBuffer buffer) -> void;
+  auto release_image(VkImage image, VkImageLayout old_layout, VkImageLayout new_layout, uint32_t mip_levels) -> void;
+  auto finish_image(VkImage image, uint32_t mip_levels) -> void;
+  auto generate_mipmaps(VkImage image, uint32_t width, uint32_t height, uint32_t mip_levels) -> void;
+// ---- End of Utility Functions ----
+
+// ---- Start of Class Members ----
+public:
+  // N/A
+private:
+  VkDevice device{VK_NULL_HANDLE};
+  memory::DeviceAllocator* allocator{nullptr};
+  VkQueue queue{VK_NULL_HANDLE};
+  uint32_t queue_family{0};
+  uint32_t destination_family{0};
+
+  VkCommandPool command_pool{VK_NULL_HANDLE};
+
+  VkBuffer staging_buffer{VK_NULL_HANDLE};
+  memory::Allocation staging_memory{};
+  StagingRing ring{};
+
+  std::optional<Batch> open_batch; // being recorded
+  std::deque<Batch> in_flight; // submitted, oldest first
+  std::vector<Batch> recycled; // finished, command buffer and fence ready for reuse
+
+  Acquire pending_acquire; // released by submitted batches, not yet taken by the destination queue
+  std::vector<VkSemaphore> free_semaphores;
+
+  Ticket next_ticket{1};
+  Ticket completed_ticket{0};
+  std::size_t submits{0};
+  VkDeviceSize staged_bytes{0};
+// ---- End of Class Members ----
+};
+
+} // end of namespace upload
+
+#endif // UPLOAD_H
@@ -7,14 +7,40 @@
 
 #include <functional>
 #include <stdexcept>
+#include <exception>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <optional>
 #include <iostream>
 #include <cstdlib>
 #include <utility>
+#include <filesystem>
+#include <string>
 #include <vector>
+#include <array>
 
 #include "camera.h"
-
-#define ENABLE_VALIDATION_LAYERS // enabled by default
+#include "memory.h"
+#include "upload.h"
+#include "ktx.h"
+#include "asset_pack.h"
+#include "texture_loader.h"
+#include "bindless.h"
+#include "descriptors.h"
+#include "pipeline_cache.h"
+#include "pipeline_manager.h"
+#include "thread_pool.h"
+#include "job_system.h"
+#include "triple_buffer.h"
+#include "shader_watcher.h"
+#include "readback.h"
+#include "gpu_profiler.h"
+#include "cpu_profiler.h"
+#include "frame_stats.h"
+
+#define ENABLE_SHADER_HOT_RELOAD // enabled by default, watches SHADER_DIRECTORY while running
 
 // private structure forward declarations
 struct QueueFamilyIndices;
@@ -26,15 +52,83 @@ const std::vector<const char*> validation_layers = {
   "VK_LAYER_KHRONOS_validation"
 };
 
+// relative to the working directory (build/)
+const std::string PIPELINE_CACHE_PATH = "pipeline_cache.bin";
+const std::string SHADER_DIRECTORY = "../shaders";
+const std::string VERTEX_SHADER_PATH = SHADER_DIRECTORY + "/vert.spv";
+const std::string VERTEX_ARENA_SHADER_PATH = SHADER_DIRECTORY + "/vert_arena.spv"; // transforms from the uniform arena, not push constants
+const std::string FRAGMENT_SHADER_PATH = SHADER_DIRECTORY + "/frag.spv";
+const std::string FRAGMENT_BINDLESS_SHADER_PATH = SHADER_DIRECTORY + "/frag_bindless.spv";
+
 const std::vector<const char*> device_extensions = {
   VK_KHR_SWAPCHAIN_EXTENSION_NAME
 };
 
-#ifdef ENABLE_VALIDATION_LAYERS
-  const bool enable_validation_layers = true;
+#ifdef ENABLE_SHADER_HOT_RELOAD
+  const bool enable_shader_hot_reload = true;
 #else
-  const bool enable_validation_layers = false;
-#endif // ENABLE_VALIDATION_LAYERS
+  const bool enable_shader_hot_reload = false;
+#endif // ENABLE_SHADER_HOT_RELOAD
+
+struct ApplicationConfig {
+  std::size_t record_threads{1}; // more than 1 records secondary command buffers in parallel
+  std::size_t worker_threads{job_system::JobSystem::default_thread_count()}; // frame jobs, the render thread helps too
+  std::size_t decode_threads{thread_pool::ThreadPool::default_thread_count()}; // texture decodes, streamed in while frames render
+  std::size_t object_count{1}; // objects in the scene, laid out on a grid, one draw each
+  std::size_t frame_limit{0}; // stop after this many frames, 0 runs until the window is closed
+  double simulation_hz{120.0}; // fixed simulation timestep, independent of the render rate
+  bool headless{false}; // no window or swap chain, frames are rendered into offscreen images
+  bool validation{true}; // khronos validation layers and the debug messenger, off for benchmarks
+  readback::ExportFormat export_format{readback::ExportFormat::None}; // copy every rendered frame back and write it out
+  std::string export_path{"frames"}; // directory, or a file/fifo for ExportFormat::Stream
+  std::size_t trace_frames{0}; // write a chrome trace of the first n frames; F12 captures more at any time
+  std::string trace_path{"trace.json"};
+  double hitch_milliseconds{50.0}; // cpu frames longer than this are logged with their slowest phase, 0 disables
+  std::size_t stats_interval{0}; // frames between percentile reports, 0 only reports once at the end
+  std::string stats_csv_path; // interval reports go here as csv instead of stdout when set
+  // synthetic scene, for benchmarking; objects cycle through the meshes and materials, materials
+  // through the textures. 0 meshes draws the built-in quad, 0 textures loads the example texture
+  std::size_t scene_meshes{0};
+  std::size_t scene_textures{0};
+  std::size_t scene_materials{1}; // one descriptor set per material per frame in flight
+  uint32_t scene_texture_size{256}; // width and height of every generated texture
+  // lay down the depth of every object in a first subpass, then shade with depth writes off so
+  // only the visible fragment of each pixel runs the fragment shader
+  bool depth_prepass{false};
+  // cooked by asset_cooker; its textures and meshes replace the example texture and the built-in
+  // or generated meshes (whichever kind it has none of is left as it was)
+  std::string asset_pack_path;
+  // every texture in one update-after-bind descriptor array, bound once per command buffer, with
+  // materials picking theirs by index from a push constant. needs vulkan 1.2 descriptor indexing,
+  // without it the descriptor set per material is kept
+  bool bindless{false};
+  // model matrices go out as push constants with every draw and the frame's uniforms only hold the
+  // camera. off (or when the device has too little push constant space) every object's transforms
+  // are bumped into the frame's uniform arena and bound with a dynamic offset per draw
+  bool push_transforms{true};
+};
+
+// a pre-compressed file for a texture; only its header is read until it is chosen
+struct TextureVariant {
+  std::filesystem::path path;
+  ktx::Header header;
+};
+
+// a mesh's range of the shared vertex and index buffers
+struct MeshRange {
+  uint32_t first_index{0};
+  uint32_t index_count{0};
+  int32_t vertex_offset{0};
+};
+
+// everything the render thread needs from one simulation tick; written by the simulation thread,
+// read-only once published
+struct FrameSnapshot {
+  uint64_t tick{0};
+  double time{0.0}; // simulated seconds
+  glm::vec3 camera_position{0.0f};
+  std::vector<glm::mat4> object_transforms; // same order as the scene's objects
+};
 
 struct VulkanApplication {
   using KeyCallback = std::function<void(GLFWwindow*, int, int, int, int)>;
@@ -43,8 +137,19 @@ struct VulkanApplication {
   static const std::size_t WIDTH  = 800;
   static const std::size_t HEIGHT = 600;
   static const std::size_t MAX_FRAMES_IN_FLIGHT = 2;
+  static const VkFormat OFFSCREEN_FORMAT = VK_FORMAT_B8G8R8A8_SRGB; // same as the preferred swap chain format
+  static const VkFormat TEXTURE_FORMAT = VK_FORMAT_R8G8B8A8_SRGB; // decoded textures are rgba8
+  static constexpr const char* TEXTURE_PATH = "../textures/example_a.jpg"; // <stem>.*.ktx2 beside it are preferred
+  static constexpr float NEAR_PLANE = 0.01f; // no far plane, the projection is reverse-z to infinity
+  static const std::size_t UNIFORM_ARENA_SIZE = 4 * 1024 * 1024; // uniform bytes per frame in flight
+  static const std::size_t TRANSFORM_GRAIN = 1024; // objects per transform update job
+  static constexpr std::size_t MAX_SIMULATION_BACKLOG = 8; // ticks; further behind than this and the backlog is dropped
+  static const std::size_t DEFAULT_TRACE_FRAMES = 120; // captured by F12 when config.trace_frames is not set
+  static const VkDeviceSize STREAM_UPLOAD_BUDGET = 16 * 1024 * 1024; // decoded texture bytes uploaded per frame, at least one texture
+  static constexpr uint32_t MAX_BINDLESS_TEXTURES = 4096; // slots in the bindless texture array, less when the device allows fewer
 
   VulkanApplication() = default;
+  VulkanApplication(ApplicationConfig config);
 
 // ---- Main Application Pipeline ----
 public:
@@ -62,30 +167,55 @@ public:
   auto get_window_user_ptr(void) const -> void*;
   auto add_key_callback(KeyCallback key_callback) -> void;
   auto add_cursor_callback(CursorCallback cursor_callback) -> void;
+  auto average_record_microseconds(void) const -> double; // cpu time in record_command_buffer per frame
+  auto frames_per_second(void) const -> double; // over the last main_loop
+  auto gpu_timings(void) const -> const std::vector<gpu_profiler::ScopeStats>&; // empty without timestamp support
+  auto frame_statistics(void) const -> const frame_stats::FrameStats&; // over the last main_loop
+  // loading batch, from the first upload recorded until a frame saw it complete (so to within a frame)
+  auto upload_milliseconds(void) const -> double;
+  auto memory_usage(void) const -> const memory::BlockStats&; // at the end of the last main_loop
 
 private:
+  auto create_job_system(void) -> void;
   auto create_instance(void) -> void;
   auto setup_debug_messenger(void) -> void;
   auto pick_physical_device(void) -> void;
   auto create_logical_device(void) -> void;
+  auto query_bindless_capacity(void) -> uint32_t;
   auto create_surface(void) -> void;
   auto create_swap_chain(void) -> void;
+  auto create_offscreen_images(void) -> void;
   auto create_image_views(void) -> void;
+  auto create_depth_resources(void) -> void;
   auto create_render_pass(void) -> void;
   auto create_descriptor_set_layout(void) -> void;
-  auto create_descriptor_pool(void) -> void;
+  auto create_descriptor_allocator(void) -> void;
+  auto create_bindless_table(void) -> void;
   auto create_descriptor_sets(void) -> void;
+  auto material_set(uint32_t frame, uint32_t texture) -> VkDescriptorSet;
+  auto create_pipeline_layout(void) -> void;
   auto create_graphics_pipeline(void) -> void;
   auto create_framebuffers(void) -> void;
   auto create_command_pool(void) -> void;
-  auto create_texture_image(void) -> void;
-  auto create_texture_image_view(void) -> void;
+  auto create_upload_context(void) -> void;
+  auto decode_texture_image(void) -> void;
+  auto create_texture_images(void) -> void;
+  auto create_pack_textures(void) -> void;
+  auto create_texture_image_views(void) -> void;
+  auto stream_textures(void) -> void;
+  auto texture_view(uint32_t texture) const -> VkImageView;
+  auto update_material_sets(uint32_t texture) -> void;
+  auto texture_slot(uint32_t texture) const -> uint32_t;
+  auto write_texture_slot(VkImageView view) -> uint32_t;
   auto create_texture_sampler(void) -> void;
-  auto create_vertex_buffer(void) -> void;
-  auto create_index_buffer(void) -> void;
+  auto create_mesh_buffers(void) -> void;
+  auto create_pack_meshes(void) -> void;
   auto create_uniform_buffers(void) -> void;
   auto create_command_buffers(void) -> void;
+  auto create_scene(void) -> void;
   auto create_sync_objects(void) -> void;
+  auto create_readback(void) -> void;
+  auto create_gpu_profiler(void) -> void;
 
   auto create_debug_utils_messenger_ext(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* p_create_info, const VkAllocationCallbacks* p_allocator, VkDebugUtilsMessengerEXT* p_debug_msnger) -> VkResult;
   auto destroy_debug_utils_messenger_ext(VkInstance instance, VkDebugUtilsMessengerEXT debug_msnger, const VkAllocationCallbacks* p_allocator) -> void;
@@ -93,19 +223,30 @@ private:
   auto is_device_suitable(VkPhysicalDevice device) -> bool;
   auto check_device_extension_support(VkPhysicalDevice device) -> bool;
   auto query_swap_chain_support(VkPhysicalDevice device) -> SwapChainSupportDetails;
+  auto find_depth_format(void) -> VkFormat;
+  auto format_supports_linear_blit(VkFormat format) -> bool;
+  auto format_supports_sampling(VkFormat format) -> bool;
   auto record_command_buffer(VkCommandBuffer command_buffer, uint32_t image_index) -> void;
+  auto record_secondary_command_buffers(uint32_t image_index, VkPipeline depth, VkPipeline pipeline) -> void;
+  auto record_draws(VkCommandBuffer command_buffer, VkPipeline pipeline, std::size_t first_object, std::size_t object_count) -> void;
+  auto should_close(void) const -> bool;
   auto recreate_swap_chain(void) -> void;
   auto cleanup_swap_chain(void) -> void;
-  auto find_memory_type(uint32_t type_filter, VkMemoryPropertyFlags properties) -> uint32_t;
-  auto create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& buffer_memory) -> void;
-  auto copy_buffer(VkBuffer src_buffer, VkBuffer dest_buffer, VkDeviceSize size) -> void;
+  auto create_allocator(void) -> void;
+  auto create_pipeline_cache(void) -> void;
+  auto create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, memory::Allocation& buffer_memory) -> void;
   auto update_uniform_buffer(uint32_t current_image_index) -> void;
-  auto create_image(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& image_memory) -> void;
-  auto begin_single_time_commands(void) -> VkCommandBuffer;
-  auto end_single_time_commands(VkCommandBuffer command_buffer) -> void;
-  auto transition_image_layout(VkImage image, VkFormat format, VkImageLayout old_layout, VkImageLayout new_layout) -> void;
-  auto copy_buffer_to_image(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) -> void;
-  auto create_image_view(VkImage image, VkFormat format) -> VkImageView;
+  auto create_image(uint32_t width, uint32_t height, uint32_t mip_levels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, memory::Allocation& image_memory) -> void;
+  auto create_image_view(VkImage image, VkFormat format, VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT, uint32_t mip_levels = 1) -> VkImageView;
+
+  auto start_simulation(void) -> void;
+  auto stop_simulation(void) -> void;
+  auto simulation_loop(void) -> void;
+  auto simulate(double step_seconds) -> void;
+  auto sample_input(void) -> void;
+
+  auto create_shader_watcher(void) -> void;
+  auto reload_changed_shaders(void) -> void;
 
   auto update_glfw_delta_time(void) -> void;
 // ---- End of Setup/Utility ----
@@ -122,8 +263,10 @@ public:
   bool framebuffer_resized{false};
 
 private:
+  ApplicationConfig config{};
+
   GLFWwindow* window;
-  camera::Camera main_camera{};
+  camera::Camera main_camera{}; // owned by the simulation thread once it is running
 
   double glfw_delta_time{0.0};
 
@@ -132,6 +275,26 @@ private:
 
   std::pair<double, double> cursor_pos;
 
+  // input is sampled by the render thread (glfw events only arrive there) and consumed by the
+  // simulation thread, which ticks at config.simulation_hz and publishes a snapshot per tick
+  enum HeldKey : uint32_t {
+    KEY_FORWARD  = 1 << 0,
+    KEY_BACKWARD = 1 << 1,
+    KEY_LEFT     = 1 << 2,
+    KEY_RIGHT    = 1 << 3,
+    KEY_UP       = 1 << 4,
+    KEY_DOWN     = 1 << 5
+  };
+  std::atomic<uint32_t> held_keys{0};
+
+  std::thread simulation_thread;
+  std::atomic<bool> simulation_stopping{false};
+  std::exception_ptr simulation_error; // rethrown by main_loop
+  std::atomic<bool> close_requested{false}; // stops main_loop, e.g. when the simulation fails
+  triple_buffer::TripleBuffer<FrameSnapshot> frame_states;
+  double simulation_time{0.0};
+  uint64_t simulation_tick{0};
+
   VkInstance instance;
 
   VkDebugUtilsMessengerEXT debug_messenger;
@@ -142,6 +305,13 @@ private:
   
   VkQueue graphics_queue;
   VkQueue present_queue;
+  VkQueue transfer_queue; // dedicated when the device has one, otherwise aliases another queue
+  VkQueue compute_queue;
+  uint32_t graphics_family_index{0};
+  uint32_t transfer_family_index{0};
+  uint32_t compute_family_index{0};
+
+  memory::DeviceAllocator allocator; // every buffer/image is sub-allocated out of its blocks
 
   VkSwapchainKHR swap_chain;
   std::vector<VkImage> swap_chain_images;
@@ -150,38 +320,147 @@ private:
 
   std::vector<VkImageView> swap_chain_image_views;
   std::vector<VkFramebuffer> swap_chain_framebuffers;
+  // headless; swap_chain_images are our own images, one per frame in flight, no swap_chain or surface
+  std::vector<memory::Allocation> offscreen_image_memory;
+  // one depth buffer shared by the frames in flight, the render pass orders their use of it
+  VkFormat depth_format{VK_FORMAT_UNDEFINED};
+  VkImage depth_image{VK_NULL_HANDLE};
+  memory::Allocation depth_image_memory{};
+  VkImageView depth_image_view{VK_NULL_HANDLE};
+  readback::Readback readback; // only enabled with config.export_format, copies the final image of every frame
+  gpu_profiler::GpuProfiler gpu_profiler; // timestamps around the passes of every frame, read back a frame in flight later
+  cpu_profiler::Capture trace_capture; // cpu scopes of every thread over the next few frames, driven by main_loop
+  bool trace_requested{false}; // F12
+  frame_stats::FrameStats frame_stats; // frame time percentiles and hitches, fed by main_loop and draw_frame
+
+  thread_pool::ThreadPool worker_pool; // background jobs, e.g. pipeline compiles
+  pipeline_cache::PipelineCache pipeline_cache; // passed to every pipeline creation, persisted between runs
+  pipeline_manager::PipelineManager pipelines; // compiles on worker_pool, owns every VkPipeline
+  shader_watcher::ShaderWatcher shader_changes; // only running with ENABLE_SHADER_HOT_RELOAD
+  std::vector<std::filesystem::path> changed_shaders; // scratch for reload_changed_shaders
 
   VkRenderPass render_pass;
   VkPipelineLayout pipeline_layout;
-  VkPipeline graphics_pipeline;
+  pipeline_manager::PipelineHandle graphics_pipeline{pipeline_manager::INVALID_PIPELINE};
+  pipeline_manager::PipelineHandle depth_pipeline{pipeline_manager::INVALID_PIPELINE}; // the pre-pass, vertex shader only
+  uint32_t subpass_count{1}; // 2 with the depth pre-pass, which is subpass 0
 
   VkCommandPool command_pool;
   std::vector<VkCommandBuffer> command_buffers; // destroyed when its command pool goes out of scope
 
+  // read on jobs while the device comes up, used by create_texture_images; declared before jobs
+  // so a job still queued when init fails finishes before these are destroyed
+  std::vector<TextureVariant> texture_variants; // the example texture pre-compressed, best first; the first the device can sample is loaded
+  asset_pack::Pack assets; // mapped on the decode job, released once everything in it is staged
+  job_system::Counter texture_decode;
+
+  // textures that need decoding are decoded on decode_pool and streamed in by stream_textures; the
+  // pool is declared after the loader so its queued decodes finish while the loader is still there
+  texture_loader::TextureLoader texture_decoder;
+  std::unique_ptr<thread_pool::ThreadPool> decode_pool;
+
+  // per-frame work (transforms, recording, decoding) is split into jobs; created first in init_vulkan
+  std::unique_ptr<job_system::JobSystem> jobs;
+
+  // parallel recording; one pool per (frame in flight, partition of the draw list) so that resetting
+  // and recording never needs a lock, indexed [frame * record_partitions + partition]. each pool has
+  // a secondary per subpass, indexed [(frame * subpass_count + subpass) * record_partitions + partition]
+  std::size_t record_partitions{0};
+  std::vector<VkCommandPool> record_command_pools;
+  std::vector<VkCommandBuffer> secondary_command_buffers;
+  double record_microseconds_total{0.0};
+  std::size_t recorded_frames{0};
+  double loop_frames_per_second{0.0};
+
+  upload::UploadContext uploader; // batches resource uploads instead of one queue drain per copy
+  upload::Ticket upload_ticket{0};
+  upload::Acquire frame_acquire; // ownership acquires recorded into the current frame
+  std::array<std::vector<VkSemaphore>, MAX_FRAMES_IN_FLIGHT> upload_semaphores_in_flight; // waited on by each frame
+  std::vector<VkSemaphore> wait_semaphores; // scratch for draw_frame, reused every frame
+  std::vector<VkPipelineStageFlags> wait_stages;
+
   std::vector<VkSemaphore> semaphores_image_available_render;
   std::vector<VkSemaphore> semaphores_render_finished_present;
   std::vector<VkFence> fences_in_flight;
   uint32_t current_frame{0};
 
   VkBuffer vertex_buffer;
-  VkDeviceMemory vertex_buffer_memory;
+  memory::Allocation vertex_buffer_memory;
 
   VkBuffer index_buffer;
-  VkDeviceMemory index_buffer_memory;
+  memory::Allocation index_buffer_memory;
 
-  VkDescriptorPool descriptor_pool;
+  // layouts are owned by descriptor_layouts; sets that never change once written (everything but the
+  // bindless array) come from descriptor_set_cache, which allocates from descriptor_allocator
+  descriptors::LayoutCache descriptor_layouts;
+  descriptors::DescriptorAllocator descriptor_allocator;
+  descriptors::SetCache descriptor_set_cache;
   VkDescriptorSetLayout descriptor_set_layout;
-  std::vector<VkDescriptorSet> descriptor_sets; // one for each frame in flight
-
-  // as many uniform buffers as frames in flight
+  // one per material for each frame in flight, [frame * materials + material], shared between materials
+  // sampling the same texture; with bindless textures the sets only hold the frame's uniform buffer, so
+  // there is one per frame in flight
+  std::vector<VkDescriptorSet> descriptor_sets;
+
+  // bindless textures, when enabled and supported (bindless_capacity is 0 otherwise). one set shared by
+  // every frame; a texture gets a fresh slot once uploaded, so no frame in flight can be sampling a
+  // slot as it is written, and freed slots are only reused after MAX_FRAMES_IN_FLIGHT frames
+  uint32_t bindless_capacity{0};
+  VkDescriptorSetLayout bindless_set_layout{VK_NULL_HANDLE};
+  descriptors::DescriptorAllocator bindless_allocator; // update-after-bind pools
+  VkDescriptorSet bindless_set{VK_NULL_HANDLE};
+  bindless::SlotAllocator texture_slots;
+
+  // as many uniform buffers as frames in flight; each one is an arena that the frame's uniforms are
+  // bumped into, bound with a dynamic offset. with push_transforms only the camera is, and every draw
+  // pushes its model matrix straight out of frame_snapshot; otherwise every object's transforms are,
+  // with a dynamic offset per draw
   std::vector<VkBuffer> uniform_buffers;
-  std::vector<VkDeviceMemory> uniform_buffers_memory;
+  std::vector<memory::Allocation> uniform_buffers_memory;
   std::vector<void*> uniform_buffers_mapped;
-
-  VkImage texture_image;
-  VkDeviceMemory texture_image_memory;
-  VkImageView texture_image_view;
-  VkSampler texture_sampler;
+  std::vector<memory::LinearAllocator> uniform_arenas;
+  VkDeviceSize min_uniform_alignment{1};
+  bool push_transforms{true}; // config.push_transforms, unless the device cannot take a draw's constants
+  uint32_t camera_uniform_offset{0}; // dynamic offset of this frame's camera, with push_transforms
+  std::vector<uint32_t> object_uniform_offsets; // dynamic offsets written this frame without, reused between frames
+  const FrameSnapshot* frame_snapshot{nullptr}; // read by update_uniform_buffer, untouched by the simulation until the next read
+
+  std::vector<glm::vec3> object_positions; // one draw per object, filled by create_scene
+  struct ObjectDraw {
+    uint32_t mesh{0};
+    uint32_t material{0};
+  };
+  std::vector<ObjectDraw> object_draws; // same order as object_positions
+  std::vector<MeshRange> meshes; // every mesh lives in vertex_buffer/index_buffer
+  std::vector<uint32_t> material_textures; // texture sampled by each material
+
+  struct Texture {
+    VkImage image{VK_NULL_HANDLE};
+    memory::Allocation memory{};
+    VkImageView view{VK_NULL_HANDLE};
+    uint32_t mip_levels{1};
+    VkFormat format{TEXTURE_FORMAT};
+    bool ready{false}; // uploaded; descriptors sample the placeholder until then
+    uint32_t slot{0}; // in the bindless texture array, once ready
+  };
+  std::vector<Texture> textures;
+  Texture placeholder_texture; // 1x1 grey
+
+  // decoded and not uploaded yet, over budget for this frame
+  std::vector<texture_loader::Completed> streamed_textures;
+  // uploaded, materials are pointed at it once the batch lands
+  struct TextureSwap {
+    uint32_t texture{0};
+    upload::Ticket ticket{0};
+  };
+  std::vector<TextureSwap> texture_swaps;
+  bool blit_mipmaps{false};
+  std::chrono::high_resolution_clock::time_point stream_start;
+  std::optional<double> texture_stream_duration; // milliseconds until every streamed texture was in use
+  VkSampler texture_sampler; // shared by every texture
+
+  std::chrono::high_resolution_clock::time_point upload_start;
+  std::optional<double> upload_duration; // milliseconds, once the loading batch is seen complete
+  memory::BlockStats memory_at_exit{};
 // ---- End of Class Members ----
 };
 
@@ -6,8 +6,12 @@ echo "[+] compile.sh running glslc..."
 if [ $1 == "__cmake" ]
 then
 	glslc -fshader-stage=vertex ../shaders/vert.glsl -o ../shaders/vert.spv
+	glslc -fshader-stage=vertex ../shaders/vert_arena.glsl -o ../shaders/vert_arena.spv
 	glslc -fshader-stage=fragment ../shaders/frag.glsl -o ../shaders/frag.spv
+	glslc -fshader-stage=fragment ../shaders/frag_bindless.glsl -o ../shaders/frag_bindless.spv
 else
   glslc -fshader-stage=vertex vert.glsl -o vert.spv
+  glslc -fshader-stage=vertex vert_arena.glsl -o vert_arena.spv
   glslc -fshader-stage=fragment frag.glsl -o frag.spv
+  glslc -fshader-stage=fragment frag_bindless.glsl -o frag_bindless.spv
 fi
\ No newline at end of file
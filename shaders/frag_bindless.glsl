@@ -0,0 +1,19 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require // runtime sized descriptor arrays
+
+// every texture in one array, the material's is picked with a push constant
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+// after the vertex stage's model matrix in the same push constant range
+layout(push_constant) uniform Draw {
+  layout(offset = 64) uint texture_index;
+} draw;
+
+layout(location = 0) in vec3 frag_colour;
+layout(location = 1) in vec2 frag_tex_coord;
+
+layout(location = 0) out vec4 out_colour;
+
+void main() {
+  out_colour = vec4(texture(textures[draw.texture_index], frag_tex_coord * 2.0).rgb * frag_colour, 1.0);
+}
\ No newline at end of file
@@ -1,11 +1,16 @@
 #version 450
 
+// the camera, shared by every draw of the frame
 layout(binding = 0) uniform UniformBufferObject {
-  mat4 model;
   mat4 view;
   mat4 projection;
 } ubo;
 
+// pushed with every draw
+layout(push_constant) uniform Draw {
+  mat4 model;
+} draw;
+
 layout(location = 0) in vec3 in_position;
 layout(location = 1) in vec3 in_colour;
 layout(location = 2) in vec2 in_tex_coord;
@@ -14,7 +19,7 @@ layout(location = 0) out vec3 frag_colour;
 layout(location = 1) out vec2 frag_tex_coord;
 
 void main() {
-  gl_Position = ubo.projection * ubo.view * ubo.model * vec4(in_position, 1.0);
+  gl_Position = ubo.projection * ubo.view * draw.model * vec4(in_position, 1.0);
   frag_colour = in_colour;
   frag_tex_coord = in_tex_coord;
 }
\ No newline at end of file
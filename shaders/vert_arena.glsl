@@ -0,0 +1,22 @@
+#version 450
+
+// every object's transforms bumped into the frame's uniform arena, for when they are not pushed as
+// constants (vert.glsl); the descriptor's dynamic offset picks the object
+layout(binding = 0) uniform UniformBufferObject {
+  mat4 model;
+  mat4 view;
+  mat4 projection;
+} ubo;
+
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec3 in_colour;
+layout(location = 2) in vec2 in_tex_coord;
+
+layout(location = 0) out vec3 frag_colour;
+layout(location = 1) out vec2 frag_tex_coord;
+
+void main() {
+  gl_Position = ubo.projection * ubo.view * ubo.model * vec4(in_position, 1.0);
+  frag_colour = in_colour;
+  frag_tex_coord = in_tex_coord;
+}
\ No newline at end of file
@@ -0,0 +1,388 @@
+#include <unordered_map>
+#include <stdexcept>
+#include <filesystem>
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+#ifdef _WIN32
+  #define WIN32_LEAN_AND_MEAN
+  #define NOMINMAX
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+#include "asset_pack.h"
+
+static auto align_up(uint64_t value, uint64_t alignment) -> uint64_t;
+static auto make_entry(const std::string& name, uint64_t source_hash, asset_pack::AssetType type) -> asset_pack::Entry;
+static auto resolve_obj_index(const std::string& token, std::size_t count) -> std::size_t;
+static auto is_texture_format(uint32_t format) -> bool;
+
+namespace asset_pack {
+
+auto content_hash(const void* data, std::size_t size) -> uint64_t {
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for(std::size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+auto cook_texture(const std::string& name, uint64_t source_hash, const unsigned char* pixels, uint32_t width, uint32_t height) -> CookedAsset {
+  CookedAsset asset{};
+  asset.entry = make_entry(name, source_hash, AssetType::Texture);
+  asset.entry.format = VK_FORMAT_R8G8B8A8_SRGB;
+  asset.entry.width = width;
+  asset.entry.height = height;
+
+  std::vector<upload::ImageLevel> levels;
+  asset.data = upload::generate_mip_chain(pixels, width, height, true, levels);
+  asset.entry.mip_levels = static_cast<uint32_t>(levels.size());
+  asset.entry.size = asset.data.size();
+  return asset;
+}
+
+auto cook_mesh(const std::string& name, uint64_t source_hash, const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices) -> CookedAsset {
+  CookedAsset asset{};
+  asset.entry = make_entry(name, source_hash, AssetType::Mesh);
+  asset.entry.vertex_count = static_cast<uint32_t>(vertices.size());
+  asset.entry.index_count = static_cast<uint32_t>(indices.size());
+
+  auto vertex_bytes = vertices.size() * sizeof(Vertex);
+  auto index_bytes = indices.size() * sizeof(uint16_t);
+  asset.data.resize(vertex_bytes + index_bytes);
+  if(vertex_bytes != 0) memcpy(asset.data.data(), vertices.data(), vertex_bytes);
+  if(index_bytes != 0) memcpy(asset.data.data() + vertex_bytes, indices.data(), index_bytes);
+  asset.entry.size = asset.data.size();
+  return asset;
+}
+
+auto parse_obj(const std::string& text, std::vector<Vertex>& vertices, std::vector<uint16_t>& indices) -> void {
+  std::vector<std::array<float, 3>> positions;
+  std::vector<std::array<float, 2>> uvs;
+  std::unordered_map<uint64_t, uint16_t> emitted; // (position, uv) -> vertex
+
+  std::istringstream lines(text);
+  std::string line;
+  for(std::size_t number = 1; std::getline(lines, line); ++number) {
+    std::istringstream fields(line);
+    std::string kind;
+    fields >> kind;
+
+    if(kind == "v") {
+      auto& position = positions.emplace_back();
+      fields >> position[0] >> position[1] >> position[2];
+    } else if(kind == "vt") {
+      auto& uv = uvs.emplace_back();
+      fields >> uv[0] >> uv[1];
+      uv[1] = 1.0f - uv[1]; // obj puts the origin bottom left, vulkan images start at the top
+    } else if(kind == "f") {
+      std::vector<uint16_t> polygon;
+      for(std::string corner; fields >> corner;) {
+        auto slash = corner.find('/');
+        auto position = resolve_obj_index(corner.substr(0, slash), positions.size());
+        auto uv = std::size_t{0}; // 0 is no texture coordinate
+        if(slash != std::string::npos) {
+          auto uv_token = corner.substr(slash + 1, corner.find('/', slash + 1) - slash - 1);
+          if(!uv_token.empty())
+            uv = resolve_obj_index(uv_token, uvs.size()) + 1;
+        }
+        if(position >= positions.size() || uv > uvs.size())
+          throw std::runtime_error("Error - obj line " + std::to_string(number) + " references a missing vertex");
+
+        auto key = (static_cast<uint64_t>(position) << 32) | uv;
+        auto [it, inserted] = emitted.try_emplace(key, static_cast<uint16_t>(vertices.size()));
+        if(inserted) {
+          if(vertices.size() > UINT16_MAX)
+            throw std::runtime_error("Error - obj has more vertices than 16 bit indices can address");
+          Vertex vertex{};
+          std::copy(positions[position].begin(), positions[position].end(), vertex.position);
+          std::fill(std::begin(vertex.colour), std::end(vertex.colour), 1.0f);
+          if(uv != 0)
+            std::copy(uvs[uv - 1].begin(), uvs[uv - 1].end(), vertex.uv);
+          vertices.push_back(vertex);
+        }
+        polygon.push_back(it->second);
+      }
+
+      if(polygon.size() < 3)
+        throw std::runtime_error("Error - obj line " + std::to_string(number) + " has a face with fewer than 3 corners");
+      for(std::size_t i = 2; i < polygon.size(); ++i) {
+        indices.push_back(polygon[0]);
+        indices.push_back(polygon[i - 1]);
+        indices.push_back(polygon[i]);
+      }
+    }
+    // normals, groups, materials and comments are not needed by the vertex layout
+  }
+}
+
+auto texture_levels(const Entry& entry) -> std::vector<upload::ImageLevel> {
+  std::vector<upload::ImageLevel> levels;
+  VkDeviceSize offset = 0;
+  for(uint32_t level = 0; level < entry.mip_levels && level < 32; ++level) { // no 32 bit size has more levels
+    auto width = std::max<uint32_t>(entry.width >> level, 1);
+    auto height = std::max<uint32_t>(entry.height >> level, 1);
+    VkDeviceSize size = static_cast<VkDeviceSize>(width) * height * 4;
+    levels.push_back({offset, size, width, height});
+    offset += size;
+  }
+  return levels;
+}
+
+auto write(const std::string& path, const std::vector<CookedAsset>& assets) -> void {
+  FileHeader header{};
+  header.entry_count = static_cast<uint32_t>(assets.size());
+
+  std::vector<Entry> table;
+  uint64_t offset = sizeof(FileHeader);
+  for(const auto& asset : assets) {
+    offset = align_up(offset, DATA_ALIGNMENT);
+    auto& entry = table.emplace_back(asset.entry);
+    entry.offset = offset;
+    entry.size = asset.data.size();
+    offset += entry.size;
+  }
+  header.toc_offset = align_up(offset, DATA_ALIGNMENT);
+
+  auto temporary_path = path + ".tmp";
+  {
+    std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+    if(!out)
+      throw std::runtime_error("Error - unable to write " + temporary_path);
+
+    const char padding[DATA_ALIGNMENT] = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t position = sizeof(header);
+    for(std::size_t i = 0; i < assets.size(); ++i) {
+      out.write(padding, static_cast<std::streamsize>(table[i].offset - position));
+      out.write(reinterpret_cast<const char*>(assets[i].data.data()), static_cast<std::streamsize>(assets[i].data.size()));
+      position = table[i].offset + table[i].size;
+    }
+    out.write(padding, static_cast<std::streamsize>(header.toc_offset - position));
+    out.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(Entry)));
+    out.flush();
+    if(!out)
+      throw std::runtime_error("Error - failed writing " + temporary_path);
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temporary_path, path, error);
+  if(error)
+    throw std::runtime_error("Error - unable to replace " + path + ": " + error.message());
+}
+
+// ---- Pack ----
+Pack::~Pack() {
+  destroy();
+}
+
+auto Pack::create(const std::string& path, LoadMode mode) -> void {
+  destroy();
+
+  if(mode == LoadMode::Read || !map(path)) {
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if(!file.is_open())
+      throw std::runtime_error("Error - unable to open asset pack " + path);
+
+    bytes.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if(!file)
+      throw std::runtime_error("Error - failed reading asset pack " + path);
+
+    base = bytes.data();
+    length = bytes.size();
+  }
+
+  // a pack that fails validation is closed again, none of it is ever handed out
+  try {
+    read_table(path);
+  } catch(...) {
+    destroy();
+    throw;
+  }
+}
+
+auto Pack::read_table(const std::string& path) -> void {
+  FileHeader header{};
+  if(length < sizeof(header))
+    throw std::runtime_error("Error - " + path + " is not an asset pack");
+  memcpy(&header, base, sizeof(header));
+  if(header.magic != FileHeader::MAGIC)
+    throw std::runtime_error("Error - " + path + " is not an asset pack");
+  if(header.version != FileHeader::VERSION)
+    throw std::runtime_error("Error - " + path + " was cooked by another version, cook it again");
+
+  auto table_size = static_cast<uint64_t>(header.entry_count) * sizeof(Entry);
+  if(header.toc_offset > length || table_size > length - header.toc_offset)
+    throw std::runtime_error("Error - asset pack " + path + " is truncated");
+
+  table.resize(header.entry_count);
+  if(!table.empty())
+    memcpy(table.data(), base + header.toc_offset, static_cast<std::size_t>(table_size));
+
+  // every size the loader later trusts is checked here, so a corrupt entry never reaches the gpu
+  for(auto& entry : table) {
+    entry.name[NAME_SIZE - 1] = '\0';
+    auto asset = "Error - asset " + std::string(entry.name) + " in " + path;
+    if(entry.offset > header.toc_offset || entry.size > header.toc_offset - entry.offset)
+      throw std::runtime_error(asset + " lies outside of the pack");
+
+    if(entry.type == AssetType::Texture) {
+      if(!is_texture_format(entry.format))
+        throw std::runtime_error(asset + " has unsupported format " + std::to_string(entry.format));
+      if(entry.width == 0 || entry.height == 0 || entry.mip_levels == 0 || entry.mip_levels > upload::mip_level_count(entry.width, entry.height))
+        throw std::runtime_error(asset + " has an invalid size or mip level count");
+      auto levels = texture_levels(entry);
+      if(entry.size != levels.back().offset + levels.back().size)
+        throw std::runtime_error(asset + " is the wrong size for its mip levels");
+    } else if(entry.type == AssetType::Mesh) {
+      auto expected = static_cast<uint64_t>(entry.vertex_count) * sizeof(Vertex) + static_cast<uint64_t>(entry.index_count) * sizeof(uint16_t);
+      if(entry.size != expected)
+        throw std::runtime_error(asset + " is the wrong size for its vertex and index counts");
+    } else {
+      throw std::runtime_error(asset + " has unknown type " + std::to_string(static_cast<uint32_t>(entry.type)));
+    }
+  }
+}
+
+auto Pack::destroy(void) -> void {
+  unmap();
+  base = nullptr;
+  length = 0;
+  bytes = {};
+  table = {};
+}
+
+auto Pack::is_open(void) const -> bool {
+  return base != nullptr;
+}
+
+auto Pack::entries(void) const -> const std::vector<Entry>& {
+  return table;
+}
+
+auto Pack::count(AssetType type) const -> std::size_t {
+  return static_cast<std::size_t>(std::count_if(table.begin(), table.end(), [type](const Entry& entry) { return entry.type == type; }));
+}
+
+auto Pack::find(const std::string& name) const -> const Entry* {
+  auto it = std::find_if(table.begin(), table.end(), [&name](const Entry& entry) { return name == entry.name; });
+  return it == table.end() ? nullptr : &*it;
+}
+
+auto Pack::data(const Entry& entry) const -> const unsigned char* {
+  return base + entry.offset;
+}
+
+auto Pack::size(void) const -> std::size_t {
+  return length;
+}
+
+auto Pack::bytes_copied(void) const -> std::size_t {
+  return bytes.size();
+}
+
+// false when the file cannot be mapped (or is empty, which cannot be), create then reads it instead
+auto Pack::map(const std::string& path) -> bool {
+#ifdef _WIN32
+  auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if(file == INVALID_HANDLE_VALUE) return false;
+
+  LARGE_INTEGER file_size{};
+  auto handle = GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+  CloseHandle(file); // the mapping object keeps the file open
+  if(handle == nullptr) return false;
+
+  auto* view = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+  if(view == nullptr) {
+    CloseHandle(handle);
+    return false;
+  }
+  mapping_handle = handle;
+  length = static_cast<std::size_t>(file_size.QuadPart);
+#else
+  auto descriptor = open(path.c_str(), O_RDONLY);
+  if(descriptor < 0) return false;
+
+  struct stat status{};
+  auto* view = fstat(descriptor, &status) == 0 && status.st_size > 0
+    ? mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0)
+    : MAP_FAILED;
+  close(descriptor); // the mapping keeps the file open
+  if(view == MAP_FAILED) return false;
+
+  length = static_cast<std::size_t>(status.st_size);
+  madvise(view, length, MADV_SEQUENTIAL); // assets are staged front to back, read ahead and drop behind
+#endif
+  mapping = view;
+  base = static_cast<const unsigned char*>(view);
+  return true;
+}
+
+auto Pack::unmap(void) -> void {
+  if(mapping == nullptr) return;
+#ifdef _WIN32
+  UnmapViewOfFile(mapping);
+  CloseHandle(mapping_handle);
+  mapping_handle = nullptr;
+#else
+  munmap(mapping, length);
+#endif
+  mapping = nullptr;
+}
+// ---- End of Pack ----
+
+} // end of namespace asset_pack
+
+static auto align_up(uint64_t value, uint64_t alignment) -> uint64_t {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// texture_levels counts 4 bytes a texel; these are all cook_texture could ever have written
+static auto is_texture_format(uint32_t format) -> bool {
+  switch(static_cast<VkFormat>(format)) {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static auto make_entry(const std::string& name, uint64_t source_hash, asset_pack::AssetType type) -> asset_pack::Entry {
+  if(name.empty() || name.size() >= asset_pack::NAME_SIZE)
+    throw std::runtime_error("Error - asset name \"" + name + "\" must be 1 to " + std::to_string(asset_pack::NAME_SIZE - 1) + " characters");
+
+  asset_pack::Entry entry{};
+  memcpy(entry.name, name.data(), name.size());
+  entry.source_hash = source_hash;
+  entry.type = type;
+  return entry;
+}
+
+// obj indices start at 1, negative ones count back from the last element read so far; anything
+// unusable comes back as count, which the caller rejects
+static auto resolve_obj_index(const std::string& token, std::size_t count) -> std::size_t {
+  long index = 0;
+  try {
+    index = std::stol(token);
+  } catch(const std::exception&) {
+    return count;
+  }
+  if(index > 0) return static_cast<std::size_t>(index - 1);
+  if(index < 0 && static_cast<std::size_t>(-index) <= count) return count - static_cast<std::size_t>(-index);
+  return count;
+}
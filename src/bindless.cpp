@@ -0,0 +1,53 @@
+#include <stdexcept>
+#include <string>
+
+#include "bindless.h"
+
+namespace bindless {
+
+// ---- SlotAllocator ----
+SlotAllocator::SlotAllocator(uint32_t capacity, uint32_t retire_frames): capacity(capacity), retire_frames(retire_frames) {}
+
+auto SlotAllocator::allocate(void) -> std::optional<uint32_t> {
+  uint32_t slot;
+  if(!free_slots.empty()) {
+    slot = free_slots.back();
+    free_slots.pop_back();
+  } else if(fresh < capacity) {
+    slot = fresh++;
+  } else {
+    return std::nullopt;
+  }
+
+  ++allocated;
+  return slot;
+}
+
+auto SlotAllocator::free(uint32_t slot) -> void {
+  if(slot >= fresh)
+    throw std::runtime_error("Error - freeing bindless slot " + std::to_string(slot) + " that was never allocated");
+
+  retiring.push_back({slot, frame});
+}
+
+auto SlotAllocator::next_frame(void) -> void {
+  ++frame;
+
+  std::size_t retired = 0;
+  for(; retired < retiring.size() && frame - retiring[retired].frame >= retire_frames; ++retired) {
+    free_slots.push_back(retiring[retired].slot);
+    --allocated;
+  }
+  retiring.erase(retiring.begin(), retiring.begin() + static_cast<std::ptrdiff_t>(retired));
+}
+
+auto SlotAllocator::in_use(void) const -> uint32_t {
+  return allocated;
+}
+
+auto SlotAllocator::high_water_mark(void) const -> uint32_t {
+  return fresh;
+}
+// ---- End of SlotAllocator ----
+
+} // end of namespace bindless
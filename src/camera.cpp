@@ -1,5 +1,6 @@
 
 #include <iostream>
+#include <cmath>
 
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -7,6 +8,17 @@
 
 namespace camera {
 
+auto reverse_z_perspective(float fovy, float aspect, float near_plane) -> glm::mat4 {
+  auto focal = 1.0f / std::tan(fovy / 2.0f);
+
+  glm::mat4 projection(0.0f);
+  projection[0][0] = focal / aspect;
+  projection[1][1] = focal;
+  projection[2][3] = -1.0f; // w = -z, the distance in front of the camera
+  projection[3][2] = near_plane; // z = near_plane, so depth = near_plane / distance
+  return projection;
+}
+
 Camera::Camera(glm::vec3 p): position(p) {}
 
 auto Camera::move(glm::vec3 offset) -> void {
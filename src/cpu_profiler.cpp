@@ -0,0 +1,199 @@
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <mutex>
+
+#include "cpu_profiler.h"
+
+namespace cpu_profiler {
+
+// a tick and a nanosecond reading taken together; two of them, far enough apart, give the rate
+struct Calibration {
+  uint64_t ticks;
+  uint64_t nanoseconds;
+};
+
+static auto calibrate(void) -> Calibration;
+static auto ticks_to_nanoseconds(uint64_t ticks, const Calibration& origin, double nanoseconds_per_tick) -> uint64_t;
+
+// every thread that ever recorded a scope; buffers outlive their threads so a trace still shows
+// work done by threads that have since exited
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+static const Calibration origin = calibrate(); // at startup, before any scope
+
+static auto registry(void) -> Registry& {
+  static Registry instance;
+  return instance;
+}
+
+static auto write_json_string(std::ostream& out, const char* text) -> void {
+  out << '"';
+  for(; *text != '\0'; ++text) {
+    if(*text == '"' || *text == '\\') out << '\\';
+    out << *text;
+  }
+  out << '"';
+}
+
+auto now_nanoseconds(void) -> uint64_t {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+auto ticks_to_nanoseconds(uint64_t ticks) -> uint64_t {
+#ifdef CPU_PROFILER_TSC
+  static const double nanoseconds_per_tick = [] {
+    auto current = calibrate();
+    while(current.nanoseconds - origin.nanoseconds < 1000000)
+      current = calibrate();
+    return static_cast<double>(current.nanoseconds - origin.nanoseconds) / static_cast<double>(current.ticks - origin.ticks);
+  }();
+  return static_cast<uint64_t>(static_cast<double>(ticks) * nanoseconds_per_tick);
+#else
+  return ticks;
+#endif
+}
+
+auto register_thread(void) -> ThreadBuffer& {
+  if(local_buffer == nullptr) {
+    auto& threads = registry();
+    std::lock_guard lock(threads.mutex);
+    threads.buffers.push_back(std::make_unique<ThreadBuffer>());
+    local_buffer = threads.buffers.back().get();
+    local_buffer->thread_index = static_cast<uint32_t>(threads.buffers.size() - 1);
+  }
+  return *local_buffer;
+}
+
+auto set_thread_name(const std::string& name) -> void {
+  auto& buffer = register_thread();
+  std::lock_guard lock(registry().mutex);
+  buffer.thread_name = name;
+}
+
+auto write_chrome_trace(std::ostream& out, uint64_t begin_nanoseconds, uint64_t end_nanoseconds) -> std::size_t {
+  struct Copied {
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+  };
+
+  // the longer the program has run, the more precise the rate; a millisecond already gives ppm
+  auto current = calibrate();
+  while(current.nanoseconds - origin.nanoseconds < 1000000)
+    current = calibrate();
+  auto nanoseconds_per_tick = static_cast<double>(current.nanoseconds - origin.nanoseconds) / static_cast<double>(current.ticks - origin.ticks);
+
+  auto& threads = registry();
+  std::lock_guard lock(threads.mutex); // no thread registers or renames while this runs
+
+  auto flags = out.flags();
+  out << std::fixed << std::setprecision(3);
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+  std::size_t count = 0;
+  auto separator = "";
+  std::vector<Copied> copied;
+  for(const auto& buffer : threads.buffers) {
+    auto name = buffer->thread_name.empty() ? "thread " + std::to_string(buffer->thread_index) : buffer->thread_name;
+    out << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->thread_index << ",\"args\":{\"name\":";
+    write_json_string(out, name.c_str());
+    out << "}}";
+    separator = ",\n";
+
+    auto written = buffer->written.load(std::memory_order_acquire);
+    auto first = written > ThreadBuffer::CAPACITY ? written - ThreadBuffer::CAPACITY : 0;
+
+    copied.clear();
+    for(auto i = first; i < written; ++i) {
+      const auto& event = buffer->events[i % ThreadBuffer::CAPACITY];
+      copied.push_back({
+        event.name.load(std::memory_order_relaxed),
+        event.begin.load(std::memory_order_relaxed),
+        event.end.load(std::memory_order_relaxed)
+      });
+    }
+    for(auto& event : copied) {
+      event.begin = ticks_to_nanoseconds(event.begin, origin, nanoseconds_per_tick);
+      event.end = ticks_to_nanoseconds(event.end, origin, nanoseconds_per_tick);
+    }
+
+    // anything claimed since may have landed on the oldest slots we just read
+    std::atomic_thread_fence(std::memory_order_acquire);
+    auto claimed = buffer->claimed.load(std::memory_order_relaxed);
+    auto valid_from = claimed > ThreadBuffer::CAPACITY ? claimed - ThreadBuffer::CAPACITY : 0;
+
+    for(auto i = first; i < written; ++i) {
+      const auto& event = copied[i - first];
+      if(i < valid_from) continue;
+      if(event.end < begin_nanoseconds || event.begin >= end_nanoseconds) continue;
+
+      // microseconds, chrome's unit
+      out << ",\n{\"name\":";
+      write_json_string(out, event.name);
+      out << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->thread_index
+          << ",\"ts\":" << static_cast<double>(event.begin) / 1000.0
+          << ",\"dur\":" << static_cast<double>(event.end - event.begin) / 1000.0 << "}";
+      ++count;
+    }
+  }
+
+  out << "\n]}\n";
+  out.flags(flags);
+  return count;
+}
+
+// ---- Capture ----
+auto Capture::start(std::size_t frames, const std::filesystem::path& path) -> void {
+  this->path = path;
+  frames_left = std::max<std::size_t>(frames, 1);
+  begin = now_nanoseconds();
+}
+
+auto Capture::frame(void) -> bool {
+  if(!active() || --frames_left != 0) return false;
+
+  frames_left = 1;
+  return finish();
+}
+
+auto Capture::finish(void) -> bool {
+  if(!active()) return false;
+  frames_left = 0;
+
+  auto end = now_nanoseconds();
+  auto file = std::ofstream(path);
+  if(!file.is_open())
+    throw std::runtime_error("Error - unable to open trace file " + path.string());
+
+  auto count = write_chrome_trace(file, begin, end);
+  std::cout << "[trace] " << count << " scope(s) over " << static_cast<double>(end - begin) / 1e6 << "ms written to " << path.string() << "\n";
+  return true;
+}
+
+auto Capture::active(void) const -> bool {
+  return frames_left != 0;
+}
+// ---- End of Capture ----
+
+static auto calibrate(void) -> Calibration {
+  // the tick read sits between two clock reads so it lands close to their midpoint
+  auto before = now_nanoseconds();
+  auto ticks = now_ticks();
+  auto after = now_nanoseconds();
+  return {ticks, before + (after - before) / 2};
+}
+
+static auto ticks_to_nanoseconds(uint64_t ticks, const Calibration& origin, double nanoseconds_per_tick) -> uint64_t {
+  auto offset = static_cast<double>(static_cast<int64_t>(ticks - origin.ticks)) * nanoseconds_per_tick;
+  return static_cast<uint64_t>(static_cast<int64_t>(origin.nanoseconds) + static_cast<int64_t>(offset));
+}
+
+} // end of namespace cpu_profiler
@@ -0,0 +1,298 @@
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+#include "descriptors.h"
+
+namespace descriptors {
+
+template<typename T>
+static auto hash_combine(std::size_t& seed, const T& value) -> void {
+  seed ^= std::hash<T>{}(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+}
+
+auto pool_sizes(const std::vector<PoolRatio>& ratios, uint32_t sets) -> std::vector<VkDescriptorPoolSize> {
+  std::vector<VkDescriptorPoolSize> sizes;
+  sizes.reserve(ratios.size());
+  for(const auto& ratio : ratios) {
+    VkDescriptorPoolSize size{};
+    size.type = ratio.type;
+    size.descriptorCount = ratio.per_set * sets;
+    sizes.push_back(size);
+  }
+  return sizes;
+}
+
+auto next_pool_sets(uint32_t sets) -> uint32_t {
+  return std::min(sets * 2, MAX_POOL_SETS);
+}
+
+// ---- DescriptorAllocator ----
+auto DescriptorAllocator::create(VkDevice device, std::vector<PoolRatio> ratios, uint32_t initial_sets, VkDescriptorPoolCreateFlags flags) -> void {
+  this->device = device;
+  this->ratios = std::move(ratios);
+  this->flags = flags;
+  next_sets = std::clamp(initial_sets, 1u, MAX_POOL_SETS);
+}
+
+auto DescriptorAllocator::destroy(void) -> void {
+  if(current != VK_NULL_HANDLE)
+    vkDestroyDescriptorPool(device, current, nullptr);
+  for(auto pool : full_pools)
+    vkDestroyDescriptorPool(device, pool, nullptr);
+  for(auto pool : free_pools)
+    vkDestroyDescriptorPool(device, pool, nullptr);
+
+  current = VK_NULL_HANDLE;
+  full_pools.clear();
+  free_pools.clear();
+  set_count = 0;
+}
+
+auto DescriptorAllocator::allocate(VkDescriptorSetLayout layout) -> VkDescriptorSet {
+  VkDescriptorSetAllocateInfo alloc_info{};
+  alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  alloc_info.descriptorSetCount = 1;
+  alloc_info.pSetLayouts = &layout;
+
+  // at most one retry; a pool that is out of room is done with until the next reset
+  VkDescriptorSet set = VK_NULL_HANDLE;
+  for(int attempt = 0; attempt < 2; ++attempt) {
+    if(current == VK_NULL_HANDLE)
+      current = take_pool();
+    alloc_info.descriptorPool = current;
+
+    auto result = vkAllocateDescriptorSets(device, &alloc_info, &set);
+    if(result == VK_SUCCESS) {
+      ++set_count;
+      return set;
+    }
+    if(result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+      break;
+
+    full_pools.push_back(current);
+    current = VK_NULL_HANDLE;
+  }
+  throw std::runtime_error("Error - failed to allocate descriptor set");
+}
+
+auto DescriptorAllocator::reset(void) -> void {
+  if(current != VK_NULL_HANDLE)
+    full_pools.push_back(current);
+  current = VK_NULL_HANDLE;
+
+  for(auto pool : full_pools) {
+    vkResetDescriptorPool(device, pool, 0);
+    free_pools.push_back(pool);
+  }
+  full_pools.clear();
+  set_count = 0;
+}
+
+auto DescriptorAllocator::pool_count(void) const -> std::size_t {
+  return (current != VK_NULL_HANDLE ? 1 : 0) + full_pools.size() + free_pools.size();
+}
+
+auto DescriptorAllocator::allocated_sets(void) const -> std::size_t {
+  return set_count;
+}
+
+auto DescriptorAllocator::take_pool(void) -> VkDescriptorPool {
+  if(!free_pools.empty()) {
+    auto pool = free_pools.back();
+    free_pools.pop_back();
+    return pool;
+  }
+
+  auto sizes = pool_sizes(ratios, next_sets);
+
+  VkDescriptorPoolCreateInfo pool_info{};
+  pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  pool_info.flags = flags;
+  pool_info.poolSizeCount = static_cast<uint32_t>(sizes.size());
+  pool_info.pPoolSizes = sizes.data();
+  pool_info.maxSets = next_sets;
+
+  VkDescriptorPool pool = VK_NULL_HANDLE;
+  if(vkCreateDescriptorPool(device, &pool_info, nullptr, &pool) != VK_SUCCESS)
+    throw std::runtime_error("Error - failed to create descriptor pool");
+
+  next_sets = next_pool_sets(next_sets);
+  return pool;
+}
+// ---- End of DescriptorAllocator ----
+
+// ---- LayoutKey ----
+auto LayoutKey::operator==(const LayoutKey& other) const -> bool {
+  auto same_binding = [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+    return a.binding == b.binding && a.descriptorType == b.descriptorType && a.descriptorCount == b.descriptorCount && a.stageFlags == b.stageFlags;
+  };
+  return flags == other.flags && binding_flags == other.binding_flags
+      && std::equal(bindings.begin(), bindings.end(), other.bindings.begin(), other.bindings.end(), same_binding);
+}
+
+auto make_layout_key(std::vector<VkDescriptorSetLayoutBinding> bindings, std::vector<VkDescriptorBindingFlags> binding_flags, VkDescriptorSetLayoutCreateFlags flags) -> LayoutKey {
+  if(!binding_flags.empty() && binding_flags.size() != bindings.size())
+    throw std::runtime_error("Error - descriptor binding flags must be given for every binding or none");
+
+  // sorted together, so the same bindings listed in another order give the same key
+  std::vector<std::size_t> order(bindings.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&bindings](std::size_t a, std::size_t b) { return bindings[a].binding < bindings[b].binding; });
+
+  LayoutKey key{};
+  key.flags = flags;
+  for(auto i : order) {
+    key.bindings.push_back(bindings[i]);
+    key.bindings.back().pImmutableSamplers = nullptr;
+    if(!binding_flags.empty())
+      key.binding_flags.push_back(binding_flags[i]);
+  }
+  return key;
+}
+
+auto LayoutKeyHash::operator()(const LayoutKey& key) const -> std::size_t {
+  std::size_t seed = 0;
+  hash_combine(seed, key.flags);
+  for(const auto& binding : key.bindings) {
+    hash_combine(seed, binding.binding);
+    hash_combine(seed, static_cast<uint32_t>(binding.descriptorType));
+    hash_combine(seed, binding.descriptorCount);
+    hash_combine(seed, binding.stageFlags);
+  }
+  for(auto flags : key.binding_flags)
+    hash_combine(seed, flags);
+  return seed;
+}
+// ---- End of LayoutKey ----
+
+// ---- LayoutCache ----
+auto LayoutCache::create(VkDevice device) -> void {
+  this->device = device;
+}
+
+auto LayoutCache::destroy(void) -> void {
+  for(auto& [key, layout] : layouts)
+    vkDestroyDescriptorSetLayout(device, layout, nullptr);
+  layouts.clear();
+}
+
+auto LayoutCache::get(const LayoutKey& key) -> VkDescriptorSetLayout {
+  if(auto found = layouts.find(key); found != layouts.end())
+    return found->second;
+
+  VkDescriptorSetLayoutBindingFlagsCreateInfo flags_info{};
+  flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+  flags_info.bindingCount = static_cast<uint32_t>(key.binding_flags.size());
+  flags_info.pBindingFlags = key.binding_flags.data();
+
+  VkDescriptorSetLayoutCreateInfo layout_info{};
+  layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  layout_info.pNext = key.binding_flags.empty() ? nullptr : &flags_info; // needs vulkan 1.2 when chained
+  layout_info.flags = key.flags;
+  layout_info.bindingCount = static_cast<uint32_t>(key.bindings.size());
+  layout_info.pBindings = key.bindings.data();
+
+  VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+  if(vkCreateDescriptorSetLayout(device, &layout_info, nullptr, &layout) != VK_SUCCESS)
+    throw std::runtime_error("Error - failed to create descriptor set layout");
+
+  layouts.emplace(key, layout);
+  return layout;
+}
+
+auto LayoutCache::size(void) const -> std::size_t {
+  return layouts.size();
+}
+// ---- End of LayoutCache ----
+
+// ---- SetKey ----
+auto SetWrite::operator==(const SetWrite& other) const -> bool {
+  return binding == other.binding && type == other.type
+      && buffer == other.buffer && offset == other.offset && range == other.range
+      && view == other.view && sampler == other.sampler && image_layout == other.image_layout;
+}
+
+auto SetKey::operator==(const SetKey& other) const -> bool {
+  return layout == other.layout && writes == other.writes;
+}
+
+auto SetKeyHash::operator()(const SetKey& key) const -> std::size_t {
+  std::size_t seed = 0;
+  hash_combine(seed, key.layout);
+  for(const auto& write : key.writes) {
+    hash_combine(seed, write.binding);
+    hash_combine(seed, static_cast<uint32_t>(write.type));
+    hash_combine(seed, write.buffer);
+    hash_combine(seed, write.offset);
+    hash_combine(seed, write.range);
+    hash_combine(seed, write.view);
+    hash_combine(seed, write.sampler);
+    hash_combine(seed, static_cast<uint32_t>(write.image_layout));
+  }
+  return seed;
+}
+// ---- End of SetKey ----
+
+// ---- SetCache ----
+auto SetCache::create(VkDevice device, DescriptorAllocator& allocator) -> void {
+  this->device = device;
+  this->allocator = &allocator;
+}
+
+auto SetCache::destroy(void) -> void {
+  sets.clear();
+  hit_count = 0;
+}
+
+auto SetCache::get(const SetKey& key) -> VkDescriptorSet {
+  if(auto found = sets.find(key); found != sets.end()) {
+    ++hit_count;
+    return found->second;
+  }
+
+  auto set = allocator->allocate(key.layout);
+
+  // infos are referenced by the writes, so both are filled in full before the update
+  std::vector<VkDescriptorBufferInfo> buffer_infos(key.writes.size());
+  std::vector<VkDescriptorImageInfo> image_infos(key.writes.size());
+  std::vector<VkWriteDescriptorSet> descriptor_writes(key.writes.size());
+  for(std::size_t i = 0; i < key.writes.size(); ++i) {
+    const auto& write = key.writes[i];
+    auto& descriptor_write = descriptor_writes[i];
+    descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptor_write.dstSet = set;
+    descriptor_write.dstBinding = write.binding;
+    descriptor_write.dstArrayElement = 0;
+    descriptor_write.descriptorType = write.type;
+    descriptor_write.descriptorCount = 1;
+
+    if(write.buffer != VK_NULL_HANDLE) {
+      buffer_infos[i].buffer = write.buffer;
+      buffer_infos[i].offset = write.offset;
+      buffer_infos[i].range = write.range;
+      descriptor_write.pBufferInfo = &buffer_infos[i];
+    } else {
+      image_infos[i].imageView = write.view;
+      image_infos[i].sampler = write.sampler;
+      image_infos[i].imageLayout = write.image_layout;
+      descriptor_write.pImageInfo = &image_infos[i];
+    }
+  }
+  vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptor_writes.size()), descriptor_writes.data(), 0, nullptr);
+
+  sets.emplace(key, set);
+  return set;
+}
+
+auto SetCache::size(void) const -> std::size_t {
+  return sets.size();
+}
+
+auto SetCache::hits(void) const -> std::size_t {
+  return hit_count;
+}
+// ---- End of SetCache ----
+
+} // end of namespace descriptors
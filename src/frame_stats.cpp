@@ -0,0 +1,237 @@
+#include <stdexcept>
+#include <algorithm>
+#include <iomanip>
+#include <bit>
+#include <cmath>
+
+#include "frame_stats.h"
+#include "cpu_profiler.h"
+
+namespace frame_stats {
+
+// ---- Histogram ----
+auto Histogram::bucket_for(uint64_t value) -> std::size_t {
+  value = std::min<uint64_t>(value, (1ull << MAX_VALUE_BITS) - 1);
+  if(value < SUB_BUCKETS) return static_cast<std::size_t>(value);
+
+  auto shift = static_cast<uint32_t>(std::bit_width(value)) - SUB_BUCKET_BITS;
+  auto top = value >> shift; // [SUB_BUCKETS / 2, SUB_BUCKETS)
+  return static_cast<std::size_t>(SUB_BUCKETS + (shift - 1) * (SUB_BUCKETS / 2) + (top - SUB_BUCKETS / 2));
+}
+
+auto Histogram::highest_in_bucket(std::size_t bucket) -> uint64_t {
+  if(bucket < SUB_BUCKETS) return bucket;
+
+  auto shift = (bucket - SUB_BUCKETS) / (SUB_BUCKETS / 2) + 1;
+  auto top = (bucket - SUB_BUCKETS) % (SUB_BUCKETS / 2) + SUB_BUCKETS / 2;
+  return ((top + 1) << shift) - 1;
+}
+
+auto Histogram::record(uint64_t value) -> void {
+  ++buckets[bucket_for(value)];
+  ++total;
+  smallest = std::min(smallest, value);
+  largest = std::max(largest, value);
+  sum += static_cast<double>(value);
+}
+
+auto Histogram::reset(void) -> void {
+  buckets.fill(0);
+  total = 0;
+  smallest = UINT64_MAX;
+  largest = 0;
+  sum = 0.0;
+}
+
+auto Histogram::count(void) const -> uint64_t {
+  return total;
+}
+
+auto Histogram::min(void) const -> uint64_t {
+  return total == 0 ? 0 : smallest;
+}
+
+auto Histogram::max(void) const -> uint64_t {
+  return largest;
+}
+
+auto Histogram::mean(void) const -> double {
+  return total == 0 ? 0.0 : sum / static_cast<double>(total);
+}
+
+auto Histogram::percentile(double percentile) const -> uint64_t {
+  if(total == 0) return 0;
+
+  auto rank = static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(total)));
+  rank = std::max<uint64_t>(rank, 1);
+
+  uint64_t seen = 0;
+  for(std::size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+    seen += buckets[bucket];
+    if(seen >= rank)
+      return std::clamp(highest_in_bucket(bucket), min(), max()); // the bucket edge can overshoot what was recorded
+  }
+  return largest;
+}
+// ---- End of Histogram ----
+
+auto metric_name(Metric metric) -> const char* {
+  switch(metric) {
+    case Metric::CpuFrame:  return "cpu_frame";
+    case Metric::Gpu:       return "gpu";
+    case Metric::FenceWait: return "fence_wait";
+    case Metric::Acquire:   return "acquire";
+    default:                return "unknown";
+  }
+}
+
+// ---- FrameStats ----
+auto FrameStats::create(const Config& config) -> void {
+  this->config = config;
+
+  if(!config.csv_path.empty()) {
+    csv.open(config.csv_path);
+    if(!csv.is_open())
+      throw std::runtime_error("Error - unable to open frame stats file " + config.csv_path.string());
+    csv << "first_frame,last_frame,metric,count,min_ms,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,hitches\n";
+  }
+}
+
+auto FrameStats::destroy(void) -> void {
+  // whatever is left of the last interval
+  if(config.report_interval != 0 && frame_count > interval_first_frame)
+    write_report(interval, interval_first_frame, interval_hitches);
+
+  if(csv.is_open())
+    csv.close();
+}
+
+auto FrameStats::record(Metric metric, uint64_t nanoseconds) -> void {
+  auto& value = current[static_cast<std::size_t>(metric)];
+  value = value.value_or(0) + nanoseconds;
+}
+
+auto FrameStats::record_phase(const char* name, uint64_t nanoseconds) -> void {
+  if(nanoseconds >= slowest_phase_nanoseconds) {
+    slowest_phase = name;
+    slowest_phase_nanoseconds = nanoseconds;
+  }
+}
+
+auto FrameStats::end_frame(uint64_t frame_nanoseconds) -> bool {
+  record(Metric::CpuFrame, frame_nanoseconds);
+
+  // metrics nobody recorded this frame (no gpu timestamps, no acquire when headless) are left out
+  for(std::size_t i = 0; i < current.size(); ++i) {
+    if(!current[i]) continue;
+    totals[i].record(*current[i]);
+    interval[i].record(*current[i]);
+    current[i].reset();
+  }
+
+  auto frame_milliseconds = static_cast<double>(frame_nanoseconds) / 1e6;
+  auto hitch = config.hitch_milliseconds > 0.0 && frame_milliseconds > config.hitch_milliseconds;
+  if(hitch) {
+    ++hitch_count;
+    ++interval_hitches;
+
+    auto flags = std::cout.flags();
+    std::cout << std::fixed << std::setprecision(2) << "[hitch] frame " << frame_count << ": " << frame_milliseconds
+              << "ms (over " << config.hitch_milliseconds << "ms)";
+    if(slowest_phase != nullptr)
+      std::cout << ", " << static_cast<double>(slowest_phase_nanoseconds) / 1e6 << "ms of it in " << slowest_phase;
+    std::cout << "\n";
+    std::cout.flags(flags);
+  }
+  slowest_phase = nullptr;
+  slowest_phase_nanoseconds = 0;
+
+  ++frame_count;
+  if(config.report_interval != 0 && frame_count - interval_first_frame >= config.report_interval) {
+    write_report(interval, interval_first_frame, interval_hitches);
+    for(auto& histogram : interval)
+      histogram.reset();
+    interval_first_frame = frame_count;
+    interval_hitches = 0;
+  }
+  return hitch;
+}
+
+auto FrameStats::histogram(Metric metric) const -> const Histogram& {
+  return totals[static_cast<std::size_t>(metric)];
+}
+
+auto FrameStats::frames(void) const -> uint64_t {
+  return frame_count;
+}
+
+auto FrameStats::hitches(void) const -> uint64_t {
+  return hitch_count;
+}
+
+auto FrameStats::report(std::ostream& out) const -> void {
+  auto flags = out.flags();
+  out << std::fixed << std::setprecision(3);
+  for(std::size_t i = 0; i < totals.size(); ++i) {
+    const auto& histogram = totals[i];
+    if(histogram.count() == 0) continue;
+
+    out << "[stats] " << metric_name(static_cast<Metric>(i)) << ": p50 " << histogram.percentile(50.0) / 1e6
+        << "ms, p95 " << histogram.percentile(95.0) / 1e6 << "ms, p99 " << histogram.percentile(99.0) / 1e6
+        << "ms, max " << histogram.max() / 1e6 << "ms over " << histogram.count() << " frame(s)\n";
+  }
+  out << "[stats] " << hitch_count << " hitch(es) over " << config.hitch_milliseconds << "ms in " << frame_count << " frame(s)\n";
+  out.flags(flags);
+}
+
+auto FrameStats::write_report(const Histograms& histograms, uint64_t first_frame, uint64_t hitches) -> void {
+  auto last_frame = frame_count - 1;
+
+  if(csv.is_open()) {
+    csv << std::fixed << std::setprecision(4);
+    for(std::size_t i = 0; i < histograms.size(); ++i) {
+      const auto& histogram = histograms[i];
+      if(histogram.count() == 0) continue;
+
+      csv << first_frame << "," << last_frame << "," << metric_name(static_cast<Metric>(i)) << "," << histogram.count()
+          << "," << histogram.min() / 1e6 << "," << histogram.mean() / 1e6 << "," << histogram.percentile(50.0) / 1e6
+          << "," << histogram.percentile(95.0) / 1e6 << "," << histogram.percentile(99.0) / 1e6 << "," << histogram.max() / 1e6
+          << "," << hitches << "\n";
+    }
+    csv.flush();
+    return;
+  }
+
+  // one line per interval; p50/p95/p99 of each metric
+  auto flags = std::cout.flags();
+  std::cout << std::fixed << std::setprecision(2) << "[stats] frames " << first_frame << "-" << last_frame;
+  for(std::size_t i = 0; i < histograms.size(); ++i) {
+    const auto& histogram = histograms[i];
+    if(histogram.count() == 0) continue;
+
+    std::cout << " | " << metric_name(static_cast<Metric>(i)) << " " << histogram.percentile(50.0) / 1e6 << "/"
+              << histogram.percentile(95.0) / 1e6 << "/" << histogram.percentile(99.0) / 1e6 << "ms";
+  }
+  std::cout << " | " << hitches << " hitch(es)\n";
+  std::cout.flags(flags);
+}
+// ---- End of FrameStats ----
+
+// ---- Phase ----
+Phase::Phase(FrameStats& stats, const char* name, std::optional<Metric> metric)
+  : stats(stats), name(name), metric(metric), begin(cpu_profiler::now_ticks()), profiled(cpu_profiler::enabled()) {}
+
+// one clock read at each end serves both the profiler and the statistics
+Phase::~Phase() {
+  auto end = cpu_profiler::now_ticks();
+  if(profiled)
+    cpu_profiler::record(name, begin, end);
+
+  auto elapsed = cpu_profiler::ticks_to_nanoseconds(end - begin);
+  stats.record_phase(name, elapsed);
+  if(metric)
+    stats.record(*metric, elapsed);
+}
+// ---- End of Phase ----
+
+} // end of namespace frame_stats
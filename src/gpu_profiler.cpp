@@ -0,0 +1,204 @@
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+#include "gpu_profiler.h"
+
+namespace gpu_profiler {
+
+// ---- RollingStats ----
+auto RollingStats::push(double sample) -> void {
+  if(filled == WINDOW)
+    sum -= samples[next];
+  else
+    ++filled;
+
+  samples[next] = sample;
+  sum += sample;
+  next = (next + 1) % WINDOW;
+}
+
+auto RollingStats::min(void) const -> double {
+  if(filled == 0) return 0.0;
+  return *std::min_element(samples.begin(), samples.begin() + filled);
+}
+
+auto RollingStats::avg(void) const -> double {
+  if(filled == 0) return 0.0;
+  return sum / static_cast<double>(filled);
+}
+
+auto RollingStats::max(void) const -> double {
+  if(filled == 0) return 0.0;
+  return *std::max_element(samples.begin(), samples.begin() + filled);
+}
+
+auto RollingStats::last(void) const -> double {
+  if(filled == 0) return 0.0;
+  return samples[(next + WINDOW - 1) % WINDOW];
+}
+
+auto RollingStats::count(void) const -> std::size_t {
+  return filled;
+}
+// ---- End of RollingStats ----
+
+auto elapsed_milliseconds(uint64_t begin, uint64_t end, uint32_t valid_bits, float period) -> double {
+  auto mask = valid_bits >= 64 ? ~0ull : (1ull << valid_bits) - 1;
+  auto ticks = ((end & mask) - (begin & mask)) & mask; // still right when the counter wrapped in between
+  return static_cast<double>(ticks) * static_cast<double>(period) / 1e6;
+}
+
+// ---- GpuProfiler ----
+auto GpuProfiler::create(VkPhysicalDevice physical_device, VkDevice device, uint32_t queue_family_index, uint32_t frames_in_flight, uint32_t max_scopes) -> void {
+  uint32_t family_count = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &family_count, nullptr);
+  std::vector<VkQueueFamilyProperties> families(family_count);
+  vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &family_count, families.data());
+
+  valid_bits = queue_family_index < family_count ? families[queue_family_index].timestampValidBits : 0;
+  if(valid_bits == 0) {
+    std::cout << "[gpu] queue family " << queue_family_index << " has no timestamp support, gpu profiling disabled\n";
+    return;
+  }
+
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physical_device, &properties);
+  period = properties.limits.timestampPeriod;
+
+  this->device = device;
+  this->max_scopes = max_scopes;
+
+  VkQueryPoolCreateInfo pool_info{};
+  pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+  pool_info.queryCount = max_scopes * 2; // begin and end
+
+  query_pools.resize(frames_in_flight, VK_NULL_HANDLE);
+  for(auto& pool : query_pools) {
+    if(vkCreateQueryPool(device, &pool_info, nullptr, &pool) != VK_SUCCESS)
+      throw std::runtime_error("Error - failed to create timestamp query pool");
+  }
+
+  pending.assign(frames_in_flight, {});
+  results.resize(static_cast<std::size_t>(max_scopes) * 4);
+}
+
+auto GpuProfiler::destroy(void) -> void {
+  for(auto pool : query_pools)
+    vkDestroyQueryPool(device, pool, nullptr);
+  query_pools.clear();
+  pending.clear();
+  device = VK_NULL_HANDLE;
+}
+
+auto GpuProfiler::enabled(void) const -> bool {
+  return device != VK_NULL_HANDLE;
+}
+
+auto GpuProfiler::begin_frame(VkCommandBuffer command_buffer, uint32_t frame_in_flight) -> void {
+  if(!enabled()) return;
+
+  collect(frame_in_flight);
+  vkCmdResetQueryPool(command_buffer, query_pools[frame_in_flight], 0, max_scopes * 2);
+  recording_frame = frame_in_flight;
+}
+
+auto GpuProfiler::begin_scope(VkCommandBuffer command_buffer, const char* name) -> uint32_t {
+  if(!enabled()) return INVALID_SCOPE;
+
+  auto& scopes = pending[recording_frame];
+  if(scopes.size() >= max_scopes) return INVALID_SCOPE; // dropped, not worth failing the frame over
+
+  auto scope = static_cast<uint32_t>(scopes.size());
+  scopes.push_back({name, scope * 2, false});
+  // top of pipe; the timestamp is written once every earlier command has started
+  vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, query_pools[recording_frame], scope * 2);
+  return scope;
+}
+
+auto GpuProfiler::end_scope(VkCommandBuffer command_buffer, uint32_t scope) -> void {
+  if(!enabled() || scope == INVALID_SCOPE) return;
+
+  auto& pending_scope = pending[recording_frame][scope];
+  // bottom of pipe; written once every earlier command has finished
+  vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, query_pools[recording_frame], pending_scope.first_query + 1);
+  pending_scope.ended = true;
+}
+
+auto GpuProfiler::scopes(void) const -> const std::vector<ScopeStats>& {
+  return stats;
+}
+
+auto GpuProfiler::latest(const char* name) const -> std::optional<double> {
+  for(const auto& scope : stats) {
+    if(std::strcmp(scope.name.c_str(), name) == 0 && collections != 0 && scope.collection == collections)
+      return scope.milliseconds.last();
+  }
+  return std::nullopt;
+}
+
+auto GpuProfiler::report(std::ostream& out) const -> void {
+  auto flags = out.flags();
+  out << std::fixed << std::setprecision(3);
+  for(const auto& scope : stats) {
+    out << "[gpu] " << scope.name << ": " << scope.milliseconds.min() << " / " << scope.milliseconds.avg() << " / "
+        << scope.milliseconds.max() << "ms min/avg/max over the last " << scope.milliseconds.count() << " frame(s)\n";
+  }
+  out.flags(flags);
+}
+
+// the frame's fence has been waited on, so its timestamps are written; availability is asked for
+// anyway, a frame that was recorded but never submitted (e.g. the swap chain went out of date) has none
+auto GpuProfiler::collect(uint32_t frame_in_flight) -> void {
+  auto& scopes = pending[frame_in_flight];
+  if(scopes.empty()) return;
+  ++collections;
+
+  auto query_count = static_cast<uint32_t>(scopes.size() * 2);
+  auto result = vkGetQueryPoolResults(
+    device, query_pools[frame_in_flight],
+    0, query_count,
+    query_count * 2 * sizeof(uint64_t), results.data(),
+    2 * sizeof(uint64_t), // timestamp, availability
+    VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+  );
+
+  if(result == VK_SUCCESS || result == VK_NOT_READY) {
+    for(const auto& scope : scopes) {
+      if(!scope.ended) continue;
+
+      auto* begin = &results[scope.first_query * 2];
+      auto* end = &results[(scope.first_query + 1) * 2];
+      if(begin[1] == 0 || end[1] == 0) continue; // not available
+
+      auto& scope_stats = stats_for(scope.name);
+      scope_stats.milliseconds.push(elapsed_milliseconds(begin[0], end[0], valid_bits, period));
+      scope_stats.collection = collections;
+    }
+  }
+  scopes.clear();
+}
+
+// a handful of scopes, a linear search beats hashing the name every frame
+auto GpuProfiler::stats_for(const char* name) -> ScopeStats& {
+  for(auto& scope : stats) {
+    if(std::strcmp(scope.name.c_str(), name) == 0)
+      return scope;
+  }
+  stats.push_back({name, {}, 0});
+  return stats.back();
+}
+// ---- End of GpuProfiler ----
+
+// ---- Scope ----
+Scope::Scope(GpuProfiler& profiler, VkCommandBuffer command_buffer, const char* name)
+  : profiler(profiler), command_buffer(command_buffer), scope(profiler.begin_scope(command_buffer, name)) {}
+
+Scope::~Scope() {
+  profiler.end_scope(command_buffer, scope);
+}
+// ---- End of Scope ----
+
+} // end of namespace gpu_profiler
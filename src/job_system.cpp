@@ -0,0 +1,211 @@
+#include <iostream>
+#include <algorithm>
+#include <exception>
+
+#include "job_system.h"
+
+namespace job_system {
+
+// which queue the calling thread owns; outside threads are not registered and use the shared one
+static thread_local const JobSystem* current_system = nullptr;
+static thread_local std::size_t current_queue = 0;
+
+auto Counter::done(void) const -> bool {
+  return pending.load(std::memory_order_acquire) == 0;
+}
+
+auto Counter::value(void) const -> std::size_t {
+  return pending.load(std::memory_order_acquire);
+}
+
+JobSystem::JobSystem(std::size_t thread_count) {
+  queues.reserve(thread_count + 1);
+  for(std::size_t i = 0; i < thread_count + 1; ++i)
+    queues.push_back(std::make_unique<Queue>());
+
+  workers.reserve(thread_count);
+  for(std::size_t i = 0; i < thread_count; ++i)
+    workers.emplace_back([this, i]{ worker_loop(i); });
+}
+
+// runs every queued job before joining
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard lock(sleep_mutex);
+    stopping = true;
+  }
+  work_available.notify_all();
+
+  for(auto& worker : workers)
+    worker.join();
+
+  // without workers nobody else would
+  Entry entry;
+  while(find(entry))
+    run(entry);
+}
+
+// leaves a core for the render thread, which helps out whenever it waits
+auto JobSystem::default_thread_count(void) -> std::size_t {
+  auto hardware_threads = static_cast<std::size_t>(std::thread::hardware_concurrency());
+  return std::max<std::size_t>(hardware_threads, 2) - 1;
+}
+
+auto JobSystem::spawn(Job job, Counter* counter) -> void {
+  if(counter != nullptr)
+    counter->pending.fetch_add(1, std::memory_order_relaxed);
+  push({std::move(job), counter});
+}
+
+auto JobSystem::then(Counter& dependency, Job job, Counter* counter) -> void {
+  // counted straight away, so waiting on counter also covers the job that has not spawned yet
+  if(counter != nullptr)
+    counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+  {
+    std::lock_guard lock(dependency.mutex);
+    if(dependency.pending.load(std::memory_order_acquire) != 0) {
+      dependency.continuations.push_back({std::move(job), counter});
+      return;
+    }
+  }
+  push({std::move(job), counter});
+}
+
+auto JobSystem::wait(Counter& counter) -> void {
+  while(!counter.done()) {
+    Entry entry;
+    if(find(entry))
+      run(entry);
+    else
+      std::this_thread::yield(); // the last jobs are running elsewhere
+  }
+
+  // the thread that took it to zero may still hold the lock; once it is released the counter
+  // is no longer touched and the caller is free to destroy it
+  std::lock_guard lock(counter.mutex);
+}
+
+auto JobSystem::parallel_for(std::size_t begin, std::size_t end, std::size_t grain, const RangeFunction& function) -> void {
+  if(end <= begin) return;
+  grain = std::max<std::size_t>(grain, 1);
+
+  Counter counter;
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto chunk = [&](std::size_t chunk_begin) {
+    try {
+      function(chunk_begin, std::min(chunk_begin + grain, end));
+    } catch(...) {
+      std::lock_guard lock(error_mutex);
+      if(!error) error = std::current_exception();
+    }
+  };
+
+  // the caller takes the first chunk itself instead of sitting idle
+  for(auto chunk_begin = begin + grain; chunk_begin < end && chunk_begin > begin; chunk_begin += grain)
+    spawn([&chunk, chunk_begin]{ chunk(chunk_begin); }, &counter);
+  chunk(begin);
+  wait(counter);
+
+  if(error) std::rethrow_exception(error);
+}
+
+auto JobSystem::size(void) const -> std::size_t {
+  return workers.size();
+}
+
+auto JobSystem::push(Entry entry) -> void {
+  auto index = (current_system == this) ? current_queue : queues.size() - 1;
+  {
+    auto& queue = *queues[index];
+    std::lock_guard lock(queue.mutex);
+    queue.entries.push_back(std::move(entry));
+  }
+  queued.fetch_add(1);
+
+  // only pay for the wake up when somebody is actually asleep; the worker bumps sleeping before
+  // it looks at queued, so one of the two always sees the other
+  if(sleeping.load() != 0) {
+    { std::lock_guard lock(sleep_mutex); }
+    work_available.notify_one();
+  }
+}
+
+auto JobSystem::find(Entry& entry) -> bool {
+  if(queued.load(std::memory_order_relaxed) == 0) return false;
+
+  auto own = (current_system == this) ? current_queue : queues.size() - 1;
+  {
+    auto& queue = *queues[own];
+    std::lock_guard lock(queue.mutex);
+    if(!queue.entries.empty()) {
+      entry = std::move(queue.entries.back());
+      queue.entries.pop_back();
+      queued.fetch_sub(1);
+      return true;
+    }
+  }
+
+  // oldest jobs first when stealing; they tend to be the biggest (e.g. unsplit ranges)
+  for(std::size_t i = 1; i < queues.size(); ++i) {
+    auto& queue = *queues[(own + i) % queues.size()];
+    std::unique_lock lock(queue.mutex, std::try_to_lock);
+    if(!lock.owns_lock() || queue.entries.empty()) continue;
+
+    entry = std::move(queue.entries.front());
+    queue.entries.pop_front();
+    queued.fetch_sub(1);
+    return true;
+  }
+  return false;
+}
+
+auto JobSystem::run(Entry& entry) -> void {
+  // a throwing job must not take the worker down with it; parallel_for reports its own errors
+  try {
+    entry.job();
+  } catch(const std::exception& e) {
+    std::cerr << "[job_system] job threw: " << e.what() << "\n";
+  }
+
+  if(entry.counter != nullptr)
+    finish(*entry.counter);
+}
+
+auto JobSystem::finish(Counter& counter) -> void {
+  std::vector<Counter::Continuation> ready;
+  {
+    std::lock_guard lock(counter.mutex);
+    if(counter.pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      ready.swap(counter.continuations);
+  }
+
+  for(auto& continuation : ready)
+    push({std::move(continuation.job), continuation.counter});
+}
+
+auto JobSystem::worker_loop(std::size_t index) -> void {
+  current_system = this;
+  current_queue = index;
+
+  while(true) {
+    Entry entry;
+    if(find(entry)) {
+      run(entry);
+      continue;
+    }
+
+    sleeping.fetch_add(1);
+    {
+      std::unique_lock lock(sleep_mutex);
+      work_available.wait(lock, [this]{ return stopping || queued.load() != 0; });
+    }
+    sleeping.fetch_sub(1);
+
+    if(stopping && queued.load() == 0) return; // stopping, and nothing left to run
+  }
+}
+
+} // end of namespace job_system
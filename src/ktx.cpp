@@ -0,0 +1,230 @@
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "ktx.h"
+
+namespace ktx {
+
+static constexpr unsigned char IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+static constexpr std::size_t HEADER_SIZE = 80; // identifier, header and index
+static constexpr std::size_t LEVEL_INDEX_ENTRY_SIZE = 24; // byte offset, byte length, uncompressed byte length
+
+// every field is little endian, as is every platform this builds for
+template<typename T>
+static auto read(const unsigned char* bytes, std::size_t offset) -> T {
+  T value;
+  memcpy(&value, bytes + offset, sizeof(T));
+  return value;
+}
+
+auto format_info(VkFormat format) -> std::optional<FormatInfo> {
+  switch(format) {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+      return FormatInfo{1, 1, 4};
+
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+    case VK_FORMAT_BC4_SNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+    case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+    case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+      return FormatInfo{4, 4, 8};
+
+    case VK_FORMAT_BC2_UNORM_BLOCK:
+    case VK_FORMAT_BC2_SRGB_BLOCK:
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+    case VK_FORMAT_BC5_SNORM_BLOCK:
+    case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+    case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+    case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+    case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+      return FormatInfo{4, 4, 16};
+
+    // astc blocks are always 16 bytes, only their footprint changes
+    case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:   case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:   return FormatInfo{4, 4, 16};
+    case VK_FORMAT_ASTC_5x4_UNORM_BLOCK:   case VK_FORMAT_ASTC_5x4_SRGB_BLOCK:   return FormatInfo{5, 4, 16};
+    case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:   case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:   return FormatInfo{5, 5, 16};
+    case VK_FORMAT_ASTC_6x5_UNORM_BLOCK:   case VK_FORMAT_ASTC_6x5_SRGB_BLOCK:   return FormatInfo{6, 5, 16};
+    case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:   case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:   return FormatInfo{6, 6, 16};
+    case VK_FORMAT_ASTC_8x5_UNORM_BLOCK:   case VK_FORMAT_ASTC_8x5_SRGB_BLOCK:   return FormatInfo{8, 5, 16};
+    case VK_FORMAT_ASTC_8x6_UNORM_BLOCK:   case VK_FORMAT_ASTC_8x6_SRGB_BLOCK:   return FormatInfo{8, 6, 16};
+    case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:   case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:   return FormatInfo{8, 8, 16};
+    case VK_FORMAT_ASTC_10x5_UNORM_BLOCK:  case VK_FORMAT_ASTC_10x5_SRGB_BLOCK:  return FormatInfo{10, 5, 16};
+    case VK_FORMAT_ASTC_10x6_UNORM_BLOCK:  case VK_FORMAT_ASTC_10x6_SRGB_BLOCK:  return FormatInfo{10, 6, 16};
+    case VK_FORMAT_ASTC_10x8_UNORM_BLOCK:  case VK_FORMAT_ASTC_10x8_SRGB_BLOCK:  return FormatInfo{10, 8, 16};
+    case VK_FORMAT_ASTC_10x10_UNORM_BLOCK: case VK_FORMAT_ASTC_10x10_SRGB_BLOCK: return FormatInfo{10, 10, 16};
+    case VK_FORMAT_ASTC_12x10_UNORM_BLOCK: case VK_FORMAT_ASTC_12x10_SRGB_BLOCK: return FormatInfo{12, 10, 16};
+    case VK_FORMAT_ASTC_12x12_UNORM_BLOCK: case VK_FORMAT_ASTC_12x12_SRGB_BLOCK: return FormatInfo{12, 12, 16};
+
+    default:
+      return std::nullopt;
+  }
+}
+
+// partial blocks at the edges are stored whole
+auto level_size(const FormatInfo& info, uint32_t width, uint32_t height) -> VkDeviceSize {
+  auto blocks_wide = (static_cast<VkDeviceSize>(width) + info.block_width - 1) / info.block_width;
+  auto blocks_high = (static_cast<VkDeviceSize>(height) + info.block_height - 1) / info.block_height;
+  return blocks_wide * blocks_high * info.block_bytes;
+}
+
+auto format_preference(VkFormat format) -> uint32_t {
+  switch(format) {
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+      return 0;
+
+    case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:   case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_5x4_UNORM_BLOCK:   case VK_FORMAT_ASTC_5x4_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:   case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_6x5_UNORM_BLOCK:   case VK_FORMAT_ASTC_6x5_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:   case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_8x5_UNORM_BLOCK:   case VK_FORMAT_ASTC_8x5_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_8x6_UNORM_BLOCK:   case VK_FORMAT_ASTC_8x6_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:   case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_10x5_UNORM_BLOCK:  case VK_FORMAT_ASTC_10x5_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_10x6_UNORM_BLOCK:  case VK_FORMAT_ASTC_10x6_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_10x8_UNORM_BLOCK:  case VK_FORMAT_ASTC_10x8_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_10x10_UNORM_BLOCK: case VK_FORMAT_ASTC_10x10_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_12x10_UNORM_BLOCK: case VK_FORMAT_ASTC_12x10_SRGB_BLOCK:
+    case VK_FORMAT_ASTC_12x12_UNORM_BLOCK: case VK_FORMAT_ASTC_12x12_SRGB_BLOCK:
+      return 1;
+
+    case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+    case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+    case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+    case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+    case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+      return 2;
+
+    default:
+      break;
+  }
+
+  auto info = format_info(format);
+  if(!info || (info->block_width == 1 && info->block_height == 1))
+    return 4; // uncompressed
+  return 3; // bc1-6
+}
+
+auto parse_header(const unsigned char* bytes, std::size_t size) -> Header {
+  if(size < HEADER_SIZE || memcmp(bytes, IDENTIFIER, sizeof(IDENTIFIER)) != 0)
+    throw std::runtime_error("Error - not a ktx2 file");
+
+  Header header{};
+  header.format = static_cast<VkFormat>(read<uint32_t>(bytes, 12));
+  header.width = read<uint32_t>(bytes, 20);
+  header.height = read<uint32_t>(bytes, 24);
+  auto depth = read<uint32_t>(bytes, 28);
+  auto layers = read<uint32_t>(bytes, 32);
+  auto faces = read<uint32_t>(bytes, 36);
+  header.level_count = read<uint32_t>(bytes, 40);
+  auto supercompression = read<uint32_t>(bytes, 44);
+
+  if(supercompression != 0)
+    throw std::runtime_error("Error - supercompressed ktx2 (scheme " + std::to_string(supercompression) + ") is not supported");
+  if(header.width == 0 || header.height == 0 || depth > 1 || layers > 1 || faces != 1)
+    throw std::runtime_error("Error - only single 2d ktx2 images are supported");
+
+  auto info = format_info(header.format);
+  if(!info)
+    throw std::runtime_error("Error - unsupported ktx2 format " + std::to_string(static_cast<uint32_t>(header.format)));
+  if(header.level_count > upload::mip_level_count(header.width, header.height))
+    throw std::runtime_error("Error - ktx2 has too many levels");
+  if(header.level_count == 0 && (info->block_width != 1 || info->block_height != 1))
+    throw std::runtime_error("Error - ktx2 asks for generated levels, which a block compressed format cannot have");
+
+  return header;
+}
+
+auto load_header(const std::filesystem::path& path) -> Header {
+  std::ifstream file(path, std::ios::binary);
+  if(!file.is_open())
+    throw std::runtime_error("Error - unable to open " + path.string());
+
+  unsigned char bytes[HEADER_SIZE]{};
+  file.read(reinterpret_cast<char*>(bytes), static_cast<std::streamsize>(HEADER_SIZE));
+  return parse_header(bytes, static_cast<std::size_t>(file.gcount()));
+}
+
+auto parse(const unsigned char* bytes, std::size_t size) -> Texture {
+  auto header = parse_header(bytes, size);
+  auto info = *format_info(header.format);
+  auto level_count = std::max<uint32_t>(header.level_count, 1); // 0 stores level 0 alone
+  if(HEADER_SIZE + level_count * LEVEL_INDEX_ENTRY_SIZE > size)
+    throw std::runtime_error("Error - ktx2 level index is truncated");
+
+  Texture texture{};
+  texture.format = header.format;
+  texture.width = header.width;
+  texture.height = header.height;
+
+  VkDeviceSize total = 0;
+  for(uint32_t level = 0; level < level_count; ++level) {
+    auto level_width = std::max<uint32_t>(header.width >> level, 1);
+    auto level_height = std::max<uint32_t>(header.height >> level, 1);
+    auto level_bytes = level_size(info, level_width, level_height);
+    texture.levels.push_back({total, level_bytes, level_width, level_height});
+    total += level_bytes;
+  }
+  texture.data.resize(static_cast<std::size_t>(total));
+
+  for(uint32_t level = 0; level < level_count; ++level) {
+    auto entry = HEADER_SIZE + level * LEVEL_INDEX_ENTRY_SIZE;
+    auto offset = read<uint64_t>(bytes, entry);
+    auto length = read<uint64_t>(bytes, entry + 8);
+
+    const auto& destination = texture.levels[level];
+    if(length != destination.size || offset > size || length > size - offset)
+      throw std::runtime_error("Error - ktx2 level " + std::to_string(level) + " is truncated or the wrong size for its format");
+
+    memcpy(texture.data.data() + destination.offset, bytes + offset, static_cast<std::size_t>(length));
+  }
+
+  // the rest of the chain, box filtered on the cpu like a decoded image's; rgba and bgra filter alike
+  if(header.level_count == 0) {
+    auto srgb = header.format == VK_FORMAT_R8G8B8A8_SRGB || header.format == VK_FORMAT_B8G8R8A8_SRGB;
+    texture.data = upload::generate_mip_chain(texture.data.data(), header.width, header.height, srgb, texture.levels);
+  }
+
+  return texture;
+}
+
+auto load(const std::filesystem::path& path) -> Texture {
+  std::ifstream file(path, std::ios::ate | std::ios::binary);
+  if(!file.is_open())
+    throw std::runtime_error("Error - unable to open " + path.string());
+
+  auto file_size = static_cast<std::size_t>(file.tellg());
+  std::vector<unsigned char> buffer(file_size);
+
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(file_size));
+
+  return parse(buffer.data(), buffer.size());
+}
+
+} // end of namespace ktx
@@ -1,12 +1,68 @@
 #include <iostream>
+#include <cstring>
+#include <string>
 
 #include "vulkan.h"
 
 using namespace vulkan;
 
-auto main(void) -> int {
+static auto parse_export_format(const std::string& name) -> readback::ExportFormat;
+
+// vulkan_run [--headless [frames]] [--export png|ppm|raw|stream path] [--trace frames [path]] [--stats interval [csv]] [--hitch ms] [--depth-prepass] [--decode-threads n] [--pack path] [--bindless] [--uniform-arena] [--no-validation]
+auto main(int argc, char** argv) -> int {
+  ApplicationConfig config{};
+
   try {
-    VulkanApplication app;
+    for(int i = 1; i < argc; ++i) {
+      if(std::strcmp(argv[i], "--headless") == 0) {
+        // offscreen, for machines without a display; runs a fixed number of frames and exits
+        config.headless = true;
+        config.frame_limit = 1000;
+        if(i + 1 < argc && argv[i + 1][0] != '-')
+          config.frame_limit = std::stoul(argv[++i]);
+      } else if(std::strcmp(argv[i], "--export") == 0 && i + 2 < argc) {
+        // every rendered frame, e.g. --export stream frames.fifo after mkfifo frames.fifo, with
+        // ffmpeg -f rawvideo -pixel_format bgra ... -i frames.fifo reading the other end
+        config.export_format = parse_export_format(argv[++i]);
+        config.export_path = argv[++i];
+      } else if(std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+        // the first frames as a chrome trace, open it in chrome://tracing or ui.perfetto.dev
+        config.trace_frames = std::stoul(argv[++i]);
+        if(i + 1 < argc && argv[i + 1][0] != '-')
+          config.trace_path = argv[++i];
+      } else if(std::strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+        // p50/p95/p99 every n frames, as csv rows when a path is given
+        config.stats_interval = std::stoul(argv[++i]);
+        if(i + 1 < argc && argv[i + 1][0] != '-')
+          config.stats_csv_path = argv[++i];
+      } else if(std::strcmp(argv[i], "--hitch") == 0 && i + 1 < argc) {
+        config.hitch_milliseconds = std::stod(argv[++i]);
+      } else if(std::strcmp(argv[i], "--depth-prepass") == 0) {
+        config.depth_prepass = true;
+      } else if(std::strcmp(argv[i], "--decode-threads") == 0 && i + 1 < argc) {
+        config.decode_threads = std::stoul(argv[++i]);
+      } else if(std::strcmp(argv[i], "--pack") == 0 && i + 1 < argc) {
+        // textures and meshes cooked by asset_cooker
+        config.asset_pack_path = argv[++i];
+      } else if(std::strcmp(argv[i], "--bindless") == 0) {
+        config.bindless = true;
+      } else if(std::strcmp(argv[i], "--uniform-arena") == 0) {
+        // model matrices through the per-frame uniform arena instead of push constants, to compare
+        config.push_transforms = false;
+      } else if(std::strcmp(argv[i], "--no-validation") == 0) {
+        // for machines without the khronos layers installed, and for timing
+        config.validation = false;
+      } else {
+        throw std::invalid_argument(argv[i]);
+      }
+    }
+  } catch (const std::exception&) {
+    std::cerr << "usage: " << argv[0] << " [--headless [frames]] [--export png|ppm|raw|stream path] [--trace frames [path]] [--stats interval [csv]] [--hitch ms] [--depth-prepass] [--decode-threads n] [--pack path] [--bindless] [--uniform-arena] [--no-validation]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  try {
+    VulkanApplication app(config);
     app.run();
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
@@ -14,4 +70,12 @@ auto main(void) -> int {
   }
 
   return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
+
+static auto parse_export_format(const std::string& name) -> readback::ExportFormat {
+  if(name == "png") return readback::ExportFormat::Png;
+  if(name == "ppm") return readback::ExportFormat::Ppm;
+  if(name == "raw") return readback::ExportFormat::Raw;
+  if(name == "stream") return readback::ExportFormat::Stream;
+  throw std::invalid_argument(name);
+}
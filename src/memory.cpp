@@ -0,0 +1,550 @@
+#include <stdexcept>
+#include <algorithm>
+#include <iomanip>
+#include <bit>
+
+#include "memory.h"
+
+static auto align_up(VkDeviceSize value, VkDeviceSize alignment) -> VkDeviceSize;
+static auto floor_log2(VkDeviceSize value) -> uint32_t;
+static auto mapping_insert(VkDeviceSize size, uint32_t& fl, uint32_t& sl) -> void;
+static auto mapping_search(VkDeviceSize size, uint32_t& fl, uint32_t& sl) -> void;
+static auto to_mib(VkDeviceSize bytes) -> double;
+
+namespace memory {
+
+// ---- BlockStats ----
+auto BlockStats::wasted_bytes(void) const -> VkDeviceSize {
+  return allocated_bytes - requested_bytes;
+}
+
+auto BlockStats::fragmentation(void) const -> double {
+  if(free_bytes == 0) return 0.0;
+  return 1.0 - static_cast<double>(largest_free_range) / static_cast<double>(free_bytes);
+}
+// ---- End of BlockStats ----
+
+// ---- BlockAllocator ----
+BlockAllocator::BlockAllocator(VkDeviceSize capacity, VkDeviceSize granularity): capacity(capacity), granularity(std::max<VkDeviceSize>(granularity, 1)) {
+  for(auto& heads : free_heads)
+    heads.fill(NULL_NODE);
+
+  // the whole block starts out as one free range; node 0 always stays the leftmost range
+  auto root = new_node();
+  nodes[root].offset = 0;
+  nodes[root].size = capacity;
+  insert_free(root);
+}
+
+auto BlockAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment, ResourceKind kind) -> std::optional<BlockRange> {
+  size = std::max<VkDeviceSize>(size, 1);
+  alignment = std::max<VkDeviceSize>(alignment, 1);
+  auto requested = size;
+
+  // optimal images get whole granularity pages to themselves; with the start and the end of
+  // every image on a page boundary, a buffer can never share a page with one
+  if(kind == ResourceKind::Optimal && granularity > 1) {
+    alignment = std::max(alignment, granularity);
+    size = align_up(size, granularity);
+  }
+
+  // worst case the start of a free range has to be pushed forward by (alignment - 1) bytes
+  auto search_size = size + alignment - 1;
+  if(search_size > capacity) return std::nullopt;
+
+  uint32_t fl, sl;
+  mapping_search(search_size, fl, sl);
+  if(fl >= FL_COUNT) return std::nullopt;
+
+  // first look for a non-empty bucket in the same first level, then in any larger one
+  auto sl_map = sl_bitmaps[fl] & (~0u << sl);
+  if(sl_map == 0) {
+    auto fl_map = (fl + 1 < 64) ? fl_bitmap & (~0ull << (fl + 1)) : 0ull;
+    if(fl_map == 0) return std::nullopt;
+
+    fl = std::countr_zero(fl_map);
+    sl_map = sl_bitmaps[fl];
+  }
+  sl = std::countr_zero(sl_map);
+
+  auto node = free_heads[fl][sl];
+  remove_free(node);
+
+  // leading padding becomes its own free range
+  auto aligned_offset = align_up(nodes[node].offset, alignment);
+  if(auto padding = aligned_offset - nodes[node].offset; padding > 0) {
+    auto aligned_node = split(node, padding);
+    insert_free(node);
+    node = aligned_node;
+  }
+
+  // hand back whatever is left past the end of the allocation
+  if(nodes[node].size > size)
+    insert_free(split(node, size));
+
+  nodes[node].is_free = false;
+  nodes[node].requested = requested;
+  ++allocation_count;
+
+  return BlockRange{nodes[node].offset, nodes[node].size, node};
+}
+
+auto BlockAllocator::free(uint32_t node) -> void {
+  if(node >= nodes.size() || nodes[node].is_free)
+    throw std::invalid_argument("Error - freeing a block range that is not allocated");
+
+  nodes[node].requested = 0;
+  --allocation_count;
+
+  // coalesce with physical neighbours so free ranges never sit next to each other
+  if(auto prev = nodes[node].prev_physical; prev != NULL_NODE && nodes[prev].is_free) {
+    remove_free(prev);
+    merge(prev, node);
+    node = prev;
+  }
+
+  if(auto next = nodes[node].next_physical; next != NULL_NODE && nodes[next].is_free) {
+    remove_free(next);
+    merge(node, next);
+  }
+
+  insert_free(node);
+}
+
+auto BlockAllocator::stats(void) const -> BlockStats {
+  BlockStats stats{};
+  stats.capacity = capacity;
+  if(nodes.empty()) return stats;
+
+  for(auto node = 0u; node != NULL_NODE; node = nodes[node].next_physical) {
+    const auto& range = nodes[node];
+    if(range.is_free) {
+      stats.free_bytes += range.size;
+      stats.largest_free_range = std::max(stats.largest_free_range, range.size);
+      ++stats.free_range_count;
+    } else {
+      stats.allocated_bytes += range.size;
+      stats.requested_bytes += range.requested;
+      ++stats.allocation_count;
+    }
+  }
+
+  return stats;
+}
+
+auto BlockAllocator::empty(void) const -> bool {
+  return allocation_count == 0;
+}
+
+auto BlockAllocator::new_node(void) -> uint32_t {
+  if(!recycled_nodes.empty()) {
+    auto node = recycled_nodes.back();
+    recycled_nodes.pop_back();
+    nodes[node] = Node{};
+    return node;
+  }
+
+  nodes.emplace_back();
+  return static_cast<uint32_t>(nodes.size() - 1);
+}
+
+auto BlockAllocator::insert_free(uint32_t node) -> void {
+  uint32_t fl, sl;
+  mapping_insert(nodes[node].size, fl, sl);
+
+  auto& head = free_heads[fl][sl];
+  nodes[node].is_free = true;
+  nodes[node].prev_free = NULL_NODE;
+  nodes[node].next_free = head;
+  if(head != NULL_NODE)
+    nodes[head].prev_free = node;
+  head = node;
+
+  fl_bitmap |= 1ull << fl;
+  sl_bitmaps[fl] |= 1u << sl;
+}
+
+auto BlockAllocator::remove_free(uint32_t node) -> void {
+  uint32_t fl, sl;
+  mapping_insert(nodes[node].size, fl, sl);
+
+  auto prev = nodes[node].prev_free;
+  auto next = nodes[node].next_free;
+  if(prev != NULL_NODE) nodes[prev].next_free = next;
+  if(next != NULL_NODE) nodes[next].prev_free = prev;
+
+  auto& head = free_heads[fl][sl];
+  if(head == node) {
+    head = next;
+    if(head == NULL_NODE) {
+      sl_bitmaps[fl] &= ~(1u << sl);
+      if(sl_bitmaps[fl] == 0)
+        fl_bitmap &= ~(1ull << fl);
+    }
+  }
+
+  nodes[node].is_free = false;
+  nodes[node].prev_free = NULL_NODE;
+  nodes[node].next_free = NULL_NODE;
+}
+
+// shrinks node to size bytes, the remainder becomes a new (unlisted) node to its right
+auto BlockAllocator::split(uint32_t node, VkDeviceSize size) -> uint32_t {
+  auto remainder = new_node(); // may reallocate nodes, so no references are held across this call
+
+  nodes[remainder].offset = nodes[node].offset + size;
+  nodes[remainder].size = nodes[node].size - size;
+  nodes[remainder].prev_physical = node;
+  nodes[remainder].next_physical = nodes[node].next_physical;
+
+  if(auto next = nodes[node].next_physical; next != NULL_NODE)
+    nodes[next].prev_physical = remainder;
+
+  nodes[node].next_physical = remainder;
+  nodes[node].size = size;
+
+  return remainder;
+}
+
+// absorbs right into left, right must be the physical successor of left
+auto BlockAllocator::merge(uint32_t left, uint32_t right) -> void {
+  nodes[left].size += nodes[right].size;
+  nodes[left].next_physical = nodes[right].next_physical;
+
+  if(auto next = nodes[right].next_physical; next != NULL_NODE)
+    nodes[next].prev_physical = left;
+
+  recycled_nodes.push_back(right);
+}
+// ---- End of BlockAllocator ----
+
+// ---- LinearAllocator ----
+LinearAllocator::LinearAllocator(VkDeviceSize capacity): capacity(capacity) {}
+
+auto LinearAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment) -> std::optional<VkDeviceSize> {
+  auto offset = align_up(head, std::max<VkDeviceSize>(alignment, 1));
+  if(offset > capacity || size > capacity - offset) return std::nullopt;
+
+  head = offset + size;
+  peak = std::max(peak, head);
+  return offset;
+}
+
+auto LinearAllocator::reset(void) -> void {
+  head = 0;
+}
+
+auto LinearAllocator::used(void) const -> VkDeviceSize {
+  return head;
+}
+
+auto LinearAllocator::high_water_mark(void) const -> VkDeviceSize {
+  return peak;
+}
+// ---- End of LinearAllocator ----
+
+// ---- DeviceAllocator ----
+auto DeviceAllocator::create(VkPhysicalDevice physical_device, VkDevice device, VkDeviceSize preferred_block_size) -> void {
+  this->device = device;
+  this->preferred_block_size = preferred_block_size;
+
+  vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties);
+
+  VkPhysicalDeviceProperties properties{};
+  vkGetPhysicalDeviceProperties(physical_device, &properties);
+  buffer_image_granularity = properties.limits.bufferImageGranularity;
+  max_allocation_count = properties.limits.maxMemoryAllocationCount;
+  non_coherent_atom = properties.limits.nonCoherentAtomSize;
+}
+
+auto DeviceAllocator::destroy(void) -> void {
+  auto lock = std::lock_guard(mutex);
+
+  for(auto& pool : pools) {
+    for(auto& block : pool) {
+      if(block.memory == VK_NULL_HANDLE) continue;
+      if(block.mapped != nullptr)
+        vkUnmapMemory(device, block.memory);
+      vkFreeMemory(device, block.memory, nullptr);
+    }
+    pool.clear();
+  }
+
+  for(auto& [memory, allocation] : dedicated) {
+    if(allocation.mapped != nullptr)
+      vkUnmapMemory(device, memory);
+    vkFreeMemory(device, memory, nullptr);
+  }
+  dedicated.clear();
+}
+
+// "Graphics cards can offer different types of memory to allocate from. Each type of
+//  memory varies in terms of allowed operations and performance characteristics.
+//  Need to combine the requirements of the buffer and the application requirements
+//  to find the right type of memory to use"
+auto DeviceAllocator::find_memory_type(uint32_t type_filter, VkMemoryPropertyFlags properties, VkMemoryPropertyFlags preferred) const -> uint32_t {
+  // e.g. host cached memory for buffers the cpu reads back; the first host visible type is often uncached write-combined
+  if(preferred != 0)
+    for(uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i)
+      if((type_filter & (1 << i)) && (memory_properties.memoryTypes[i].propertyFlags & (properties | preferred)) == (properties | preferred))
+        return i;
+
+  // structure has two arrays; memoryTypes and memoryHeaps (distinct memory resources, like dedicated VRAM or RAM swap sapce)
+  for(uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i)
+    // if a type matches the bitmask filter, then just go with that memory type
+    // assert that the memory type chosen is able to support writes from the CPU (need VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    if((type_filter & (1 << i)) && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+      return i;
+
+  throw std::runtime_error("Error - failed to find suitable memory type");
+}
+
+auto DeviceAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind, VkMemoryPropertyFlags preferred) -> Allocation {
+  auto lock = std::lock_guard(mutex);
+
+  auto memory_type = find_memory_type(requirements.memoryTypeBits, properties, preferred);
+  auto block_size = block_size_for(memory_type);
+
+  // huge resources would mostly waste a shared block, give them their own memory object
+  if(requirements.size > block_size / 2) {
+    Allocation allocation{};
+    allocation.memory = allocate_device_memory(memory_type, requirements.size, &allocation.mapped);
+    allocation.size = requirements.size;
+    allocation.memory_type = memory_type;
+    allocation.block = Allocation::DEDICATED;
+    dedicated[allocation.memory] = allocation;
+    return allocation;
+  }
+
+  auto& pool = pools[memory_type];
+  auto make_allocation = [&](uint32_t block_index, const BlockRange& range) {
+    const auto& block = pool[block_index];
+
+    Allocation allocation{};
+    allocation.memory = block.memory;
+    allocation.offset = range.offset;
+    allocation.size = range.size;
+    allocation.mapped = block.mapped ? static_cast<char*>(block.mapped) + range.offset : nullptr;
+    allocation.memory_type = memory_type;
+    allocation.block = block_index;
+    allocation.node = range.node;
+    return allocation;
+  };
+
+  for(uint32_t i = 0; i < pool.size(); ++i) {
+    if(pool[i].memory == VK_NULL_HANDLE) continue;
+    if(auto range = pool[i].placement.allocate(requirements.size, requirements.alignment, kind))
+      return make_allocation(i, *range);
+  }
+
+  // every block is full, grab a new one (reusing a released slot keeps block indices stable)
+  auto slot = std::find_if(pool.begin(), pool.end(), [](const auto& block){ return block.memory == VK_NULL_HANDLE; });
+  if(slot == pool.end())
+    slot = pool.emplace(pool.end());
+
+  slot->memory = allocate_device_memory(memory_type, block_size, &slot->mapped);
+  slot->placement = BlockAllocator(block_size, buffer_image_granularity);
+
+  auto range = slot->placement.allocate(requirements.size, requirements.alignment, kind);
+  if(!range)
+    throw std::runtime_error("Error - allocation does not fit in a fresh memory block");
+
+  return make_allocation(static_cast<uint32_t>(slot - pool.begin()), *range);
+}
+
+auto DeviceAllocator::free(Allocation& allocation) -> void {
+  auto lock = std::lock_guard(mutex);
+  if(allocation.memory == VK_NULL_HANDLE) return;
+
+  if(allocation.block == Allocation::DEDICATED) {
+    if(allocation.mapped != nullptr)
+      vkUnmapMemory(device, allocation.memory);
+    vkFreeMemory(device, allocation.memory, nullptr);
+    dedicated.erase(allocation.memory);
+    allocation = Allocation{};
+    return;
+  }
+
+  auto& pool = pools[allocation.memory_type];
+  auto& block = pool[allocation.block];
+  block.placement.free(allocation.node);
+
+  // give empty blocks back to the driver, but keep one around per memory type so
+  // that a create/destroy pattern does not thrash vkAllocateMemory
+  auto live_blocks = std::count_if(pool.begin(), pool.end(), [](const auto& b){ return b.memory != VK_NULL_HANDLE; });
+  if(block.placement.empty() && live_blocks > 1) {
+    if(block.mapped != nullptr)
+      vkUnmapMemory(device, block.memory);
+    vkFreeMemory(device, block.memory, nullptr);
+    block = Block{};
+  }
+
+  allocation = Allocation{};
+}
+
+auto DeviceAllocator::memory_type_flags(uint32_t memory_type) const -> VkMemoryPropertyFlags {
+  return memory_properties.memoryTypes[memory_type].propertyFlags;
+}
+
+auto DeviceAllocator::non_coherent_atom_size(void) const -> VkDeviceSize {
+  return non_coherent_atom;
+}
+
+auto DeviceAllocator::dump_stats(std::ostream& out) const -> void {
+  auto lock = std::lock_guard(mutex);
+
+  auto memory_count = 0ull;
+  for(const auto& pool : pools)
+    memory_count += std::count_if(pool.begin(), pool.end(), [](const auto& b){ return b.memory != VK_NULL_HANDLE; });
+  memory_count += dedicated.size();
+
+  out << std::fixed << std::setprecision(2);
+  out << "[memory] " << memory_count << " device memory allocations (limit " << max_allocation_count << ")" << std::endl;
+
+  for(uint32_t heap = 0; heap < memory_properties.memoryHeapCount; ++heap) {
+    auto blocks = 0ull;
+    auto reserved = VkDeviceSize{0};
+    auto dedicated_bytes = VkDeviceSize{0};
+    BlockStats total{};
+
+    for(uint32_t type = 0; type < memory_properties.memoryTypeCount; ++type) {
+      if(memory_properties.memoryTypes[type].heapIndex != heap) continue;
+
+      for(const auto& block : pools[type]) {
+        if(block.memory == VK_NULL_HANDLE) continue;
+        auto stats = block.placement.stats();
+        ++blocks;
+        reserved += stats.capacity;
+        total.requested_bytes += stats.requested_bytes;
+        total.allocated_bytes += stats.allocated_bytes;
+        total.free_bytes += stats.free_bytes;
+        total.largest_free_range = std::max(total.largest_free_range, stats.largest_free_range);
+        total.allocation_count += stats.allocation_count;
+        total.free_range_count += stats.free_range_count;
+      }
+    }
+
+    for(const auto& [memory, allocation] : dedicated)
+      if(memory_properties.memoryTypes[allocation.memory_type].heapIndex == heap)
+        dedicated_bytes += allocation.size;
+
+    if(blocks == 0 && dedicated_bytes == 0) continue;
+
+    const auto& heap_info = memory_properties.memoryHeaps[heap];
+    out << "[memory] heap " << heap
+        << ((heap_info.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? " (device local, " : " (host, ")
+        << to_mib(heap_info.size) << " MiB): "
+        << blocks << " blocks, "
+        << to_mib(reserved) << " MiB reserved, "
+        << to_mib(total.requested_bytes) << " MiB used by " << total.allocation_count << " allocations, "
+        << to_mib(total.wasted_bytes()) << " MiB wasted, "
+        << to_mib(total.free_bytes) << " MiB free in " << total.free_range_count << " ranges, "
+        << to_mib(dedicated_bytes) << " MiB dedicated, "
+        << "fragmentation " << total.fragmentation() * 100.0 << "%" << std::endl;
+  }
+}
+
+auto DeviceAllocator::device_memory_count(void) const -> std::size_t {
+  auto lock = std::lock_guard(mutex);
+
+  auto count = dedicated.size();
+  for(const auto& pool : pools)
+    count += std::count_if(pool.begin(), pool.end(), [](const auto& b){ return b.memory != VK_NULL_HANDLE; });
+  return count;
+}
+
+auto DeviceAllocator::total_stats(void) const -> BlockStats {
+  auto lock = std::lock_guard(mutex);
+
+  BlockStats total{};
+  for(const auto& pool : pools) {
+    for(const auto& block : pool) {
+      if(block.memory == VK_NULL_HANDLE) continue;
+      auto stats = block.placement.stats();
+      total.capacity += stats.capacity;
+      total.requested_bytes += stats.requested_bytes;
+      total.allocated_bytes += stats.allocated_bytes;
+      total.free_bytes += stats.free_bytes;
+      total.largest_free_range = std::max(total.largest_free_range, stats.largest_free_range);
+      total.allocation_count += stats.allocation_count;
+      total.free_range_count += stats.free_range_count;
+    }
+  }
+
+  // a dedicated allocation is its own memory, all of it in use
+  for(const auto& [memory, allocation] : dedicated) {
+    total.capacity += allocation.size;
+    total.requested_bytes += allocation.size;
+    total.allocated_bytes += allocation.size;
+    ++total.allocation_count;
+  }
+  return total;
+}
+
+auto DeviceAllocator::allocate_device_memory(uint32_t memory_type, VkDeviceSize size, void** mapped) -> VkDeviceMemory {
+  VkMemoryAllocateInfo alloc_info{};
+  alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  alloc_info.allocationSize = size;
+  alloc_info.memoryTypeIndex = memory_type;
+
+  VkDeviceMemory memory;
+  if(vkAllocateMemory(device, &alloc_info, nullptr, &memory) != VK_SUCCESS)
+    throw std::runtime_error("Error - failed to allocate device memory");
+
+  // host visible blocks are mapped once for their whole lifetime; a memory object can only
+  // be mapped once, so sub-allocations share the mapping through an offset
+  *mapped = nullptr;
+  if(memory_properties.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+    if(vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, mapped) != VK_SUCCESS)
+      throw std::runtime_error("Error - failed to map device memory");
+  }
+
+  return memory;
+}
+
+auto DeviceAllocator::block_size_for(uint32_t memory_type) const -> VkDeviceSize {
+  // small heaps (integrated/BAR memory) would be exhausted by a few big blocks
+  auto heap_size = memory_properties.memoryHeaps[memory_properties.memoryTypes[memory_type].heapIndex].size;
+  if(heap_size <= 1024ull * 1024 * 1024)
+    return std::min(preferred_block_size, align_up(heap_size / 8, 32));
+  return preferred_block_size;
+}
+// ---- End of DeviceAllocator ----
+
+} // end of namespace memory
+
+static auto align_up(VkDeviceSize value, VkDeviceSize alignment) -> VkDeviceSize {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+static auto floor_log2(VkDeviceSize value) -> uint32_t {
+  return static_cast<uint32_t>(std::bit_width(value)) - 1;
+}
+
+// sizes below SL_COUNT each get their own bucket in the first level, larger sizes are split
+// into SL_COUNT linear steps between consecutive powers of two
+static auto mapping_insert(VkDeviceSize size, uint32_t& fl, uint32_t& sl) -> void {
+  using memory::BlockAllocator;
+
+  if(size < BlockAllocator::SL_COUNT) {
+    fl = 0;
+    sl = static_cast<uint32_t>(size);
+    return;
+  }
+
+  auto log2 = floor_log2(size);
+  fl = log2 - BlockAllocator::SL_BITS + 1;
+  sl = static_cast<uint32_t>((size >> (log2 - BlockAllocator::SL_BITS)) - BlockAllocator::SL_COUNT);
+}
+
+// rounds the size up to the next bucket boundary, so any range in the resulting bucket fits
+static auto mapping_search(VkDeviceSize size, uint32_t& fl, uint32_t& sl) -> void {
+  if(size >= memory::BlockAllocator::SL_COUNT)
+    size += (VkDeviceSize{1} << (floor_log2(size) - memory::BlockAllocator::SL_BITS)) - 1;
+
+  mapping_insert(size, fl, sl);
+}
+
+static auto to_mib(VkDeviceSize bytes) -> double {
+  return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
@@ -0,0 +1,157 @@
+#include <stdexcept>
+#include <filesystem>
+#include <iostream>
+#include <fstream>
+#include <cstring>
+
+#include "pipeline_cache.h"
+
+static auto fnv1a(const char* data, std::size_t size) -> uint64_t;
+static auto read_whole_file(const std::string& path) -> std::vector<char>;
+
+namespace pipeline_cache {
+
+auto is_compatible(const std::vector<char>& blob, const VkPhysicalDeviceProperties& properties) -> bool {
+  VkPipelineCacheHeaderVersionOne header{};
+  if(blob.size() < sizeof(header)) return false;
+  memcpy(&header, blob.data(), sizeof(header));
+
+  return header.headerSize >= sizeof(header)
+      && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+      && header.vendorID == properties.vendorID
+      && header.deviceID == properties.deviceID
+      && memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+auto wrap(const std::vector<char>& blob, const VkPhysicalDeviceProperties& properties) -> std::vector<char> {
+  FileHeader header{};
+  header.driver_version = properties.driverVersion;
+  header.data_size = blob.size();
+  header.data_hash = fnv1a(blob.data(), blob.size());
+
+  std::vector<char> file(sizeof(header) + blob.size());
+  memcpy(file.data(), &header, sizeof(header));
+  if(!blob.empty())
+    memcpy(file.data() + sizeof(header), blob.data(), blob.size());
+
+  return file;
+}
+
+auto unwrap(const std::vector<char>& file, const VkPhysicalDeviceProperties& properties) -> std::optional<std::vector<char>> {
+  FileHeader header{};
+  if(file.size() < sizeof(header)) return std::nullopt;
+  memcpy(&header, file.data(), sizeof(header));
+
+  if(header.magic != FileHeader::MAGIC || header.version != FileHeader::VERSION) return std::nullopt;
+  // drivers are allowed to change the blob format without touching the uuid, so a new driver invalidates it
+  if(header.driver_version != properties.driverVersion) return std::nullopt;
+  if(header.data_size != file.size() - sizeof(header)) return std::nullopt;
+
+  auto blob = std::vector<char>(file.begin() + sizeof(header), file.end());
+  if(fnv1a(blob.data(), blob.size()) != header.data_hash) return std::nullopt;
+  if(!is_compatible(blob, properties)) return std::nullopt;
+
+  return blob;
+}
+
+// ---- PipelineCache ----
+auto PipelineCache::create(VkPhysicalDevice physical_device, VkDevice device, const std::string& path) -> void {
+  this->device = device;
+  this->path = path;
+  vkGetPhysicalDeviceProperties(physical_device, &properties);
+
+  std::optional<std::vector<char>> blob;
+  if(auto file = read_whole_file(path); !file.empty()) {
+    blob = unwrap(file, properties);
+    if(!blob)
+      std::cout << "[pipeline] discarding stale or corrupt cache " << path << "\n";
+  }
+
+  VkPipelineCacheCreateInfo cache_info{};
+  cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  if(blob) {
+    cache_info.initialDataSize = blob->size();
+    cache_info.pInitialData = blob->data();
+  }
+
+  // a driver may still reject data we consider valid; fall back to an empty cache rather than fail
+  auto result = vkCreatePipelineCache(device, &cache_info, nullptr, &cache);
+  if(result != VK_SUCCESS && blob) {
+    cache_info.initialDataSize = 0;
+    cache_info.pInitialData = nullptr;
+    blob.reset();
+    result = vkCreatePipelineCache(device, &cache_info, nullptr, &cache);
+  }
+  if(result != VK_SUCCESS)
+    throw std::runtime_error("Error - failed to create pipeline cache");
+
+  warm = blob.has_value();
+}
+
+auto PipelineCache::destroy(void) -> void {
+  if(cache == VK_NULL_HANDLE) return;
+
+  if(!save())
+    std::cout << "[pipeline] failed to write cache " << path << "\n";
+
+  vkDestroyPipelineCache(device, cache, nullptr);
+  cache = VK_NULL_HANDLE;
+}
+
+// writes to a temporary file and renames it over the old one, so a crash mid-write never leaves a torn cache
+auto PipelineCache::save(void) const -> bool {
+  std::size_t size = 0;
+  if(vkGetPipelineCacheData(device, cache, &size, nullptr) != VK_SUCCESS) return false;
+
+  std::vector<char> blob(size);
+  if(vkGetPipelineCacheData(device, cache, &size, blob.data()) != VK_SUCCESS) return false;
+  blob.resize(size);
+
+  auto file = wrap(blob, properties);
+  auto temporary_path = path + ".tmp";
+  {
+    std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+    if(!out) return false;
+    out.write(file.data(), static_cast<std::streamsize>(file.size()));
+    out.flush();
+    if(!out) return false;
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temporary_path, path, error);
+  return !error;
+}
+
+auto PipelineCache::handle(void) const -> VkPipelineCache {
+  return cache;
+}
+
+auto PipelineCache::is_warm(void) const -> bool {
+  return warm;
+}
+// ---- End of PipelineCache ----
+
+} // end of namespace pipeline_cache
+
+static auto fnv1a(const char* data, std::size_t size) -> uint64_t {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for(std::size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<uint8_t>(data[i]);
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+// empty when the file does not exist
+static auto read_whole_file(const std::string& path) -> std::vector<char> {
+  std::ifstream file(path, std::ios::ate | std::ios::binary);
+  if(!file.is_open()) return {};
+
+  auto file_size = static_cast<std::size_t>(file.tellg());
+  std::vector<char> buffer(file_size);
+
+  file.seekg(0);
+  file.read(buffer.data(), static_cast<std::streamsize>(file_size));
+
+  return buffer;
+}
@@ -0,0 +1,135 @@
+#include <stdexcept>
+#include <iostream>
+#include <chrono>
+
+#include "pipeline_manager.h"
+
+namespace pipeline_manager {
+
+auto PipelineManager::create(VkDevice device, VkPipelineCache cache, thread_pool::ThreadPool& pool, uint32_t frames_in_flight) -> void {
+  this->device = device;
+  this->cache = cache;
+  this->pool = &pool;
+  this->frames_in_flight = frames_in_flight;
+}
+
+auto PipelineManager::destroy(void) -> void {
+  // builds still running hold references to slots, let them land first
+  std::unique_lock lock(mutex);
+  built.wait(lock, [this]{ return pending.load() == 0; });
+
+  for(auto& slot : slots) {
+    if(auto pipeline = slot.pipeline.exchange(VK_NULL_HANDLE); pipeline != VK_NULL_HANDLE)
+      vkDestroyPipeline(device, pipeline, nullptr);
+  }
+  slots.clear();
+
+  for(auto& entry : retired)
+    vkDestroyPipeline(device, entry.pipeline, nullptr);
+  retired.clear();
+}
+
+auto PipelineManager::request(BuildFunction build) -> PipelineHandle {
+  auto handle = static_cast<PipelineHandle>(slots.size());
+  auto& slot = slots.emplace_back();
+  launch(slot, std::move(build));
+  return handle;
+}
+
+auto PipelineManager::replace(PipelineHandle handle, BuildFunction build) -> void {
+  launch(slots.at(handle), std::move(build));
+}
+
+auto PipelineManager::get(PipelineHandle handle) const -> VkPipeline {
+  if(handle >= slots.size()) return VK_NULL_HANDLE;
+  return slots[handle].pipeline.load(std::memory_order_acquire);
+}
+
+auto PipelineManager::resolve(PipelineHandle handle, VkPipeline fallback) const -> VkPipeline {
+  auto pipeline = get(handle);
+  return pipeline != VK_NULL_HANDLE ? pipeline : fallback;
+}
+
+auto PipelineManager::state(PipelineHandle handle) const -> PipelineState {
+  return slots.at(handle).state.load(std::memory_order_acquire);
+}
+
+auto PipelineManager::compile_milliseconds(PipelineHandle handle) const -> double {
+  return slots.at(handle).compile_ms.load(std::memory_order_relaxed);
+}
+
+auto PipelineManager::wait(PipelineHandle handle) -> void {
+  auto& slot = slots.at(handle);
+
+  std::unique_lock lock(mutex);
+  built.wait(lock, [&slot]{ return slot.building == 0; });
+}
+
+auto PipelineManager::collect(void) -> void {
+  std::lock_guard lock(mutex);
+  ++frame;
+
+  // a pipeline replaced during frame n can still be bound by every frame recorded up to n
+  std::erase_if(retired, [this](const Retired& entry) {
+    if(frame - entry.frame <= frames_in_flight) return false;
+    vkDestroyPipeline(device, entry.pipeline, nullptr);
+    return true;
+  });
+}
+
+auto PipelineManager::pending_count(void) const -> std::size_t {
+  return pending.load();
+}
+
+auto PipelineManager::launch(Slot& slot, BuildFunction build) -> void {
+  uint64_t generation;
+  {
+    std::lock_guard lock(mutex);
+    generation = ++slot.generation;
+    ++slot.building;
+    ++pending;
+  }
+
+  pool->submit([this, &slot, generation, build = std::move(build)]{
+    auto start = std::chrono::steady_clock::now();
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    auto failed = false;
+    try {
+      pipeline = build(cache); // the pipeline cache is internally synchronized, builds can share it
+    } catch(const std::exception& e) {
+      std::cerr << "[pipeline] build failed: " << e.what() << "\n";
+      failed = true;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    finish(slot, generation, pipeline, std::chrono::duration<double, std::milli>(end - start).count(), failed);
+  });
+}
+
+auto PipelineManager::finish(Slot& slot, uint64_t generation, VkPipeline pipeline, double compile_ms, bool failed) -> void {
+  {
+    std::lock_guard lock(mutex);
+
+    if(failed || pipeline == VK_NULL_HANDLE) {
+      // keep serving whatever was there; only a slot that never had a pipeline is marked failed
+      if(slot.pipeline.load() == VK_NULL_HANDLE)
+        slot.state.store(PipelineState::Failed, std::memory_order_release);
+    } else if(generation < slot.applied) {
+      // a newer build landed first, this one is already out of date
+      vkDestroyPipeline(device, pipeline, nullptr);
+    } else {
+      slot.applied = generation;
+      slot.compile_ms.store(compile_ms, std::memory_order_relaxed);
+      if(auto old = slot.pipeline.exchange(pipeline, std::memory_order_acq_rel); old != VK_NULL_HANDLE)
+        retired.push_back(Retired{old, frame});
+      slot.state.store(PipelineState::Ready, std::memory_order_release);
+    }
+
+    --slot.building;
+    --pending;
+  }
+  built.notify_all();
+}
+
+} // end of namespace pipeline_manager
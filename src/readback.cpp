@@ -0,0 +1,476 @@
+#include <stdexcept>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+#include <array>
+
+#ifdef __linux__
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "readback.h"
+
+static auto is_stdout(const std::filesystem::path& path) -> bool;
+static auto write_u32_be(std::vector<uint8_t>& out, uint32_t value) -> void;
+static auto write_chunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, std::size_t size) -> void;
+static auto frame_file_name(uint64_t number, const char* extension) -> std::string;
+
+namespace readback {
+
+// ---- Encoding ----
+auto crc32(const uint8_t* data, std::size_t size, uint32_t crc) -> uint32_t {
+  static const auto table = [] {
+    std::array<uint32_t, 256> table{};
+    for(uint32_t i = 0; i < 256; ++i) {
+      auto c = i;
+      for(int bit = 0; bit < 8; ++bit)
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      table[i] = c;
+    }
+    return table;
+  }();
+
+  crc = ~crc;
+  for(std::size_t i = 0; i < size; ++i)
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+auto encode_png(const Frame& frame) -> std::vector<uint8_t> {
+  // scanlines; filter type 0 (none), then rgb
+  auto row_size = static_cast<std::size_t>(frame.width) * 3 + 1;
+  std::vector<uint8_t> scanlines(row_size * frame.height);
+  auto red = frame.order == PixelOrder::Rgba ? 0 : 2;
+  auto blue = 2 - red;
+  for(uint32_t y = 0; y < frame.height; ++y) {
+    auto* row = scanlines.data() + y * row_size;
+    auto* source = frame.pixels + static_cast<std::size_t>(y) * frame.width * 4;
+    row[0] = 0;
+    for(uint32_t x = 0; x < frame.width; ++x) {
+      row[1 + x * 3 + 0] = source[x * 4 + red];
+      row[1 + x * 3 + 1] = source[x * 4 + 1];
+      row[1 + x * 3 + 2] = source[x * 4 + blue];
+    }
+  }
+
+  // zlib stream of stored deflate blocks, at most 65535 bytes each
+  std::vector<uint8_t> zlib{0x78, 0x01};
+  zlib.reserve(scanlines.size() + scanlines.size() / 65535 * 5 + 16);
+  for(std::size_t offset = 0; offset < scanlines.size() || offset == 0; ) {
+    auto size = std::min<std::size_t>(scanlines.size() - offset, 65535);
+    auto last = offset + size == scanlines.size();
+    zlib.push_back(last ? 1 : 0);
+    zlib.push_back(static_cast<uint8_t>(size & 0xFF));
+    zlib.push_back(static_cast<uint8_t>(size >> 8));
+    zlib.push_back(static_cast<uint8_t>(~size & 0xFF));
+    zlib.push_back(static_cast<uint8_t>((~size >> 8) & 0xFF));
+    zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + size);
+    offset += size;
+    if(last) break;
+  }
+
+  uint32_t a = 1, b = 0; // adler32 of the uncompressed data
+  for(auto byte : scanlines) {
+    a = (a + byte) % 65521;
+    b = (b + a) % 65521;
+  }
+  write_u32_be(zlib, (b << 16) | a);
+
+  std::array<uint8_t, 13> header{};
+  header[0] = frame.width >> 24; header[1] = frame.width >> 16; header[2] = frame.width >> 8; header[3] = frame.width;
+  header[4] = frame.height >> 24; header[5] = frame.height >> 16; header[6] = frame.height >> 8; header[7] = frame.height;
+  header[8] = 8; // bit depth
+  header[9] = 2; // truecolour
+  // compression, filter and interlace methods are all 0
+
+  std::vector<uint8_t> png{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  png.reserve(zlib.size() + 64);
+  write_chunk(png, "IHDR", header.data(), header.size());
+  write_chunk(png, "IDAT", zlib.data(), zlib.size());
+  write_chunk(png, "IEND", nullptr, 0);
+  return png;
+}
+
+auto encode_ppm(const Frame& frame) -> std::vector<uint8_t> {
+  auto header = "P6\n" + std::to_string(frame.width) + " " + std::to_string(frame.height) + "\n255\n";
+
+  std::vector<uint8_t> ppm(header.begin(), header.end());
+  ppm.resize(header.size() + static_cast<std::size_t>(frame.width) * frame.height * 3);
+
+  auto red = frame.order == PixelOrder::Rgba ? 0 : 2;
+  auto blue = 2 - red;
+  auto* out = ppm.data() + header.size();
+  for(std::size_t i = 0; i < static_cast<std::size_t>(frame.width) * frame.height; ++i) {
+    out[i * 3 + 0] = frame.pixels[i * 4 + red];
+    out[i * 3 + 1] = frame.pixels[i * 4 + 1];
+    out[i * 3 + 2] = frame.pixels[i * 4 + blue];
+  }
+  return ppm;
+}
+
+auto pixel_order_for(VkFormat format) -> std::optional<PixelOrder> {
+  switch(format) {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+      return PixelOrder::Rgba;
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+      return PixelOrder::Bgra;
+    default:
+      return std::nullopt;
+  }
+}
+// ---- End of Encoding ----
+
+// ---- FrameExporter ----
+FrameExporter::~FrameExporter() {
+  destroy();
+}
+
+auto FrameExporter::create(ExportFormat format, const std::filesystem::path& path) -> void {
+  this->format = format;
+  this->path = path;
+
+  if(format == ExportFormat::Stream) {
+    // the log goes to stdout, it would be interleaved with the frames
+    if(is_stdout(path))
+      throw std::runtime_error("Error - readback cannot stream to stdout, it carries the log; use a file or named pipe");
+
+    stream.open(path, std::ios::binary);
+    if(!stream.is_open())
+      throw std::runtime_error("Error - unable to open readback stream " + path.string());
+  } else {
+    std::filesystem::create_directories(path);
+  }
+
+  stopping = false;
+  exporter = std::thread([this]{ export_loop(); });
+}
+
+auto FrameExporter::destroy(void) -> void {
+  if(!exporter.joinable()) return;
+
+  {
+    std::lock_guard lock(mutex);
+    stopping = true;
+  }
+  frame_available.notify_all();
+  exporter.join();
+
+  if(stream.is_open())
+    stream.close();
+}
+
+auto FrameExporter::submit(const Frame& frame, Release release) -> void {
+  {
+    std::lock_guard lock(mutex);
+    queue.emplace_back(frame, std::move(release));
+  }
+  frame_available.notify_one();
+}
+
+auto FrameExporter::wait_idle(void) -> void {
+  std::unique_lock lock(mutex);
+  idle.wait(lock, [this]{ return queue.empty() && !busy; });
+}
+
+auto FrameExporter::frames_written(void) const -> std::size_t {
+  std::lock_guard lock(mutex);
+  return written;
+}
+
+auto FrameExporter::export_loop(void) -> void {
+  while(true) {
+    std::pair<Frame, Release> entry;
+    {
+      std::unique_lock lock(mutex);
+      frame_available.wait(lock, [this]{ return stopping || !queue.empty(); });
+      if(queue.empty()) return; // stopping, and nothing left to write
+
+      entry = std::move(queue.front());
+      queue.pop_front();
+      busy = true;
+    }
+
+    // a frame that fails to write is reported and skipped, the next one may well succeed
+    try {
+      write(entry.first);
+    } catch(const std::exception& e) {
+      std::cerr << "[readback] frame " << entry.first.number << ": " << e.what() << "\n";
+    }
+    if(entry.second)
+      entry.second();
+
+    {
+      std::lock_guard lock(mutex);
+      busy = false;
+      ++written;
+      if(queue.empty())
+        idle.notify_all();
+    }
+  }
+}
+
+auto FrameExporter::write(const Frame& frame) -> void {
+  auto raw_size = static_cast<std::size_t>(frame.width) * frame.height * 4;
+
+  if(format == ExportFormat::Stream) {
+    stream.write(reinterpret_cast<const char*>(frame.pixels), raw_size);
+    stream.flush(); // a reader on the other end of a pipe wants whole frames as they come
+    return;
+  }
+
+  const uint8_t* data = frame.pixels;
+  auto size = raw_size;
+  const char* extension = "raw";
+  if(format == ExportFormat::Png) {
+    encoded = encode_png(frame);
+    data = encoded.data(); size = encoded.size(); extension = "png";
+  } else if(format == ExportFormat::Ppm) {
+    encoded = encode_ppm(frame);
+    data = encoded.data(); size = encoded.size(); extension = "ppm";
+  }
+
+  auto file = std::ofstream(path / frame_file_name(frame.number, extension), std::ios::binary);
+  if(!file.is_open())
+    throw std::runtime_error("Error - unable to open output file");
+  file.write(reinterpret_cast<const char*>(data), size);
+}
+// ---- End of FrameExporter ----
+
+// ---- Readback ----
+auto Readback::create(VkDevice device, memory::DeviceAllocator& allocator, VkExtent2D extent, VkFormat format, uint32_t frames_in_flight, ExportFormat export_format, const std::filesystem::path& path) -> void {
+  if(export_format == ExportFormat::None) return;
+
+  auto pixel_order = pixel_order_for(format);
+  if(!pixel_order)
+    throw std::runtime_error("Error - readback does not support the colour target format");
+
+  this->device = device;
+  this->allocator = &allocator;
+  this->extent = extent;
+  this->order = *pixel_order;
+  this->frames_in_flight = frames_in_flight;
+
+  create_slots();
+  exporter.create(export_format, path);
+}
+
+auto Readback::destroy(void) -> void {
+  if(!enabled()) return;
+
+  destroy_slots();
+  exporter.destroy();
+  device = VK_NULL_HANDLE;
+}
+
+auto Readback::resize(VkExtent2D extent) -> void {
+  if(!enabled()) return;
+
+  destroy_slots();
+  this->extent = extent;
+  create_slots();
+}
+
+auto Readback::enabled(void) const -> bool {
+  return device != VK_NULL_HANDLE;
+}
+
+auto Readback::record_copy(VkCommandBuffer command_buffer, VkImage image, VkImageLayout layout, uint32_t frame_in_flight) -> void {
+  auto slot_index = acquire_slot();
+  in_flight[frame_in_flight] = std::make_pair(slot_index, next_frame_number++);
+
+  VkImageMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.baseMipLevel = 0;
+  barrier.subresourceRange.levelCount = 1;
+  barrier.subresourceRange.baseArrayLayer = 0;
+  barrier.subresourceRange.layerCount = 1;
+
+  // the render pass's external dependency makes its writes and final layout transition visible to
+  // transfers; a final layout other than transfer source still needs changing, chained onto that
+  if(layout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+    barrier.oldLayout = layout;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+  }
+
+  VkBufferImageCopy region{};
+  region.bufferOffset = 0;
+  region.bufferRowLength = 0; // tightly packed
+  region.bufferImageHeight = 0;
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.mipLevel = 0;
+  region.imageSubresource.baseArrayLayer = 0;
+  region.imageSubresource.layerCount = 1;
+  region.imageOffset = {0, 0, 0};
+  region.imageExtent = {extent.width, extent.height, 1};
+  vkCmdCopyImageToBuffer(command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slots[slot_index].buffer, 1, &region);
+
+  // back to whatever comes next (present); the copy only has to finish before the frame's fence
+  if(layout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = layout;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = 0;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+  }
+
+  // makes the copied bytes visible to the host once the fence is waited on
+  VkBufferMemoryBarrier host_barrier{};
+  host_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  host_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  host_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+  host_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  host_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  host_barrier.buffer = slots[slot_index].buffer;
+  host_barrier.offset = 0;
+  host_barrier.size = VK_WHOLE_SIZE;
+  vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &host_barrier, 0, nullptr);
+}
+
+auto Readback::frame_complete(uint32_t frame_in_flight) -> void {
+  if(!enabled()) return;
+
+  auto& copied = in_flight[frame_in_flight];
+  if(!copied) return;
+  auto [slot_index, number] = *copied;
+  copied.reset();
+
+  const auto& slot = slots[slot_index];
+  if(!slot.coherent) {
+    VkMappedMemoryRange range{};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = slot.memory.memory;
+    range.offset = slot.memory.offset;
+    range.size = slot.memory.size;
+    vkInvalidateMappedMemoryRanges(device, 1, &range);
+  }
+
+  // encoded straight out of the mapping, no copy into cpu memory first
+  Frame frame{};
+  frame.pixels = static_cast<const uint8_t*>(slots[slot_index].memory.mapped);
+  frame.width = extent.width;
+  frame.height = extent.height;
+  frame.order = order;
+  frame.number = number;
+
+  exporter.submit(frame, [this, slot_index = slot_index] {
+    {
+      std::lock_guard lock(mutex);
+      free_slots.push_back(slot_index);
+    }
+    slot_returned.notify_one();
+  });
+}
+
+auto Readback::frames_exported(void) const -> std::size_t {
+  return exporter.frames_written();
+}
+
+auto Readback::create_slots(void) -> void {
+  VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+
+  slots.resize(frames_in_flight + EXTRA_SLOTS);
+  for(auto& slot : slots) {
+    VkBufferCreateInfo buffer_info{};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = size;
+    buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if(vkCreateBuffer(device, &buffer_info, nullptr, &slot.buffer) != VK_SUCCESS)
+      throw std::runtime_error("Error - failed to create readback buffer");
+
+    VkMemoryRequirements mem_requirements;
+    vkGetBufferMemoryRequirements(device, slot.buffer, &mem_requirements);
+
+    // padded out to whole atoms, so invalidating the allocation never touches a neighbour's
+    auto atom = allocator->non_coherent_atom_size();
+    mem_requirements.alignment = std::max(mem_requirements.alignment, atom);
+    mem_requirements.size = (mem_requirements.size + atom - 1) / atom * atom;
+
+    // the exporter reads every byte, which is slow from uncached memory; host visible memory comes
+    // back already mapped, and stays mapped
+    slot.memory = allocator->allocate(mem_requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, memory::ResourceKind::Linear, VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+    slot.coherent = (allocator->memory_type_flags(slot.memory.memory_type) & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+    vkBindBufferMemory(device, slot.buffer, slot.memory.memory, slot.memory.offset);
+  }
+
+  in_flight.assign(frames_in_flight, std::nullopt);
+
+  std::lock_guard lock(mutex);
+  free_slots.clear();
+  for(uint32_t i = 0; i < slots.size(); ++i)
+    free_slots.push_back(i);
+}
+
+// the device is idle, so every copy still in flight has landed; export them before the buffers go
+auto Readback::destroy_slots(void) -> void {
+  for(uint32_t i = 0; i < in_flight.size(); ++i)
+    frame_complete(i);
+  exporter.wait_idle();
+
+  for(auto& slot : slots) {
+    vkDestroyBuffer(device, slot.buffer, nullptr);
+    allocator->free(slot.memory);
+  }
+  slots.clear();
+}
+
+auto Readback::acquire_slot(void) -> uint32_t {
+  std::unique_lock lock(mutex);
+  // only blocks when the exporter has fallen EXTRA_SLOTS frames behind
+  slot_returned.wait(lock, [this]{ return !free_slots.empty(); });
+
+  auto slot_index = free_slots.back();
+  free_slots.pop_back();
+  return slot_index;
+}
+// ---- End of Readback ----
+
+} // end of namespace readback
+
+// the same file as stdout, whatever it is called (/dev/stdout, /proc/self/fd/1, a file it was redirected to)
+static auto is_stdout(const std::filesystem::path& path) -> bool {
+  if(path == "-") return true;
+#ifdef __linux__
+  struct stat target{}, out{};
+  if(stat(path.c_str(), &target) != 0 || fstat(STDOUT_FILENO, &out) != 0) return false;
+  return target.st_dev == out.st_dev && target.st_ino == out.st_ino;
+#else
+  return false;
+#endif
+}
+
+static auto write_u32_be(std::vector<uint8_t>& out, uint32_t value) -> void {
+  out.push_back(static_cast<uint8_t>(value >> 24));
+  out.push_back(static_cast<uint8_t>(value >> 16));
+  out.push_back(static_cast<uint8_t>(value >> 8));
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+static auto write_chunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, std::size_t size) -> void {
+  write_u32_be(out, static_cast<uint32_t>(size));
+  auto type_start = out.size();
+  out.insert(out.end(), type, type + 4);
+  if(size > 0)
+    out.insert(out.end(), data, data + size);
+  // covers the type and the data, not the length
+  write_u32_be(out, readback::crc32(out.data() + type_start, out.size() - type_start));
+}
+
+static auto frame_file_name(uint64_t number, const char* extension) -> std::string {
+  auto name = std::ostringstream();
+  name << "frame_" << std::setw(6) << std::setfill('0') << number << "." << extension;
+  return name.str();
+}
@@ -0,0 +1,162 @@
+#include <system_error>
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <poll.h>
+#endif
+
+#include "shader_watcher.h"
+
+namespace shader_watcher {
+
+auto stage_for(const std::filesystem::path& source) -> std::optional<std::string> {
+  auto name = source.stem().string();
+  if(name.starts_with("vert")) return "vertex";
+  if(name.starts_with("frag")) return "fragment";
+  if(name.starts_with("comp")) return "compute";
+  return std::nullopt;
+}
+
+auto output_for(const std::filesystem::path& source) -> std::filesystem::path {
+  auto output = source;
+  return output.replace_extension(".spv");
+}
+
+// ---- ShaderWatcher ----
+ShaderWatcher::~ShaderWatcher() {
+  destroy();
+}
+
+auto ShaderWatcher::create(const std::filesystem::path& directory, thread_pool::ThreadPool& pool) -> void {
+  this->directory = directory;
+  this->pool = &pool;
+  stopping = false;
+
+#ifdef __linux__
+  inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  // editors either write in place (close_write) or write elsewhere and rename over (moved_to)
+  if(inotify_fd < 0 || inotify_add_watch(inotify_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    throw std::runtime_error("Error - failed to watch shader directory " + directory.string());
+#else
+  for(const auto& entry : std::filesystem::directory_iterator(directory))
+    write_times[entry.path()] = entry.last_write_time();
+#endif
+
+  watcher = std::thread([this]{ watch_loop(); });
+}
+
+auto ShaderWatcher::destroy(void) -> void {
+  if(!watcher.joinable()) return;
+
+  stopping = true;
+  watcher.join();
+
+  // compiles capture this, let them finish (no new ones start once stopping is set)
+  {
+    std::unique_lock lock(mutex);
+    compiles_done.wait(lock, [this]{ return compiling.empty(); });
+  }
+
+#ifdef __linux__
+  close(inotify_fd);
+  inotify_fd = -1;
+#endif
+}
+
+auto ShaderWatcher::poll(std::vector<std::filesystem::path>& changed) -> void {
+  std::lock_guard lock(mutex);
+  changed.insert(changed.end(), changed_outputs.begin(), changed_outputs.end());
+  changed_outputs.clear();
+}
+
+auto ShaderWatcher::watch_loop(void) -> void {
+#ifdef __linux__
+  alignas(inotify_event) char buffer[4096];
+
+  while(!stopping) {
+    pollfd descriptor{inotify_fd, POLLIN, 0};
+    if(::poll(&descriptor, 1, 100) <= 0) continue; // wake up regularly to notice stopping
+
+    auto length = read(inotify_fd, buffer, sizeof(buffer));
+    for(auto offset = 0l; offset < length;) {
+      auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+      if(event->len > 0)
+        on_file_changed(directory / event->name);
+      offset += sizeof(inotify_event) + event->len;
+    }
+  }
+#else
+  while(!stopping) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+    std::error_code error;
+    for(const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+      auto write_time = entry.last_write_time(error);
+      if(error) continue;
+
+      auto [it, inserted] = write_times.try_emplace(entry.path(), write_time);
+      if(inserted || it->second != write_time) {
+        it->second = write_time;
+        on_file_changed(entry.path());
+      }
+    }
+  }
+#endif
+}
+
+auto ShaderWatcher::on_file_changed(const std::filesystem::path& file) -> void {
+  std::lock_guard lock(mutex);
+
+  if(file.extension() == ".spv") {
+    changed_outputs.insert(file);
+  } else if(file.extension() == ".glsl") {
+    // one glslc per file at a time; a save during a compile queues exactly one more
+    if(compiling.contains(file)) {
+      recompile.insert(file);
+    } else {
+      compiling.insert(file);
+      pool->submit([this, file]{ compile(file); });
+    }
+  }
+}
+
+auto ShaderWatcher::compile(const std::filesystem::path& source) -> void {
+  if(auto stage = stage_for(source); stage) {
+    auto output = output_for(source);
+    auto temporary = output;
+    temporary += ".tmp";
+
+    // same invocation as shaders/compile.sh, written next to the output and renamed over it so
+    // the loader never sees a half written module
+    auto command = "glslc -fshader-stage=" + *stage + " \"" + source.string() + "\" -o \"" + temporary.string() + "\"";
+    auto status = std::system(command.c_str());
+
+    std::error_code error;
+    if(status == 0) {
+      std::filesystem::rename(temporary, output, error);
+      std::cout << "[shader] recompiled " << source.filename() << "\n";
+    } else {
+      std::filesystem::remove(temporary, error);
+      std::cerr << "[shader] " << source.filename() << " failed to compile, keeping the previous pipeline\n";
+    }
+  } else {
+    std::cerr << "[shader] cannot tell the stage of " << source.filename() << ", not compiling it\n";
+  }
+
+  {
+    std::lock_guard lock(mutex);
+    if(recompile.erase(source) > 0 && !stopping) {
+      pool->submit([this, source]{ compile(source); });
+      return;
+    }
+    compiling.erase(source);
+  }
+  compiles_done.notify_all();
+}
+// ---- End of ShaderWatcher ----
+
+} // end of namespace shader_watcher
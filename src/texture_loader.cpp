@@ -0,0 +1,93 @@
+#include <stdexcept>
+#include <exception>
+
+#include "stb_image.h"
+
+#include "texture_loader.h"
+
+namespace texture_loader {
+
+auto decode_file(const std::string& path) -> Image {
+  int width, height, channels;
+  auto* pixels = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+  if(!pixels)
+    throw std::runtime_error("Error - failed to decode " + path + ": " + stbi_failure_reason());
+
+  Image image{};
+  image.width = static_cast<uint32_t>(width);
+  image.height = static_cast<uint32_t>(height);
+  image.pixels.assign(pixels, pixels + static_cast<std::size_t>(width) * height * 4);
+  stbi_image_free(pixels);
+  return image;
+}
+
+// ---- TextureLoader ----
+TextureLoader::~TextureLoader() {
+  destroy();
+}
+
+auto TextureLoader::create(thread_pool::ThreadPool& pool, bool generate_mips) -> void {
+  this->pool = &pool;
+  this->generate_mips = generate_mips;
+}
+
+auto TextureLoader::destroy(void) -> void {
+  if(pool == nullptr) return;
+  wait();
+
+  std::lock_guard lock(mutex);
+  done.clear();
+  pool = nullptr;
+}
+
+auto TextureLoader::request(std::size_t id, const std::string& path) -> void {
+  request(id, [path] { return decode_file(path); });
+}
+
+auto TextureLoader::request(std::size_t id, Source source) -> void {
+  {
+    std::lock_guard lock(mutex);
+    ++running;
+  }
+
+  pool->submit([this, id, source = std::move(source)] {
+    Completed completed{};
+    completed.id = id;
+    try {
+      completed.image = source();
+      if(generate_mips && completed.image.levels.empty())
+        completed.image.pixels = upload::generate_mip_chain(completed.image.pixels.data(), completed.image.width, completed.image.height, true, completed.image.levels);
+    } catch(const std::exception& e) {
+      completed.image = {};
+      completed.error = e.what();
+    }
+    finish(std::move(completed));
+  });
+}
+
+auto TextureLoader::take_completed(std::vector<Completed>& completed) -> void {
+  std::lock_guard lock(mutex);
+  for(auto& image : done)
+    completed.push_back(std::move(image));
+  done.clear();
+}
+
+auto TextureLoader::wait(void) -> void {
+  std::unique_lock lock(mutex);
+  all_done.wait(lock, [this] { return running == 0; });
+}
+
+auto TextureLoader::outstanding(void) const -> std::size_t {
+  std::lock_guard lock(mutex);
+  return running + done.size();
+}
+
+auto TextureLoader::finish(Completed completed) -> void {
+  std::lock_guard lock(mutex);
+  done.push_back(std::move(completed));
+  if(--running == 0)
+    all_done.notify_all();
+}
+// ---- End of TextureLoader ----
+
+} // end of namespace texture_loader
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <algorithm>
+#include <exception>
+
+#include "thread_pool.h"
+
+namespace thread_pool {
+
+ThreadPool::ThreadPool(std::size_t thread_count) {
+  thread_count = std::max<std::size_t>(thread_count, 1);
+  workers.reserve(thread_count);
+  for(std::size_t i = 0; i < thread_count; ++i)
+    workers.emplace_back([this]{ worker_loop(); });
+}
+
+// finishes every queued task before joining
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(mutex);
+    stopping = true;
+  }
+  task_available.notify_all();
+
+  for(auto& worker : workers)
+    worker.join();
+}
+
+// leaves a core for the render thread
+auto ThreadPool::default_thread_count(void) -> std::size_t {
+  auto hardware_threads = static_cast<std::size_t>(std::thread::hardware_concurrency());
+  return std::max<std::size_t>(hardware_threads, 2) - 1;
+}
+
+auto ThreadPool::submit(Task task) -> void {
+  {
+    std::lock_guard lock(mutex);
+    tasks.push(std::move(task));
+  }
+  task_available.notify_one();
+}
+
+auto ThreadPool::wait_idle(void) -> void {
+  std::unique_lock lock(mutex);
+  idle.wait(lock, [this]{ return tasks.empty() && running == 0; });
+}
+
+auto ThreadPool::size(void) const -> std::size_t {
+  return workers.size();
+}
+
+auto ThreadPool::worker_loop(void) -> void {
+  while(true) {
+    Task task;
+    {
+      std::unique_lock lock(mutex);
+      task_available.wait(lock, [this]{ return stopping || !tasks.empty(); });
+      if(tasks.empty()) return; // stopping, and nothing left to run
+
+      task = std::move(tasks.front());
+      tasks.pop();
+      ++running;
+    }
+
+    // a throwing task must not take the worker down with it; owners report their own errors
+    try {
+      task();
+    } catch(const std::exception& e) {
+      std::cerr << "[thread_pool] task threw: " << e.what() << "\n";
+    }
+
+    {
+      std::lock_guard lock(mutex);
+      --running;
+      if(tasks.empty() && running == 0)
+        idle.notify_all();
+    }
+  }
+}
+
+} // end of namespace thread_pool
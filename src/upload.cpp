@@ -0,0 +1,638 @@
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <array>
+
+#include "upload.h"
+
+static auto create_staging_buffer(VkDevice device, memory::DeviceAllocator& allocator, VkDeviceSize size, VkBuffer& buffer, memory::Allocation& buffer_memory) -> void;
+
+namespace upload {
+
+// staged copies start on this boundary; covers the texel size of every format uploaded so far
+static constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+auto mip_level_count(uint32_t width, uint32_t height) -> uint32_t {
+  auto largest = std::max<uint32_t>({width, height, 1});
+  uint32_t levels = 1;
+  while(largest >>= 1)
+    ++levels;
+  return levels;
+}
+
+static auto linear_to_srgb(float value) -> float {
+  return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+auto generate_mip_chain(const unsigned char* pixels, uint32_t width, uint32_t height, bool srgb, std::vector<ImageLevel>& levels) -> std::vector<unsigned char> {
+  levels.clear();
+  VkDeviceSize total = 0;
+  auto level_width = std::max<uint32_t>(width, 1);
+  auto level_height = std::max<uint32_t>(height, 1);
+  for(uint32_t level = 0; level < mip_level_count(width, height); ++level) {
+    auto size = static_cast<VkDeviceSize>(level_width) * level_height * 4;
+    levels.push_back({total, size, level_width, level_height});
+    total += size;
+    level_width = std::max<uint32_t>(level_width / 2, 1);
+    level_height = std::max<uint32_t>(level_height / 2, 1);
+  }
+
+  std::vector<unsigned char> chain(static_cast<std::size_t>(total));
+  memcpy(chain.data(), pixels, static_cast<std::size_t>(levels[0].size));
+
+  // colour channels are decoded through a table, alpha is always linear
+  std::array<float, 256> to_linear{};
+  for(std::size_t i = 0; i < to_linear.size(); ++i) {
+    auto value = static_cast<float>(i) / 255.0f;
+    to_linear[i] = srgb ? (value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f)) : value;
+  }
+
+  // every level from the one above it
+  for(std::size_t level = 1; level < levels.size(); ++level) {
+    const auto& source = levels[level - 1];
+    const auto& destination = levels[level];
+    const auto* in = chain.data() + source.offset;
+    auto* out = chain.data() + destination.offset;
+
+    for(uint32_t y = 0; y < destination.height; ++y) {
+      uint32_t rows[] = {std::min(y * 2, source.height - 1), std::min(y * 2 + 1, source.height - 1)};
+      for(uint32_t x = 0; x < destination.width; ++x) {
+        uint32_t columns[] = {std::min(x * 2, source.width - 1), std::min(x * 2 + 1, source.width - 1)};
+
+        for(std::size_t channel = 0; channel < 4; ++channel) {
+          auto sum = 0.0f;
+          for(auto row : rows) {
+            for(auto column : columns) {
+              auto value = in[(static_cast<std::size_t>(row) * source.width + column) * 4 + channel];
+              sum += channel < 3 ? to_linear[value] : static_cast<float>(value) / 255.0f;
+            }
+          }
+
+          auto average = sum / 4.0f;
+          if(srgb && channel < 3)
+            average = linear_to_srgb(average);
+          out[(static_cast<std::size_t>(y) * destination.width + x) * 4 + channel] = static_cast<unsigned char>(std::clamp(average, 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+      }
+    }
+  }
+
+  return chain;
+}
+
+// ---- StagingRing ----
+StagingRing::StagingRing(VkDeviceSize capacity): capacity(capacity) {}
+
+auto StagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment) -> std::optional<VkDeviceSize> {
+  if(size > capacity) return std::nullopt;
+  alignment = std::max<VkDeviceSize>(alignment, 1);
+
+  auto start = head_position % capacity;
+  auto offset = (start + alignment - 1) / alignment * alignment;
+  auto consumed = offset - start;
+
+  // a range never straddles the end of the buffer; skip the tail and start again at 0
+  if(offset + size > capacity) {
+    consumed = capacity - start;
+    offset = 0;
+  }
+
+  if(head_position + consumed + size - tail_position > capacity) return std::nullopt;
+
+  head_position += consumed + size;
+  return offset;
+}
+
+auto StagingRing::release(VkDeviceSize mark) -> void {
+  tail_position = std::max(tail_position, mark);
+}
+
+auto StagingRing::head(void) const -> VkDeviceSize {
+  return head_position;
+}
+
+auto StagingRing::in_use(void) const -> VkDeviceSize {
+  return head_position - tail_position;
+}
+// ---- End of StagingRing ----
+
+// ---- Acquire ----
+auto Acquire::empty(void) const -> bool {
+  return semaphores.empty() && buffer_barriers.empty() && image_barriers.empty();
+}
+
+auto Acquire::record(VkCommandBuffer command_buffer) const -> void {
+  if(buffer_barriers.empty() && image_barriers.empty()) return;
+
+  // the semaphore wait has to cover STAGES, which chains it to this barrier's first scope
+  vkCmdPipelineBarrier(
+    command_buffer, STAGES, STAGES, 0, 0, nullptr,
+    static_cast<uint32_t>(buffer_barriers.size()), buffer_barriers.data(),
+    static_cast<uint32_t>(image_barriers.size()), image_barriers.data());
+}
+
+auto Acquire::clear(void) -> void {
+  semaphores.clear();
+  buffer_barriers.clear();
+  image_barriers.clear();
+}
+// ---- End of Acquire ----
+
+// ---- UploadContext ----
+auto UploadContext::create(VkDevice device, memory::DeviceAllocator& allocator, VkQueue queue, uint32_t queue_family, uint32_t destination_family, VkDeviceSize staging_size) -> void {
+  this->device = device;
+  this->allocator = &allocator;
+  this->queue = queue;
+  this->queue_family = queue_family;
+  this->destination_family = destination_family;
+
+  // batches are short lived and their command buffers are re-recorded individually
+  VkCommandPoolCreateInfo pool_info{};
+  pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  pool_info.queueFamilyIndex = queue_family;
+
+  if(vkCreateCommandPool(device, &pool_info, nullptr, &command_pool) != VK_SUCCESS)
+    throw std::runtime_error("Error - failed to create upload command pool");
+
+  // one persistently mapped staging buffer for the lifetime of the context
+  create_staging_buffer(device, allocator, staging_size, staging_buffer, staging_memory);
+  ring = StagingRing(staging_size);
+}
+
+auto UploadContext::destroy(void) -> void {
+  flush();
+
+  for(auto& batch : recycled)
+    vkDestroyFence(device, batch.fence, nullptr);
+  recycled.clear();
+
+  // anything never taken was signalled by a finished batch, so nothing can still be pending on it
+  recycle_semaphores(pending_acquire.semaphores);
+  pending_acquire.clear();
+  for(auto semaphore : free_semaphores)
+    vkDestroySemaphore(device, semaphore, nullptr);
+  free_semaphores.clear();
+
+  vkDestroyBuffer(device, staging_buffer, nullptr);
+  allocator->free(staging_memory);
+
+  vkDestroyCommandPool(device, command_pool, nullptr); // frees every batch command buffer
+}
+
+auto UploadContext::upload_buffer(VkBuffer destination, const void* data, VkDeviceSize size, VkDeviceSize destination_offset) -> void {
+  VkBuffer source;
+  auto source_offset = stage(data, size, source);
+
+  VkBufferCopy copy_region{};
+  copy_region.srcOffset = source_offset;
+  copy_region.dstOffset = destination_offset;
+  copy_region.size = size;
+  vkCmdCopyBuffer(recording(), source, destination, 1, &copy_region);
+
+  if(transfers_ownership()) release_buffer(destination);
+}
+
+auto UploadContext::upload_image(VkImage image, const void* data, VkDeviceSize size, uint32_t width, uint32_t height, uint32_t mip_levels) -> void {
+  if(mip_levels > 1 && !can_generate_mipmaps())
+    throw std::invalid_argument("Error - mipmaps cannot be blitted on the upload queue, upload every level instead");
+
+  VkBuffer source;
+  auto source_offset = stage(data, size, source);
+
+  transition_image_layout(image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mip_levels);
+
+  VkBufferImageCopy region{};
+  region.bufferOffset = source_offset;
+  region.bufferRowLength = 0; // tightly packed
+  region.bufferImageHeight = 0;
+
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.mipLevel = 0;
+  region.imageSubresource.baseArrayLayer = 0;
+  region.imageSubresource.layerCount = 1;
+
+  region.imageOffset = {0, 0, 0};
+  region.imageExtent = {width, height, 1};
+
+  vkCmdCopyBufferToImage(recording(), source, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+  if(mip_levels > 1)
+    generate_mipmaps(image, width, height, mip_levels); // leaves every level ready for shader access
+  else
+    finish_image(image, 1);
+}
+
+auto UploadContext::upload_image_levels(VkImage image, const void* data, VkDeviceSize size, const std::vector<ImageLevel>& levels) -> void {
+  VkBuffer source;
+  auto source_offset = stage(data, size, source);
+
+  auto mip_levels = static_cast<uint32_t>(levels.size());
+  transition_image_layout(image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mip_levels);
+
+  std::vector<VkBufferImageCopy> regions(levels.size());
+  for(uint32_t level = 0; level < mip_levels; ++level) {
+    auto& region = regions[level];
+    region.bufferOffset = source_offset + levels[level].offset;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = level;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {levels[level].width, levels[level].height, 1};
+  }
+  vkCmdCopyBufferToImage(recording(), source, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mip_levels, regions.data());
+
+  finish_image(image, mip_levels);
+}
+
+auto UploadContext::copy_buffer(VkBuffer source, VkBuffer destination, VkDeviceSize size) -> void {
+  VkBufferCopy copy_region{};
+  copy_region.size = size;
+  // src, dest, arr_size, arr of regions to copy
+  vkCmdCopyBuffer(recording(), source, destination, 1, &copy_region);
+
+  if(transfers_ownership()) release_buffer(destination);
+}
+
+auto UploadContext::transition_image_layout(VkImage image, VkImageLayout old_layout, VkImageLayout new_layout, uint32_t mip_levels) -> void {
+  VkImageMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.oldLayout = old_layout; // can use VK_IMAGE_LAYOUT_UNDEFINED if dont care about existing image contents
+  barrier.newLayout = new_layout;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED; // both must be explicitly ignored
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.baseMipLevel = 0;
+  barrier.subresourceRange.levelCount = mip_levels;
+  barrier.subresourceRange.baseArrayLayer = 0;
+  barrier.subresourceRange.layerCount = 1;
+
+  // set access masks for pipeline stages based on layouts in the transition
+  // two transitions need to handle;
+  // - undefined -> transfer destination: transfer writes that don't need to wait
+  // - transfer destination -> shader reading: shader reads should wait on transfer writes,
+  //   specifically shader reads in fragment shader, because thats where texture is used
+  // the second scope of a barrier covers every later command submitted to the queue, so
+  // draws in frame submits are ordered after it without waiting on the batch fence
+  VkPipelineStageFlags source_stage;
+  VkPipelineStageFlags destination_stage;
+
+  if(old_layout == VK_IMAGE_LAYOUT_UNDEFINED && new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    destination_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+  } else if (old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    destination_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+  } else {
+    throw std::invalid_argument("Error - unsupported layout transition");
+  }
+
+  vkCmdPipelineBarrier(recording(), source_stage, destination_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+auto UploadContext::submit(void) -> Ticket {
+  if(!open_batch) return next_ticket - 1;
+
+  auto batch = std::move(*open_batch);
+  open_batch.reset();
+
+  VkSemaphore signal_semaphore = VK_NULL_HANDLE;
+  if(transfers_ownership()) {
+    // the release barriers were recorded per resource; the destination queue waits on this
+    // semaphore before recording the matching acquires
+    if(free_semaphores.empty()) {
+      VkSemaphoreCreateInfo semaphore_info{};
+      semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+      if(vkCreateSemaphore(device, &semaphore_info, nullptr, &signal_semaphore) != VK_SUCCESS)
+        throw std::runtime_error("Error - failed to create upload semaphore");
+    } else {
+      signal_semaphore = free_semaphores.back();
+      free_semaphores.pop_back();
+    }
+  } else {
+    // make every buffer copy in the batch visible to whatever reads vertices, indices and uniforms next
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(batch.command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, Acquire::STAGES, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+  }
+
+  if(vkEndCommandBuffer(batch.command_buffer) != VK_SUCCESS)
+    throw std::runtime_error("Error - failed to record upload command buffer");
+
+  VkSubmitInfo submit_info{};
+  submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submit_info.commandBufferCount = 1;
+  submit_info.pCommandBuffers = &batch.command_buffer;
+  if(signal_semaphore != VK_NULL_HANDLE) {
+    submit_info.signalSemaphoreCount = 1;
+    submit_info.pSignalSemaphores = &signal_semaphore;
+  }
+
+  if(vkQueueSubmit(queue, 1, &submit_info, batch.fence) != VK_SUCCESS)
+    throw std::runtime_error("Error - failed to submit upload command buffer");
+
+  batch.ticket = next_ticket++;
+  batch.ring_mark = ring.head();
+
+  if(signal_semaphore != VK_NULL_HANDLE) {
+    auto& acquire = batch.acquire;
+    pending_acquire.semaphores.push_back(signal_semaphore);
+    pending_acquire.buffer_barriers.insert(pending_acquire.buffer_barriers.end(), acquire.buffer_barriers.begin(), acquire.buffer_barriers.end());
+    pending_acquire.image_barriers.insert(pending_acquire.image_barriers.end(), acquire.image_barriers.begin(), acquire.image_barriers.end());
+    acquire.clear();
+  }
+  in_flight.push_back(std::move(batch));
+  ++submits;
+
+  retire(false);
+  return next_ticket - 1;
+}
+
+auto UploadContext::is_complete(Ticket ticket) -> bool {
+  retire(false);
+  return ticket <= completed_ticket;
+}
+
+auto UploadContext::wait(Ticket ticket) -> void {
+  while(completed_ticket < ticket && !in_flight.empty())
+    retire(true);
+}
+
+auto UploadContext::flush(void) -> void {
+  wait(submit());
+}
+
+auto UploadContext::submit_count(void) const -> std::size_t {
+  return submits;
+}
+
+auto UploadContext::bytes_staged(void) const -> VkDeviceSize {
+  return staged_bytes;
+}
+
+auto UploadContext::can_generate_mipmaps(void) const -> bool {
+  return !transfers_ownership();
+}
+
+auto UploadContext::transfers_ownership(void) const -> bool {
+  return queue_family != destination_family;
+}
+
+auto UploadContext::take_acquires(Acquire& acquire) -> void {
+  acquire.semaphores.insert(acquire.semaphores.end(), pending_acquire.semaphores.begin(), pending_acquire.semaphores.end());
+  acquire.buffer_barriers.insert(acquire.buffer_barriers.end(), pending_acquire.buffer_barriers.begin(), pending_acquire.buffer_barriers.end());
+  acquire.image_barriers.insert(acquire.image_barriers.end(), pending_acquire.image_barriers.begin(), pending_acquire.image_barriers.end());
+  pending_acquire.clear();
+}
+
+auto UploadContext::recycle_semaphores(std::vector<VkSemaphore>& semaphores) -> void {
+  free_semaphores.insert(free_semaphores.end(), semaphores.begin(), semaphores.end());
+  semaphores.clear();
+}
+
+// the command buffer of the open batch, starting a new batch if there is none
+auto UploadContext::recording(void) -> VkCommandBuffer {
+  if(open_batch) return open_batch->command_buffer;
+
+  Batch batch{};
+  if(!recycled.empty()) {
+    batch = std::move(recycled.back());
+    recycled.pop_back();
+  } else {
+    VkCommandBufferAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandPool = command_pool;
+    alloc_info.commandBufferCount = 1;
+
+    if(vkAllocateCommandBuffers(device, &alloc_info, &batch.command_buffer) != VK_SUCCESS)
+      throw std::runtime_error("Error - failed to allocate upload command buffer");
+
+    VkFenceCreateInfo fence_info{};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    if(vkCreateFence(device, &fence_info, nullptr, &batch.fence) != VK_SUCCESS)
+      throw std::runtime_error("Error - failed to create upload fence");
+  }
+
+  VkCommandBufferBeginInfo begin_info{};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT; // only using once, good compiler hint
+
+  // implicitly resets a recycled command buffer (pool allows individual resets)
+  if(vkBeginCommandBuffer(batch.command_buffer, &begin_info) != VK_SUCCESS)
+    throw std::runtime_error("Error - failed to begin recording upload command buffer");
+
+  open_batch = std::move(batch);
+  return open_batch->command_buffer;
+}
+
+// copies data into staging memory, returning the offset into buffer that the copy should read from;
+// must be called before recording() since running out of ring space submits the open batch
+auto UploadContext::stage(const void* data, VkDeviceSize size, VkBuffer& buffer) -> VkDeviceSize {
+  staged_bytes += size;
+  if(size > ring.capacity) {
+    // too big for the ring altogether, give it a staging buffer of its own that lives as long as the batch
+    VkBuffer oversized_buffer;
+    memory::Allocation oversized_memory;
+    create_staging_buffer(device, *allocator, size, oversized_buffer, oversized_memory);
+    memcpy(oversized_memory.mapped, data, static_cast<std::size_t>(size));
+
+    recording();
+    open_batch->oversized.emplace_back(oversized_buffer, oversized_memory);
+    buffer = oversized_buffer;
+    return 0;
+  }
+
+  auto offset = ring.allocate(size, STAGING_ALIGNMENT);
+  while(!offset) {
+    // the ring is full of data the gpu has not consumed yet; push the open batch out
+    // if it holds the only outstanding data, then wait for the oldest batch to finish
+    if(in_flight.empty()) submit();
+    retire(true);
+    offset = ring.allocate(size, STAGING_ALIGNMENT);
+  }
+
+  memcpy(static_cast<char*>(staging_memory.mapped) + *offset, data, static_cast<std::size_t>(size));
+  buffer = staging_buffer;
+  return *offset;
+}
+
+// releases finished batches oldest first; when block is set, waits for at least the oldest one
+auto UploadContext::retire(bool block) -> void {
+  while(!in_flight.empty()) {
+    auto& batch = in_flight.front();
+    if(block) {
+      vkWaitForFences(device, 1, &batch.fence, VK_TRUE, UINT64_MAX);
+      block = false;
+    } else if(vkGetFenceStatus(device, batch.fence) != VK_SUCCESS) {
+      break;
+    }
+
+    release_batch(batch);
+    in_flight.pop_front();
+  }
+}
+
+auto UploadContext::release_batch(Batch& batch) -> void {
+  ring.release(batch.ring_mark);
+  completed_ticket = batch.ticket;
+
+  for(auto& [buffer, buffer_memory] : batch.oversized) {
+    vkDestroyBuffer(device, buffer, nullptr);
+    allocator->free(buffer_memory);
+  }
+  batch.oversized.clear();
+
+  vkResetFences(device, 1, &batch.fence);
+  recycled.push_back(std::move(batch));
+}
+// release half of a queue family ownership transfer; the acquire half is kept with the batch.
+// a resource should only be uploaded once per batch while ownership is being transferred
+auto UploadContext::release_buffer(VkBuffer buffer) -> void {
+  VkBufferMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = 0; // ignored for a release
+  barrier.srcQueueFamilyIndex = queue_family;
+  barrier.dstQueueFamilyIndex = destination_family;
+  barrier.buffer = buffer;
+  barrier.offset = 0;
+  barrier.size = VK_WHOLE_SIZE;
+
+  vkCmdPipelineBarrier(recording(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+  barrier.srcAccessMask = 0; // ignored for an acquire
+  barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT;
+  open_batch->acquire.buffer_barriers.push_back(barrier);
+}
+
+// same as release_buffer, layouts have to match exactly between the release and the acquire
+auto UploadContext::release_image(VkImage image, VkImageLayout old_layout, VkImageLayout new_layout, uint32_t mip_levels) -> void {
+  VkImageMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.oldLayout = old_layout;
+  barrier.newLayout = new_layout;
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = 0;
+  barrier.srcQueueFamilyIndex = queue_family;
+  barrier.dstQueueFamilyIndex = destination_family;
+  barrier.image = image;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.baseMipLevel = 0;
+  barrier.subresourceRange.levelCount = mip_levels;
+  barrier.subresourceRange.baseArrayLayer = 0;
+  barrier.subresourceRange.layerCount = 1;
+
+  vkCmdPipelineBarrier(recording(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+  barrier.srcAccessMask = 0;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  open_batch->acquire.image_barriers.push_back(barrier);
+}
+
+// one last transition to prepare for shader access; a transfer-only queue cannot reach the
+// fragment shader stage, so across families the transition is folded into the ownership transfer
+auto UploadContext::finish_image(VkImage image, uint32_t mip_levels) -> void {
+  if(transfers_ownership())
+    release_image(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mip_levels);
+  else
+    transition_image_layout(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mip_levels);
+}
+
+// every level is in transfer destination layout with level 0 written; each level is blitted from
+// the one above, which is then done with and goes straight to shader reads. the caller has checked
+// the format can be a linearly filtered blit source and destination
+auto UploadContext::generate_mipmaps(VkImage image, uint32_t width, uint32_t height, uint32_t mip_levels) -> void {
+  auto command_buffer = recording();
+
+  VkImageMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image;
+  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  barrier.subresourceRange.levelCount = 1;
+  barrier.subresourceRange.baseArrayLayer = 0;
+  barrier.subresourceRange.layerCount = 1;
+
+  auto level_width = static_cast<int32_t>(width);
+  auto level_height = static_cast<int32_t>(height);
+  for(uint32_t level = 1; level < mip_levels; ++level) {
+    // the level above was just written, wait for that and read from it
+    barrier.subresourceRange.baseMipLevel = level - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    auto next_width = std::max(level_width / 2, 1);
+    auto next_height = std::max(level_height / 2, 1);
+
+    VkImageBlit blit{};
+    blit.srcOffsets[0] = {0, 0, 0};
+    blit.srcOffsets[1] = {level_width, level_height, 1};
+    blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit.srcSubresource.mipLevel = level - 1;
+    blit.srcSubresource.baseArrayLayer = 0;
+    blit.srcSubresource.layerCount = 1;
+    blit.dstOffsets[0] = {0, 0, 0};
+    blit.dstOffsets[1] = {next_width, next_height, 1};
+    blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit.dstSubresource.mipLevel = level;
+    blit.dstSubresource.baseArrayLayer = 0;
+    blit.dstSubresource.layerCount = 1;
+    vkCmdBlitImage(command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    level_width = next_width;
+    level_height = next_height;
+  }
+
+  // the smallest level is never blitted from
+  barrier.subresourceRange.baseMipLevel = mip_levels - 1;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+// ---- End of UploadContext ----
+
+} // end of namespace upload
+
+static auto create_staging_buffer(VkDevice device, memory::DeviceAllocator& allocator, VkDeviceSize size, VkBuffer& buffer, memory::Allocation& buffer_memory) -> void {
+  VkBufferCreateInfo buffer_info{};
+  buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  buffer_info.size = size;
+  buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+  buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+  if(vkCreateBuffer(device, &buffer_info, nullptr, &buffer) != VK_SUCCESS)
+    throw std::runtime_error("Error - failed to create staging buffer");
+
+  VkMemoryRequirements mem_requirements;
+  vkGetBufferMemoryRequirements(device, buffer, &mem_requirements);
+
+  // host visible memory comes back already mapped
+  buffer_memory = allocator.allocate(mem_requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, memory::ResourceKind::Linear);
+  vkBindBufferMemory(device, buffer, buffer_memory.memory, buffer_memory.offset);
+}
@@ -5,15 +5,19 @@
 #include <iostream>
 #include <cstdlib>
 #include <cstring>
+#include <cstddef>
 #include <fstream>
 #include <limits>
 #include <chrono>
+#include <cmath>
 #include <set>
+#include <filesystem>
 
 // header only library
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
 #include <glm/gtx/string_cast.hpp> // only for debug, printing vectors
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -23,18 +27,38 @@
 #include "vulkan.h"
 #include "camera.h"
 
+// the camera, once per frame when model matrices are pushed (vert.glsl)
 struct UniformBufferObject {
   UniformBufferObject() = default;
-  UniformBufferObject(glm::mat4 m, glm::mat4 v, glm::mat4 p): model(m), view(v), projection(p) {}
+  UniformBufferObject(glm::mat4 v, glm::mat4 p): view(v), projection(p) {}
 
 public:
   // shader requirements; offsets must be multiples of 16 
   // (glsl mat4 requires same alignment as vec3/vec4)
+  alignas(16) glm::mat4 view;
+  alignas(16) glm::mat4 projection;
+};
+
+// once per object when they are not (vert_arena.glsl)
+struct ObjectUniformBufferObject {
   alignas(16) glm::mat4 model;
   alignas(16) glm::mat4 view;
   alignas(16) glm::mat4 projection;
 };
 
+// per draw; the vertex stage reads the model matrix, the bindless fragment shader the material's
+// slot in the texture array (layout(offset = 64) in frag_bindless.glsl)
+struct DrawPushConstants {
+  glm::mat4 model;
+  uint32_t texture_index{0};
+};
+
+// bytes pushed per draw, the whole struct only with bindless textures; well under the 128 every device has.
+// without pushed transforms only the texture slot is, at its offset
+static constexpr uint32_t MODEL_PUSH_SIZE = sizeof(glm::mat4);
+static constexpr uint32_t DRAW_PUSH_SIZE = offsetof(DrawPushConstants, texture_index) + sizeof(uint32_t);
+static constexpr uint32_t TEXTURE_PUSH_OFFSET = offsetof(DrawPushConstants, texture_index);
+
 struct VulkanVertex {
   VulkanVertex() = default;
   VulkanVertex(glm::vec3 p, glm::vec3 c, glm::vec2 t): pos(p), col(c), tex(t) {}
@@ -127,6 +151,8 @@ public:
 public:
   std::optional<uint32_t> graphics_family;
   std::optional<uint32_t> present_family;
+  std::optional<uint32_t> transfer_family; // transfer without graphics/compute, usually a dma engine
+  std::optional<uint32_t> compute_family; // compute without graphics (async compute)
 };
 
 struct SwapChainSupportDetails {
@@ -139,7 +165,7 @@ public:
 };
 
 static auto check_validation_layer_support(void) -> bool;
-static auto message_callback_get_required_extensions(void) -> std::vector<const char*>;
+static auto message_callback_get_required_extensions(bool, bool) -> std::vector<const char*>;
 static VKAPI_ATTR VkBool32 VKAPI_CALL debug_callback(VkDebugUtilsMessageSeverityFlagBitsEXT, VkDebugUtilsMessageTypeFlagsEXT, const VkDebugUtilsMessengerCallbackDataEXT*, void*);
 static auto populate_debug_messenger_create_info(VkDebugUtilsMessengerCreateInfoEXT&) -> void;
 static auto choose_swap_surface_format(const std::vector<VkSurfaceFormatKHR>&) -> VkSurfaceFormatKHR;
@@ -147,11 +173,17 @@ static auto choose_swap_present_mode(const std::vector<VkPresentModeKHR>&) -> Vk
 static auto choose_swap_extent(GLFWwindow*, const VkSurfaceCapabilitiesKHR&) -> VkExtent2D;
 static auto read_file(const std::string&) -> std::vector<char>;
 static auto create_shader_module(VkDevice, const std::vector<char>&) -> VkShaderModule;
+static auto build_graphics_pipeline(VkDevice, VkPipelineCache, VkPipelineLayout, VkRenderPass, uint32_t, bool, const std::string&, const std::string&) -> VkPipeline;
 static auto framebuffer_resize_callback(GLFWwindow*, int width, int height) -> void;
+static auto generate_mesh(std::size_t, std::vector<VulkanVertex>&, std::vector<uint16_t>&) -> vulkan::MeshRange;
+static auto generate_texture(std::size_t, uint32_t) -> std::vector<unsigned char>;
+static auto find_texture_variants(const std::string&) -> std::vector<vulkan::TextureVariant>;
 
 namespace vulkan {
 
 // ---- Main Application Pipeline ----
+VulkanApplication::VulkanApplication(ApplicationConfig config): config(config) {}
+
 auto VulkanApplication::run(void) -> void {
   init_window();
   init_vulkan();
@@ -160,6 +192,12 @@ auto VulkanApplication::run(void) -> void {
 }
 
 auto VulkanApplication::init_window(void) -> void {
+  // nothing to open; nothing in the headless path touches glfw
+  if(config.headless) {
+    window = nullptr;
+    return;
+  }
+
   glfwInit();
 
   glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
@@ -192,34 +230,14 @@ auto VulkanApplication::init_window(void) -> void {
       glfwSetWindowShouldClose(window, true);
   });
 
-  // move main_camera
+  // capture the next frames to a chrome trace; callbacks run inside glfwPollEvents on the render thread
   add_key_callback([](GLFWwindow* window, int key, int scancode, int action, int mods){
-    const auto app = reinterpret_cast<VulkanApplication*>(glfwGetWindowUserPointer(window));
-    auto& camera = app->main_camera;
-    auto delta_time = app->glfw_delta_time;
-
-    float camera_move_speed = 20.0f;
-
-    if(glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-      camera.move({0.0f, 0.0f, camera_move_speed * delta_time});
-
-    if(glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-      camera.move({camera_move_speed * delta_time, 0.0f, 0.0f});
-
-    if(glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-      camera.move({0.0f, 0.0f, -camera_move_speed * delta_time});
-
-    if(glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-      camera.move({-camera_move_speed * delta_time, 0.0f, 0.0f});
-
-    // y-axis is inverted compared to OpenGL
-    if(glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
-      camera.move({0.0f, -1*camera_move_speed * delta_time, 0.0f});
-
-    if(glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
-      camera.move({0.0f, -1*-camera_move_speed * delta_time, 0.0f});
+    if(key == GLFW_KEY_F12 && action == GLFW_PRESS)
+      reinterpret_cast<VulkanApplication*>(glfwGetWindowUserPointer(window))->trace_requested = true;
   });
 
+  // main_camera is moved by the simulation thread, from the keys sampled in sample_input
+
   // set cursor position
   add_cursor_callback([](GLFWwindow* window, double x_pos, double y_pos){
     auto& [current_x, current_y] = reinterpret_cast<VulkanApplication*>(glfwGetWindowUserPointer(window))->cursor_pos;
@@ -229,62 +247,174 @@ auto VulkanApplication::init_window(void) -> void {
 }
 
 auto VulkanApplication::init_vulkan(void) -> void {
+  auto init_start = std::chrono::high_resolution_clock::now();
+
   // creation order matters, as some functions are reliant on class members that must be initialized prior
+  create_job_system();
+  decode_texture_image(); // runs on a job while the device is brought up
   create_instance();
   setup_debug_messenger();
   create_surface();
   pick_physical_device();
   create_logical_device();
-  create_swap_chain();
+  create_allocator();
+  create_pipeline_cache();
+  create_swap_chain(); // or offscreen images, when headless
   create_image_views();
+  create_depth_resources();
   create_render_pass();
   create_descriptor_set_layout();
-  create_descriptor_pool();
-  create_graphics_pipeline();
+  create_descriptor_allocator();
+  create_bindless_table();
+  create_pipeline_layout();
+  create_graphics_pipeline(); // compiles on the worker pool while the resources below load
   create_framebuffers();
   create_command_pool();
-  create_texture_image();
-  create_texture_image_view();
+  create_upload_context();
+  upload_start = std::chrono::high_resolution_clock::now();
+  create_texture_images();
+  create_texture_image_views();
   create_texture_sampler();
-  create_vertex_buffer();
-  create_index_buffer();
+  create_mesh_buffers();
+  assets.destroy(); // everything in the pack has been staged
+  create_scene();
+  // everything loaded above goes out in one submit; no need to wait on it, the batch ends in
+  // barriers that order it before the first frame on the same queue
+  upload_ticket = uploader.submit();
   create_uniform_buffers();
   create_descriptor_sets(); // created with other descriptor stuff for coherence, but relies on uniforms created above
   create_command_buffers();
   create_sync_objects();
+  create_readback();
+  create_gpu_profiler();
+  create_shader_watcher();
+
+  // the first frame cannot draw anything without it; by now it has mostly overlapped with loading
+  pipelines.wait(graphics_pipeline);
+
+  // compare a first launch (or after a driver update) with the next one to see what the cache saves
+  auto init_end = std::chrono::high_resolution_clock::now();
+  std::cout << "[pipeline] " << (pipeline_cache.is_warm() ? "warm" : "cold") << " cache: "
+            << pipelines.compile_milliseconds(graphics_pipeline) << "ms compiling the graphics pipeline, "
+            << std::chrono::duration<double, std::milli>(init_end - init_start).count() << "ms in init_vulkan\n";
 }
 
 auto VulkanApplication::main_loop(void) -> void {
-  while(!glfwWindowShouldClose(window)) {
-    glfwPollEvents();
-    update_glfw_delta_time();
-    draw_frame();
+  cpu_profiler::set_thread_name("render");
+  start_simulation();
+  if(config.trace_frames != 0)
+    trace_capture.start(config.trace_frames, config.trace_path);
+
+  frame_stats::Config stats_config{};
+  stats_config.hitch_milliseconds = config.hitch_milliseconds;
+  stats_config.report_interval = config.stats_interval;
+  stats_config.csv_path = config.stats_csv_path;
+  frame_stats = frame_stats::FrameStats{};
+  frame_stats.create(stats_config);
+
+  std::size_t frame = 0;
+  auto loop_start = std::chrono::high_resolution_clock::now();
+  try {
+    for(; !should_close(); ++frame) {
+      if(config.frame_limit != 0 && frame >= config.frame_limit) break;
+
+      auto frame_begin = cpu_profiler::now_nanoseconds();
+      {
+        auto frame_scope = cpu_profiler::Scope("frame");
+        if(!config.headless) {
+          auto poll_phase = frame_stats::Phase(frame_stats, "poll_events");
+          glfwPollEvents();
+          sample_input();
+        }
+        update_glfw_delta_time();
+        draw_frame(); // renders the latest snapshot, never waits for the simulation
+      }
+      frame_stats.end_frame(cpu_profiler::now_nanoseconds() - frame_begin);
+
+      // frame boundary; a finished capture is written here, a requested one starts with the next frame
+      trace_capture.frame();
+      if(trace_requested && !trace_capture.active())
+        trace_capture.start(config.trace_frames != 0 ? config.trace_frames : DEFAULT_TRACE_FRAMES, config.trace_path);
+      trace_requested = false;
+    }
+  } catch(...) {
+    stop_simulation();
+    frame_stats.destroy();
+    throw;
   }
-  vkDeviceWaitIdle(device);
+
+  stop_simulation();
+  trace_capture.finish(); // the loop ended before the capture did
+  frame_stats.report(std::cout);
+  frame_stats.destroy(); // writes out the partial last interval
+  vkDeviceWaitIdle(device); // the last frames count as rendered only once the gpu is done with them
+  memory_at_exit = allocator.total_stats();
+
+  auto loop_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - loop_start).count();
+  loop_frames_per_second = loop_seconds > 0.0 ? static_cast<double>(frame) / loop_seconds : 0.0;
+  std::cout << "[frames] " << frame << " frame(s) in " << loop_seconds * 1000.0 << "ms, " << loop_frames_per_second << " frames/s"
+            << (config.headless ? " (headless)" : "") << "\n";
+
+  if(simulation_error)
+    std::rethrow_exception(simulation_error);
 }
 
 auto VulkanApplication::cleanup(void) -> void {
+  texture_decoder.destroy(); // decodes still running are dropped, nothing streams in any more
+
+  // final state of the memory blocks, before anything is released
+  allocator.dump_stats(std::cout);
+  for(std::size_t i = 0; i < uniform_arenas.size(); ++i)
+    std::cout << "[memory] uniform arena " << i << ": high water " << uniform_arenas[i].high_water_mark() << " / " << uniform_arenas[i].capacity << " bytes\n";
+
+  gpu_profiler.report(std::cout);
+
   // vulkan cleanup
+  if(readback.enabled()) {
+    readback.destroy(); // the device is idle; exports the last frames still sitting in the ring
+    std::cout << "[readback] " << readback.frames_exported() << " frame(s) exported to " << config.export_path << "\n";
+  }
   cleanup_swap_chain();
 
+  std::cout << "[upload] " << uploader.submit_count() << " upload submit(s), " << uploader.bytes_staged() << " bytes staged\n";
+  for(auto& semaphores : upload_semaphores_in_flight)
+    uploader.recycle_semaphores(semaphores);
+  uploader.recycle_semaphores(frame_acquire.semaphores);
+  uploader.destroy(); // waits for anything still in flight
+
   vkDestroySampler(device, texture_sampler, nullptr);
-  vkDestroyImageView(device, texture_image_view, nullptr);
+  for(auto& texture : textures) {
+    vkDestroyImageView(device, texture.view, nullptr);
+    vkDestroyImage(device, texture.image, nullptr);
+    allocator.free(texture.memory);
+  }
+  vkDestroyImageView(device, placeholder_texture.view, nullptr);
+  vkDestroyImage(device, placeholder_texture.image, nullptr);
+  allocator.free(placeholder_texture.memory);
 
-  vkDestroyImage(device, texture_image, nullptr);
-  vkFreeMemory(device, texture_image_memory, nullptr);
+  for(std::size_t i = 0; i < offscreen_image_memory.size(); ++i) {
+    vkDestroyImage(device, swap_chain_images[i], nullptr);
+    allocator.free(offscreen_image_memory[i]);
+  }
 
   for(std::size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
     vkDestroyBuffer(device, uniform_buffers[i], nullptr);
-    vkFreeMemory(device, uniform_buffers_memory[i], nullptr);
+    allocator.free(uniform_buffers_memory[i]);
   }
-  vkDestroyDescriptorPool(device, descriptor_pool, nullptr);
-  vkDestroyDescriptorSetLayout(device, descriptor_set_layout, nullptr);
+  std::cout << "[descriptors] " << descriptor_set_cache.size() << " set(s) cached (" << descriptor_set_cache.hits() << " hit(s)) in "
+            << descriptor_allocator.pool_count() << " pool(s)\n";
+  if(bindless_capacity != 0)
+    std::cout << "[bindless] " << texture_slots.high_water_mark() << " of " << bindless_capacity << " texture slot(s) written\n";
+  descriptor_set_cache.destroy();
+  descriptor_allocator.destroy(); // frees every cached set
+  bindless_allocator.destroy(); // frees bindless_set
+  descriptor_layouts.destroy();
 
   vkDestroyBuffer(device, vertex_buffer, nullptr);
-  vkFreeMemory(device, vertex_buffer_memory, nullptr);
+  allocator.free(vertex_buffer_memory);
 
   vkDestroyBuffer(device, index_buffer, nullptr);
-  vkFreeMemory(device, index_buffer_memory, nullptr);
+  allocator.free(index_buffer_memory);
 
   for(std::size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
     vkDestroySemaphore(device, semaphores_image_available_render[i], nullptr);
@@ -292,7 +422,11 @@ auto VulkanApplication::cleanup(void) -> void {
     vkDestroyFence(device, fences_in_flight[i], nullptr);
   }
 
+  gpu_profiler.destroy();
   vkDestroyCommandPool(device, command_pool, nullptr);
+  for(auto pool : record_command_pools)
+    vkDestroyCommandPool(device, pool, nullptr); // frees the secondary command buffers
+  jobs.reset();
 
   // SO; WEIRD THING HAPPENS WITH LAYERS ON SOME ANDROID/WINDOWS DEVICES (AFAIK)
   // when validation layers are enabled, it can cause an error to pop up regarding
@@ -300,21 +434,27 @@ auto VulkanApplication::cleanup(void) -> void {
   // 3 objects below this comment). when validations layers are disabled, the
   // warning goes away.
   // per; https://stackoverflow.com/questions/61273270/vulkan-validation-error-for-each-objects-when-destroying-device-despite-their-d
-  vkDestroyPipeline(device, graphics_pipeline, nullptr);
+  shader_changes.destroy(); // stop queueing rebuilds before the pipelines go away
+  pipelines.destroy(); // waits for builds still running on the worker pool
   vkDestroyPipelineLayout(device, pipeline_layout, nullptr);
   vkDestroyRenderPass(device, render_pass, nullptr);
 
+  pipeline_cache.destroy(); // written back to disk for the next launch
+  allocator.destroy(); // all resources must be gone before their memory is
   vkDestroyDevice(device, nullptr);
 
-  if(enable_validation_layers)
+  if(config.validation)
     destroy_debug_utils_messenger_ext(instance, debug_messenger, nullptr);
 
-  vkDestroySurfaceKHR(instance, surface, nullptr);
+  if(!config.headless)
+    vkDestroySurfaceKHR(instance, surface, nullptr);
   vkDestroyInstance(instance, nullptr);
 
   // glfw cleanup
-  glfwDestroyWindow(window);
-  glfwTerminate();
+  if(!config.headless) {
+    glfwDestroyWindow(window);
+    glfwTerminate();
+  }
 }
 // ---- End of Main Application Pipeline ----
 
@@ -331,8 +471,39 @@ auto VulkanApplication::add_cursor_callback(CursorCallback cursor_callback) -> v
   cursor_callbacks.push_back(std::move(cursor_callback));
 }
 
+auto VulkanApplication::average_record_microseconds(void) const -> double {
+  return recorded_frames == 0 ? 0.0 : record_microseconds_total / static_cast<double>(recorded_frames);
+}
+
+auto VulkanApplication::frames_per_second(void) const -> double {
+  return loop_frames_per_second;
+}
+
+auto VulkanApplication::gpu_timings(void) const -> const std::vector<gpu_profiler::ScopeStats>& {
+  return gpu_profiler.scopes();
+}
+
+auto VulkanApplication::frame_statistics(void) const -> const frame_stats::FrameStats& {
+  return frame_stats;
+}
+
+auto VulkanApplication::upload_milliseconds(void) const -> double {
+  return upload_duration.value_or(0.0);
+}
+
+auto VulkanApplication::memory_usage(void) const -> const memory::BlockStats& {
+  return memory_at_exit;
+}
+
+auto VulkanApplication::create_job_system(void) -> void {
+  jobs = std::make_unique<job_system::JobSystem>(config.worker_threads);
+  std::cout << "[jobs] " << jobs->size() << " worker(s)\n";
+  // decodes run for milliseconds each, off the frame job system so they never delay a frame's jobs
+  decode_pool = std::make_unique<thread_pool::ThreadPool>(config.decode_threads);
+}
+
 auto VulkanApplication::create_instance(void) -> void {
-  if(enable_validation_layers && !check_validation_layer_support())
+  if(config.validation && !check_validation_layer_support())
     throw std::runtime_error("Error - validation layers requested, but unavailable");
 
   VkApplicationInfo app_info{};
@@ -341,19 +512,19 @@ auto VulkanApplication::create_instance(void) -> void {
   app_info.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
   app_info.pEngineName = "No Engine";
   app_info.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-  app_info.apiVersion = VK_API_VERSION_1_0;
+  app_info.apiVersion = config.bindless ? VK_API_VERSION_1_2 : VK_API_VERSION_1_0; // descriptor indexing is core in 1.2
 
   VkInstanceCreateInfo create_info{};
   create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
   create_info.pApplicationInfo = &app_info;
 
-  auto extensions = message_callback_get_required_extensions();
+  auto extensions = message_callback_get_required_extensions(!config.headless, config.validation);
   create_info.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
   create_info.ppEnabledExtensionNames = extensions.data();
   create_info.enabledLayerCount = 0;
 
   VkDebugUtilsMessengerCreateInfoEXT debug_create_info{};
-  if(enable_validation_layers) {
+  if(config.validation) {
     create_info.enabledLayerCount = static_cast<uint32_t>(validation_layers.size());
     create_info.ppEnabledLayerNames = validation_layers.data();
     populate_debug_messenger_create_info(debug_create_info);
@@ -369,7 +540,7 @@ auto VulkanApplication::create_instance(void) -> void {
 }
 
 auto VulkanApplication::setup_debug_messenger(void) -> void {
-  if(!enable_validation_layers) return;
+  if(!config.validation) return;
 
   VkDebugUtilsMessengerCreateInfoEXT create_info{};
   populate_debug_messenger_create_info(create_info);
@@ -402,7 +573,12 @@ auto VulkanApplication::create_logical_device(void) -> void {
   QueueFamilyIndices indices = find_queue_families(physical_device);
 
   std::vector<VkDeviceQueueCreateInfo> queue_create_infos{};
-  auto unique_queue_families = std::set<uint32_t>{indices.graphics_family.value(), indices.present_family.value()};
+  auto unique_queue_families = std::set<uint32_t>{
+    indices.graphics_family.value(), 
+    indices.present_family.value(), 
+    indices.transfer_family.value(), 
+    indices.compute_family.value()
+  };
 
   auto queue_priority = 1.f;
   for(const auto queue_family : unique_queue_families) {
@@ -414,21 +590,46 @@ auto VulkanApplication::create_logical_device(void) -> void {
     queue_create_infos.push_back(queue_create_info);
   }
 
+  VkPhysicalDeviceFeatures supported_features{};
+  vkGetPhysicalDeviceFeatures(physical_device, &supported_features);
+
   VkPhysicalDeviceFeatures device_features{};
   device_features.samplerAnisotropy = VK_TRUE; // anisotropic filtering enabled!
+  // whichever compressed families exist, so ktx2 variants in any of them can be sampled
+  device_features.textureCompressionBC = supported_features.textureCompressionBC;
+  device_features.textureCompressionETC2 = supported_features.textureCompressionETC2;
+  device_features.textureCompressionASTC_LDR = supported_features.textureCompressionASTC_LDR;
 
   VkDeviceCreateInfo create_info{};
   create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 
+  // the texture array is indexed with a push constant (dynamically uniform), written while bound,
+  // and only has the slots of uploaded textures written
+  VkPhysicalDeviceDescriptorIndexingFeatures indexing_features{};
+  indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+  bindless_capacity = config.bindless ? query_bindless_capacity() : 0;
+  if(bindless_capacity != 0) {
+    device_features.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+    indexing_features.runtimeDescriptorArray = VK_TRUE;
+    indexing_features.descriptorBindingPartiallyBound = VK_TRUE;
+    indexing_features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    indexing_features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    create_info.pNext = &indexing_features;
+    std::cout << "[bindless] " << bindless_capacity << " texture slots\n";
+  } else if(config.bindless) {
+    std::cout << "[bindless] descriptor indexing is not supported, using a descriptor set per material\n";
+  }
+
   create_info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
   create_info.pQueueCreateInfos = queue_create_infos.data();
 
   create_info.pEnabledFeatures = &device_features;
 
-  create_info.enabledExtensionCount = static_cast<uint32_t>(device_extensions.size());
-  create_info.ppEnabledExtensionNames = device_extensions.data();
+  // nothing is presented when headless, so the swap chain extension is not needed (or required)
+  create_info.enabledExtensionCount = config.headless ? 0 : static_cast<uint32_t>(device_extensions.size());
+  create_info.ppEnabledExtensionNames = config.headless ? nullptr : device_extensions.data();
 
-  if(enable_validation_layers) {
+  if(config.validation) {
     create_info.enabledLayerCount = static_cast<uint32_t>(validation_layers.size());
     create_info.ppEnabledLayerNames = validation_layers.data();
   } else {
@@ -440,14 +641,78 @@ auto VulkanApplication::create_logical_device(void) -> void {
 
   vkGetDeviceQueue(device, indices.graphics_family.value(), 0, &graphics_queue);
   vkGetDeviceQueue(device, indices.present_family.value(), 0, &present_queue);
+  // may be the same queue as graphics_queue when the device has no separate family
+  vkGetDeviceQueue(device, indices.transfer_family.value(), 0, &transfer_queue);
+  vkGetDeviceQueue(device, indices.compute_family.value(), 0, &compute_queue);
+
+  graphics_family_index = indices.graphics_family.value();
+  transfer_family_index = indices.transfer_family.value();
+  compute_family_index = indices.compute_family.value();
+}
+
+// slots the bindless texture array can have on physical_device, 0 when it lacks any feature it needs
+auto VulkanApplication::query_bindless_capacity(void) -> uint32_t {
+  VkPhysicalDeviceProperties properties{};
+  vkGetPhysicalDeviceProperties(physical_device, &properties);
+  if(properties.apiVersion < VK_API_VERSION_1_2) return 0;
+
+  VkPhysicalDeviceDescriptorIndexingFeatures indexing_features{};
+  indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+  VkPhysicalDeviceFeatures2 features{};
+  features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  features.pNext = &indexing_features;
+  vkGetPhysicalDeviceFeatures2(physical_device, &features);
+
+  if(!features.features.shaderSampledImageArrayDynamicIndexing
+      || !indexing_features.runtimeDescriptorArray
+      || !indexing_features.descriptorBindingPartiallyBound
+      || !indexing_features.descriptorBindingSampledImageUpdateAfterBind
+      || !indexing_features.descriptorBindingUpdateUnusedWhilePending)
+    return 0;
+
+  // a combined image sampler counts as both a sampled image and a sampler
+  VkPhysicalDeviceDescriptorIndexingProperties indexing_properties{};
+  indexing_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+  VkPhysicalDeviceProperties2 properties2{};
+  properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  properties2.pNext = &indexing_properties;
+  vkGetPhysicalDeviceProperties2(physical_device, &properties2);
+
+  return std::min({
+    MAX_BINDLESS_TEXTURES,
+    indexing_properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+    indexing_properties.maxPerStageDescriptorUpdateAfterBindSamplers,
+    indexing_properties.maxPerStageUpdateAfterBindResources,
+    indexing_properties.maxDescriptorSetUpdateAfterBindSampledImages,
+    indexing_properties.maxDescriptorSetUpdateAfterBindSamplers
+  });
+}
+
+auto VulkanApplication::create_allocator(void) -> void {
+  allocator.create(physical_device, device);
+}
+
+auto VulkanApplication::create_pipeline_cache(void) -> void {
+  pipeline_cache.create(physical_device, device, PIPELINE_CACHE_PATH);
+  pipelines.create(device, pipeline_cache.handle(), worker_pool, MAX_FRAMES_IN_FLIGHT);
 }
 
 auto VulkanApplication::create_surface(void) -> void {
+  if(config.headless) {
+    surface = VK_NULL_HANDLE;
+    return;
+  }
+
   if(glfwCreateWindowSurface(instance, window, nullptr, &surface) != VK_SUCCESS)
     throw std::runtime_error("Error - failed to create window surface");
 }
 
 auto VulkanApplication::create_swap_chain(void) -> void {
+  if(config.headless) {
+    create_offscreen_images();
+    return;
+  }
+
   auto swap_chain_support = query_swap_chain_support(physical_device);
 
   VkSurfaceFormatKHR surface_format = choose_swap_surface_format(swap_chain_support.formats);
@@ -470,6 +735,11 @@ auto VulkanApplication::create_swap_chain(void) -> void {
   create_info.imageExtent = extent;
   create_info.imageArrayLayers = 1;
   create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+  if(config.export_format != readback::ExportFormat::None) {
+    if(!(swap_chain_support.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT))
+      throw std::runtime_error("Error - swap chain images cannot be copied from, frame export needs --headless");
+    create_info.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT; // copied out by readback
+  }
 
   QueueFamilyIndices indices = find_queue_families(physical_device);
   uint32_t queue_family_indices[] = {indices.graphics_family.value(), indices.present_family.value()};
@@ -501,6 +771,27 @@ auto VulkanApplication::create_swap_chain(void) -> void {
   swap_chain_extent = extent;
 }
 
+// stands in for the swap chain; frame n always renders into image n % MAX_FRAMES_IN_FLIGHT, which
+// that frame's fence already protects, so there is nothing to acquire
+auto VulkanApplication::create_offscreen_images(void) -> void {
+  swap_chain_image_format = OFFSCREEN_FORMAT;
+  swap_chain_extent = {static_cast<uint32_t>(WIDTH), static_cast<uint32_t>(HEIGHT)};
+
+  swap_chain_images.resize(MAX_FRAMES_IN_FLIGHT);
+  offscreen_image_memory.resize(MAX_FRAMES_IN_FLIGHT);
+  for(std::size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+    create_image(
+      swap_chain_extent.width, swap_chain_extent.height, 1,
+      swap_chain_image_format,
+      VK_IMAGE_TILING_OPTIMAL,
+      VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, // copied out by readback
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      swap_chain_images[i],
+      offscreen_image_memory[i]
+    );
+  }
+}
+
 auto VulkanApplication::create_image_views(void) -> void {
   auto image_count = swap_chain_images.size();
   swap_chain_image_views.resize(image_count);
@@ -510,7 +801,27 @@ auto VulkanApplication::create_image_views(void) -> void {
   }
 }
 
+auto VulkanApplication::create_depth_resources(void) -> void {
+  depth_format = find_depth_format();
+
+  create_image(
+    swap_chain_extent.width, swap_chain_extent.height, 1,
+    depth_format,
+    VK_IMAGE_TILING_OPTIMAL,
+    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+    depth_image,
+    depth_image_memory
+  );
+  depth_image_view = create_image_view(depth_image, depth_format, VK_IMAGE_ASPECT_DEPTH_BIT);
+}
+
+// the colour attachment is drawn in the last subpass; with the depth pre-pass, subpass 0 only
+// writes depth and the colour subpass after it tests against that with depth writes off
 auto VulkanApplication::create_render_pass(void) -> void {
+  subpass_count = config.depth_prepass ? 2 : 1;
+  auto colour_subpass = subpass_count - 1;
+
   VkAttachmentDescription colour_attachment{};
   colour_attachment.format = swap_chain_image_format;
   colour_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
@@ -519,20 +830,41 @@ auto VulkanApplication::create_render_pass(void) -> void {
   colour_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
   colour_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
   colour_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-  colour_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+  // offscreen images are never presented (the layout needs the swap chain extension), only copied out
+  colour_attachment.finalLayout = config.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+  // cleared every frame and never read after the render pass, so it is never stored
+  VkAttachmentDescription depth_attachment{};
+  depth_attachment.format = depth_format;
+  depth_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+  depth_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+  depth_attachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  depth_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+  depth_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+  depth_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  depth_attachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
   VkAttachmentReference colour_attachment_ref{};
   colour_attachment_ref.attachment = 0;
   colour_attachment_ref.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
-  VkSubpassDescription subpass{};
-  subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-  subpass.colorAttachmentCount = 1;
-  subpass.pColorAttachments = &colour_attachment_ref;
+  VkAttachmentReference depth_attachment_ref{};
+  depth_attachment_ref.attachment = 1;
+  depth_attachment_ref.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+  std::array<VkSubpassDescription, 2> subpasses{};
+  subpasses[0].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS; // the pre-pass, depth only, when there is one
+  subpasses[0].pDepthStencilAttachment = &depth_attachment_ref;
 
-  VkSubpassDependency dependency{};
+  subpasses[colour_subpass].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+  subpasses[colour_subpass].colorAttachmentCount = 1;
+  subpasses[colour_subpass].pColorAttachments = &colour_attachment_ref;
+  subpasses[colour_subpass].pDepthStencilAttachment = &depth_attachment_ref;
+
+  std::array<VkSubpassDependency, 4> dependencies{};
+  auto& dependency = dependencies[0];
   dependency.srcSubpass = VK_SUBPASS_EXTERNAL; // VK_SUBPASS_EXTERNAL refers to implicit subpasses
-  dependency.dstSubpass = 0; // refers to our subpass, which is first and only one
+  dependency.dstSubpass = colour_subpass; // refers to the subpass that draws the colour
   dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT; // operation to wait on
   dependency.srcAccessMask = 0; // stages in which the operation occurs
   // wait for the swap chain to finish reading from the image before can access it
@@ -540,25 +872,64 @@ auto VulkanApplication::create_render_pass(void) -> void {
   dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT; 
   dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
+  // the previous frame's depth tests must be done before this frame clears the shared depth image
+  auto& depth_dependency = dependencies[1];
+  depth_dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+  depth_dependency.dstSubpass = 0;
+  depth_dependency.srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+  depth_dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+  depth_dependency.dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+  depth_dependency.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+  uint32_t dependency_count = 2;
+
+  if(config.depth_prepass) {
+    // the pre-pass's depth writes are visible to the colour subpass's tests, per pixel
+    auto& prepass_dependency = dependencies[dependency_count++];
+    prepass_dependency.srcSubpass = 0;
+    prepass_dependency.dstSubpass = colour_subpass;
+    prepass_dependency.srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    prepass_dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    prepass_dependency.dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    prepass_dependency.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+    prepass_dependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+  }
+
+  if(config.export_format != readback::ExportFormat::None) {
+    // readback copies the image straight after the render pass; the implicit external dependency
+    // only orders the final layout transition before bottom of pipe, which the copy cannot chain onto
+    auto& readback_dependency = dependencies[dependency_count++];
+    readback_dependency.srcSubpass = colour_subpass;
+    readback_dependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+    readback_dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    readback_dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    readback_dependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    readback_dependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+  }
+
+  std::array<VkAttachmentDescription, 2> attachments = {colour_attachment, depth_attachment};
+
   VkRenderPassCreateInfo render_pass_info{};
   render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-  render_pass_info.attachmentCount = 1;
-  render_pass_info.pAttachments = &colour_attachment;
-  render_pass_info.subpassCount = 1;
-  render_pass_info.pSubpasses = &subpass;
-  render_pass_info.dependencyCount = 1;
-  render_pass_info.pDependencies = &dependency;
+  render_pass_info.attachmentCount = static_cast<uint32_t>(attachments.size());
+  render_pass_info.pAttachments = attachments.data();
+  render_pass_info.subpassCount = subpass_count;
+  render_pass_info.pSubpasses = subpasses.data();
+  render_pass_info.dependencyCount = dependency_count;
+  render_pass_info.pDependencies = dependencies.data();
 
   if(vkCreateRenderPass(device, &render_pass_info, nullptr, &render_pass) != VK_SUCCESS)
     throw std::runtime_error("Error - failed to create render pass");
 }
 
 auto VulkanApplication::create_descriptor_set_layout(void) -> void {
+  descriptor_layouts.create(device);
+
   // uniform bindings
   VkDescriptorSetLayoutBinding ubo_layout_binding{};
   ubo_layout_binding.binding = 0; // *** layout(binding = 0)
   ubo_layout_binding.descriptorCount = 1; // number of values in the array (only 1 struct in the shader)
-  ubo_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  // dynamic, so the offset into the frame's uniform arena is supplied at bind time
+  ubo_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
   ubo_layout_binding.pImmutableSamplers = nullptr;
   ubo_layout_binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; // could also be VK_SHADER_STAGE_ALL_GRAPHICS
 
@@ -570,330 +941,441 @@ auto VulkanApplication::create_descriptor_set_layout(void) -> void {
   sampler_layout_binding.pImmutableSamplers = nullptr;
   sampler_layout_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-  std::array<VkDescriptorSetLayoutBinding, 2> bindings = {ubo_layout_binding, sampler_layout_binding};
+  // bindless textures live in their own set
+  if(bindless_capacity != 0)
+    descriptor_set_layout = descriptor_layouts.get(descriptors::make_layout_key({ubo_layout_binding}));
+  else
+    descriptor_set_layout = descriptor_layouts.get(descriptors::make_layout_key({ubo_layout_binding, sampler_layout_binding}));
+}
+
+// sized for a set per material per frame in flight to begin with; grows by chaining pools should
+// more sets be needed, e.g. as streamed textures give materials new sets
+auto VulkanApplication::create_descriptor_allocator(void) -> void {
+  auto sets_per_frame = bindless_capacity != 0 ? 1 : std::max<std::size_t>(config.scene_materials, 1);
+  auto initial_sets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT * sets_per_frame);
 
-  VkDescriptorSetLayoutCreateInfo layout_info{};
-  layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-  layout_info.bindingCount = bindings.size();
-  layout_info.pBindings = bindings.data();
+  // bindings set in create_descriptor_set_layout
+  std::vector<descriptors::PoolRatio> ratios = {{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1}};
+  if(bindless_capacity == 0)
+    ratios.push_back({VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1});
 
-  if (vkCreateDescriptorSetLayout(device, &layout_info, nullptr, &descriptor_set_layout) != VK_SUCCESS)
-    throw std::runtime_error("Error - failed to create descriptor set layout");
+  descriptor_allocator.create(device, ratios, initial_sets);
+  descriptor_set_cache.create(device, descriptor_allocator);
 }
 
-auto VulkanApplication::create_descriptor_pool(void) -> void {
-  std::array<VkDescriptorPoolSize, 2> pool_sizes{};
-  pool_sizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER; // set binding in create_descriptor_set_layout
-  pool_sizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+// set 1 in bindless mode; one array of every texture, partially bound as only the slots handed out
+// are ever written, and update-after-bind so streamed textures can be written while it is bound
+auto VulkanApplication::create_bindless_table(void) -> void {
+  if(bindless_capacity == 0) return;
 
-  pool_sizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER; // set binding in create_descriptor_set_layout
-  pool_sizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+  VkDescriptorSetLayoutBinding textures_binding{};
+  textures_binding.binding = 0;
+  textures_binding.descriptorCount = bindless_capacity;
+  textures_binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  textures_binding.pImmutableSamplers = nullptr;
+  textures_binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-  VkDescriptorPoolCreateInfo pool_info{};
-  pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-  pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
-  pool_info.pPoolSizes = pool_sizes.data();
-  pool_info.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+  VkDescriptorBindingFlags binding_flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+                                         | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+                                         | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+  bindless_set_layout = descriptor_layouts.get(descriptors::make_layout_key({textures_binding}, {binding_flags}, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT));
 
-  if(vkCreateDescriptorPool(device, &pool_info, nullptr, &descriptor_pool) != VK_SUCCESS)
-    throw std::runtime_error("Error - failed to create descriptor pool");
+  bindless_allocator.create(device, {{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, bindless_capacity}}, 1, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
+  bindless_set = bindless_allocator.allocate(bindless_set_layout);
+
+  texture_slots = bindless::SlotAllocator(bindless_capacity, MAX_FRAMES_IN_FLIGHT);
 }
 
+// materials sampling the same texture share their sets, through descriptor_set_cache
 auto VulkanApplication::create_descriptor_sets(void) -> void {
-  descriptor_sets.resize(MAX_FRAMES_IN_FLIGHT);
-
-  std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptor_set_layout);
+  auto materials = bindless_capacity != 0 ? 1 : material_textures.size();
+  descriptor_sets.resize(MAX_FRAMES_IN_FLIGHT * materials);
+
+  // the textures already uploaded go into the bindless array, the rest as they stream in
+  if(bindless_capacity != 0) {
+    placeholder_texture.slot = write_texture_slot(placeholder_texture.view);
+    for(auto& texture : textures) {
+      if(texture.ready)
+        texture.slot = write_texture_slot(texture.view);
+    }
+  }
 
-  VkDescriptorSetAllocateInfo alloc_info{};
-  alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-  alloc_info.descriptorPool = descriptor_pool;
-  alloc_info.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT); // must be size of descriptor_sets
-  alloc_info.pSetLayouts = layouts.data();
-  
-  if(vkAllocateDescriptorSets(device, &alloc_info, descriptor_sets.data()) != VK_SUCCESS)
-    throw std::runtime_error("failed to allocate descriptor sets!");
+  for(std::size_t i = 0; i < descriptor_sets.size(); ++i)
+    descriptor_sets[i] = material_set(static_cast<uint32_t>(i / materials), material_textures[i % materials]);
 
-  for(std::size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-    VkDescriptorBufferInfo buffer_info{};
-    buffer_info.buffer = uniform_buffers[i];
-    buffer_info.offset = 0;
-    buffer_info.range = sizeof(UniformBufferObject);
+  std::cout << "[descriptors] " << descriptor_set_cache.size() << " set(s) shared by " << descriptor_sets.size() << " material slot(s), "
+            << descriptor_layouts.size() << " layout(s)\n";
+}
 
-    VkDescriptorImageInfo image_info{};
-    image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    image_info.imageView = texture_image_view;
-    image_info.sampler = texture_sampler;
+// the frame's uniform arena and, unless bindless, the texture; written once and cached, so the
+// set for a frame and texture is only ever allocated the first time it is asked for
+auto VulkanApplication::material_set(uint32_t frame, uint32_t texture) -> VkDescriptorSet {
+  descriptors::SetKey key{};
+  key.layout = descriptor_set_layout;
+
+  descriptors::SetWrite uniforms{};
+  uniforms.binding = 0;
+  uniforms.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+  uniforms.buffer = uniform_buffers[frame];
+  uniforms.offset = 0;
+  // window seen by the shader, moved by the dynamic offset
+  uniforms.range = push_transforms ? sizeof(UniformBufferObject) : sizeof(ObjectUniformBufferObject);
+  key.writes.push_back(uniforms);
+
+  if(bindless_capacity == 0) {
+    descriptors::SetWrite image{};
+    image.binding = 1;
+    image.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    image.view = texture_view(texture);
+    image.sampler = texture_sampler;
+    image.image_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    key.writes.push_back(image);
+  }
 
-    std::array<VkWriteDescriptorSet, 2> descriptor_writes{};
-    descriptor_writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptor_writes[0].dstSet = descriptor_sets[i];
-    descriptor_writes[0].dstBinding = 0;
-    descriptor_writes[0].dstArrayElement = 0;
-    descriptor_writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    descriptor_writes[0].descriptorCount = 1;
-    descriptor_writes[0].pBufferInfo = &buffer_info;
+  return descriptor_set_cache.get(key);
+}
 
-    descriptor_writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptor_writes[1].dstSet = descriptor_sets[i];
-    descriptor_writes[1].dstBinding = 1;
-    descriptor_writes[1].dstArrayElement = 0;
-    descriptor_writes[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    descriptor_writes[1].descriptorCount = 1;
-    descriptor_writes[1].pImageInfo = &image_info;
+auto VulkanApplication::create_pipeline_layout(void) -> void {
+  VkPipelineLayoutCreateInfo pipeline_layout_info{};
+  pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  std::array<VkDescriptorSetLayout, 2> set_layouts = {descriptor_set_layout, bindless_set_layout};
 
-    vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptor_writes.size()), descriptor_writes.data(), 0, nullptr);
+  // the model matrix of every draw, and the material's slot in the bindless array; one range for
+  // both stages, so a draw's constants go out in a single vkCmdPushConstants. every device has 128
+  // bytes, but should one have less the transforms go through the uniform arena instead
+  VkPhysicalDeviceProperties properties{};
+  vkGetPhysicalDeviceProperties(physical_device, &properties);
+  auto bindless = bindless_capacity != 0;
+  auto push_size = bindless ? DRAW_PUSH_SIZE : MODEL_PUSH_SIZE;
+  push_transforms = config.push_transforms && push_size <= properties.limits.maxPushConstantsSize;
+  if(config.push_transforms && !push_transforms)
+    std::cout << "[uniforms] " << properties.limits.maxPushConstantsSize << " bytes of push constants, transforms go through the uniform arena\n";
+
+  VkPushConstantRange push_constant_range{};
+  if(push_transforms) {
+    push_constant_range.stageFlags = bindless ? VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT : VK_SHADER_STAGE_VERTEX_BIT;
+    push_constant_range.offset = 0;
+    push_constant_range.size = push_size;
+  } else {
+    push_constant_range.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    push_constant_range.offset = TEXTURE_PUSH_OFFSET;
+    push_constant_range.size = sizeof(uint32_t);
   }
+
+  pipeline_layout_info.setLayoutCount = bindless ? 2 : 1;
+  pipeline_layout_info.pSetLayouts = set_layouts.data();
+  pipeline_layout_info.pushConstantRangeCount = push_transforms || bindless ? 1 : 0;
+  pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+
+  if(vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr, &pipeline_layout) != VK_SUCCESS)
+    throw std::runtime_error("Error - failed to create pipeline layout");
 }
 
+// queues the build on the worker pool and returns straight away; frames skip drawing until it is ready.
+// when called again (swap chain recreation) the current pipeline keeps being used until the rebuild lands
 auto VulkanApplication::create_graphics_pipeline(void) -> void {
-  // src/vulkan.cpp -> shaders/vert.spv & shaders/frag.spv
-  auto vertex_shader_bytecode   = read_file("../shaders/vert.spv");
-  auto fragment_shader_bytecode = read_file("../shaders/frag.spv");
+  // with the pre-pass, depth is already final by the colour subpass; testing it again without
+  // writing rejects every hidden fragment before it is shaded
+  auto colour_subpass = subpass_count - 1;
+  auto vertex_path = push_transforms ? VERTEX_SHADER_PATH : VERTEX_ARENA_SHADER_PATH;
+  auto fragment_path = bindless_capacity != 0 ? FRAGMENT_BINDLESS_SHADER_PATH : FRAGMENT_SHADER_PATH;
+  auto build = [device = device, layout = pipeline_layout, render_pass = render_pass, colour_subpass, depth_write = !config.depth_prepass, vertex_path, fragment_path](VkPipelineCache cache) {
+    return build_graphics_pipeline(device, cache, layout, render_pass, colour_subpass, depth_write, vertex_path, fragment_path);
+  };
 
-  auto vertex_shader = create_shader_module(device, vertex_shader_bytecode);
-  auto fragment_shader = create_shader_module(device, fragment_shader_bytecode);
+  if(graphics_pipeline == pipeline_manager::INVALID_PIPELINE)
+    graphics_pipeline = pipelines.request(build);
+  else
+    pipelines.replace(graphics_pipeline, build);
 
-  VkPipelineShaderStageCreateInfo vert_shader_stage_info{};
-  vert_shader_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-  vert_shader_stage_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
-  vert_shader_stage_info.module = vertex_shader;
-  vert_shader_stage_info.pName = "main"; // shader entry point -> can have different if so choose
+  if(!config.depth_prepass) return;
 
-  VkPipelineShaderStageCreateInfo frag_shader_stage_info{};
-  frag_shader_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-  frag_shader_stage_info.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-  frag_shader_stage_info.module = fragment_shader;
-  frag_shader_stage_info.pName = "main";
+  // no fragment shader, the pre-pass only writes depth
+  auto build_depth = [device = device, layout = pipeline_layout, render_pass = render_pass, vertex_path](VkPipelineCache cache) {
+    return build_graphics_pipeline(device, cache, layout, render_pass, 0, true, vertex_path, "");
+  };
 
-  VkPipelineShaderStageCreateInfo shader_stages[] = {vert_shader_stage_info, frag_shader_stage_info};
-  auto binding_description = VulkanVertex::get_vulkan_binding_description();
-  auto attribute_descriptions = VulkanVertex::get_vulkan_attribute_descriptions();
+  if(depth_pipeline == pipeline_manager::INVALID_PIPELINE)
+    depth_pipeline = pipelines.request(build_depth);
+  else
+    pipelines.replace(depth_pipeline, build_depth);
+}
 
-  VkPipelineVertexInputStateCreateInfo vertex_input_info{};
-  vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-  vertex_input_info.vertexBindingDescriptionCount = 1;
-  vertex_input_info.pVertexBindingDescriptions = &binding_description; // optional
-  vertex_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(attribute_descriptions.size());
-  vertex_input_info.pVertexAttributeDescriptions = attribute_descriptions.data(); // optional
+auto VulkanApplication::create_framebuffers(void) -> void {
+  swap_chain_framebuffers.resize(swap_chain_image_views.size());
 
-  VkPipelineInputAssemblyStateCreateInfo input_assembly{};
-  input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-  input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-  input_assembly.primitiveRestartEnable = VK_FALSE;
+  for(std::size_t i = 0; i < swap_chain_image_views.size(); i++) {
+    VkImageView attachments[] = { swap_chain_image_views[i], depth_image_view };
 
-  // both viewport and scissor are dynamic states
-  // would use the following setup if they were static states
-  /*
-  VkViewport viewport{};
-  viewport.x = 0.f;
-  viewport.y = 0.f;
-  viewport.width = (float) swap_chain_extent.width;
-  viewport.height = (float) swap_chain_extent.height;
-  viewport.minDepth = 0.f;
-  viewport.maxDepth = 1.f;
+    VkFramebufferCreateInfo framebuffer_info{};
+    framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebuffer_info.renderPass = render_pass;
+    framebuffer_info.attachmentCount = 2;
+    framebuffer_info.pAttachments = attachments;
+    framebuffer_info.width = swap_chain_extent.width;
+    framebuffer_info.height = swap_chain_extent.height;
+    framebuffer_info.layers = 1;
 
-  VkRect2D scissor{}; // truncates framebuffer to specified extent, can be a dynamic state
-  scissor.offset = {0, 0};
-  scissor.extent = swap_chain_extent; // cover entire framebuffer with scissor
+    if(vkCreateFramebuffer(device, &framebuffer_info, nullptr, &swap_chain_framebuffers[i]) != VK_SUCCESS)
+      throw std::runtime_error("Error - failed to create framebuffer");
+  }
+}
 
-  VkPipelineViewportStateCreateInfo viewport_state{};
-  viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-  viewport_state.viewportCount = 1;
-  viewport_state.pViewports = &viewport;
-  viewport_state.scissorCount = 1;
-  viewport_state.pScissors = &scissor;
-  */
-  VkPipelineViewportStateCreateInfo viewport_state{};
-  viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-  viewport_state.viewportCount = 1;
-  viewport_state.scissorCount = 1;
+auto VulkanApplication::create_command_pool(void) -> void {
+  QueueFamilyIndices queue_family_indices = find_queue_families(physical_device);
 
-  VkPipelineRasterizationStateCreateInfo rasterizer{};
-  rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-  rasterizer.depthClampEnable = VK_FALSE;
-  rasterizer.rasterizerDiscardEnable = VK_FALSE; // turning this on basically discards output to framebuffer
-  // fragment geometry generation
-  // can be;
-  // - VK_POLYGON_MODE_FILL
-  // - VK_POLYGON_MODE_LINE
-  // - VK_POLYGON_MODE_POINT
-  rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-  rasterizer.lineWidth = 1.0f; // 1 is max lineWidth without gpu feature
-  rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-  // front face counter clockwise, as glm y-coord representation of vertices passed as uniform must be inverted
-  rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE; //VK_FRONT_FACE_CLOCKWISE
-  rasterizer.depthBiasEnable = VK_FALSE; // allows to alter depth values
-  rasterizer.depthBiasConstantFactor = 0.0f; // optional
-  rasterizer.depthBiasClamp = 0.0f; // optional
-  rasterizer.depthBiasSlopeFactor = 0.0f; // optional
+  VkCommandPoolCreateInfo pool_info{};
+  pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  pool_info.queueFamilyIndex = queue_family_indices.graphics_family.value();
 
-  VkPipelineMultisampleStateCreateInfo multisampling{};
-  multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-  multisampling.sampleShadingEnable = VK_FALSE;
-  multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-  multisampling.minSampleShading = 1.0f; // optional
-  multisampling.pSampleMask = nullptr; // optional
-  multisampling.alphaToCoverageEnable = VK_FALSE; // optional
-  multisampling.alphaToOneEnable = VK_FALSE; // optional
+  if(vkCreateCommandPool(device, &pool_info, nullptr, &command_pool) != VK_SUCCESS)
+    throw std::runtime_error("Error - failed to create command pool");
+}
 
-  // depth and/or stencil buffer placeholder
+auto VulkanApplication::create_upload_context(void) -> void {
+  // uploads run on the transfer queue and are handed over to the graphics family, which is
+  // a no-op (no ownership transfer) when both are the same family
+  uploader.create(device, allocator, transfer_queue, transfer_family_index, graphics_family_index);
 
-  // combine fragment shader color with color already in framebuffer (single framebuffer example)
-  VkPipelineColorBlendAttachmentState color_blend_attachment{}; // VkPipelineColorBlendStateCreateInfo contains GLOBAL color blending settings
-  // entire setup looks like the following;
-  // if (blendEnable) {
-  //   final_colour.rgb = (srcColorBlendFactor * new_colour.rgb) <colorBlendOp> (dstColorBlendFactor * old_colour.rgb);
-  //   final_colour.a = (srcAlphaBlendFactor * new_colour.a) <alphaBlendOp> (dstAlphaBlendFactor * old_colour.a);
-  // } else {
-  //     final_colour = new_colour;
-  // }
-  // final_colour = final_colour & colorWriteMask;
-  // -------------------------------------------
-  // currently imitating alpha blending;
-  // final_color.rgb = new_alpha * new_color + (1 - new_alpha) * old_color;
-  // final_color.a = new_alpha.a;
-  color_blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-  color_blend_attachment.blendEnable = VK_TRUE;
-  color_blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-  color_blend_attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-  color_blend_attachment.colorBlendOp = VK_BLEND_OP_ADD;
-  color_blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-  color_blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-  color_blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
+  std::cout << "[upload] queue family " << transfer_family_index 
+            << (uploader.transfers_ownership() ? " (dedicated)" : " (shared with graphics)") << "\n";
+}
 
-  // references the array of structures for all of the framebuffers and allows to set 
-  // blend constants that can be used as blend factors in the above calculations
-  VkPipelineColorBlendStateCreateInfo color_blending{};
-  color_blending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-  color_blending.logicOpEnable = VK_FALSE;
-  color_blending.logicOp = VK_LOGIC_OP_COPY; // optional
-  color_blending.attachmentCount = 1;
-  color_blending.pAttachments = &color_blend_attachment;
-  color_blending.blendConstants[0] = 0.0f; // optional
-  color_blending.blendConstants[1] = 0.0f; // optional
-  color_blending.blendConstants[2] = 0.0f; // optional
-  color_blending.blendConstants[3] = 0.0f; // optional
+// reading the pack or the example texture's pre-compressed variant headers does not need the device, so
+// it overlaps with instance and device creation; everything that needs decoding is streamed in
+// from create_texture_images on, once it is known whether the gpu can build the mip chains
+auto VulkanApplication::decode_texture_image(void) -> void {
+  // a pack is mapped, its textures need no decoding and are staged straight from its pages
+  if(!config.asset_pack_path.empty()) {
+    jobs->spawn([this] {
+      auto start = std::chrono::high_resolution_clock::now();
+      assets.create(config.asset_pack_path);
+      std::cout << "[assets] " << config.asset_pack_path << ": " << assets.size() << " bytes, " << assets.bytes_copied() << " copied to open, "
+                << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() << " ms\n";
+    }, &texture_decode);
+    return;
+  }
 
-  std::vector<VkDynamicState> dynamic_states = {
-    VK_DYNAMIC_STATE_VIEWPORT,
-    VK_DYNAMIC_STATE_SCISSOR
-  };
+  if(config.scene_textures == 0)
+    jobs->spawn([this] { texture_variants = find_texture_variants(TEXTURE_PATH); }, &texture_decode);
+}
 
-  VkPipelineDynamicStateCreateInfo dynamic_state{};
-  dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-  dynamic_state.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
-  dynamic_state.pDynamicStates = dynamic_states.data();
+// every texture gets a full mip chain. pack textures and a pre-compressed variant the device can
+// sample are uploaded with the levels they were stored with, in the loading batch. anything else is
+// rgba8 that is decoded (or generated) on decode_pool and streamed in by stream_textures, sampled
+// as the placeholder until then; its mips are blitted on the gpu when the upload queue and format
+// allow it, otherwise box filtered on the decode thread
+auto VulkanApplication::create_texture_images(void) -> void {
+  jobs->wait(texture_decode);
+  if(!config.asset_pack_path.empty() && !assets.is_open())
+    throw std::runtime_error("Error - failed to load asset pack " + config.asset_pack_path);
+
+  // mid grey, sampled by every texture still being streamed in
+  const unsigned char grey[4] = {128, 128, 128, 255};
+  create_image(1, 1, 1, TEXTURE_FORMAT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, placeholder_texture.image, placeholder_texture.memory);
+  uploader.upload_image(placeholder_texture.image, grey, sizeof(grey), 1, 1);
+  placeholder_texture.ready = true;
+
+  if(assets.count(asset_pack::AssetType::Texture) != 0) {
+    create_pack_textures();
+    texture_stream_duration = 0.0; // nothing to stream
+    return;
+  }
 
-  VkPipelineLayoutCreateInfo pipeline_layout_info{};
-  pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-  pipeline_layout_info.setLayoutCount = 1;
-  pipeline_layout_info.pSetLayouts = &descriptor_set_layout;
-  pipeline_layout_info.pushConstantRangeCount = 0;
-
-  if(vkCreatePipelineLayout(device, &pipeline_layout_info, nullptr, &pipeline_layout) != VK_SUCCESS)
-    throw std::runtime_error("Error - failed to create pipeline layout");
-
-  VkGraphicsPipelineCreateInfo pipeline_info{};
-  pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-  pipeline_info.stageCount = 2;
-  pipeline_info.pStages = shader_stages;
-  pipeline_info.pVertexInputState = &vertex_input_info;
-  pipeline_info.pInputAssemblyState = &input_assembly;
-  pipeline_info.pViewportState = &viewport_state;
-  pipeline_info.pRasterizationState = &rasterizer;
-  pipeline_info.pMultisampleState = &multisampling;
-  pipeline_info.pDepthStencilState = nullptr; // optional
-  pipeline_info.pColorBlendState = &color_blending;
-  pipeline_info.pDynamicState = &dynamic_state;
-  pipeline_info.layout = pipeline_layout;
-  pipeline_info.renderPass = render_pass;
-  pipeline_info.subpass = 0;
+  blit_mipmaps = uploader.can_generate_mipmaps() && format_supports_linear_blit(TEXTURE_FORMAT);
+  texture_decoder.create(*decode_pool, !blit_mipmaps);
+  stream_start = std::chrono::high_resolution_clock::now();
 
-  if(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &graphics_pipeline) != VK_SUCCESS)
-    throw std::runtime_error("Error - failed to create graphics pipeline");
+  if(config.scene_textures != 0) {
+    textures.resize(config.scene_textures);
+    for(std::size_t i = 0; i < textures.size(); ++i) {
+      texture_decoder.request(i, [i, size = config.scene_texture_size] {
+        return texture_loader::Image{generate_texture(i, size), size, size, {}};
+      });
+    }
+  } else {
+    textures.resize(1);
+    std::optional<ktx::Texture> variant;
+    for(const auto& candidate : texture_variants) {
+      if(!format_supports_sampling(candidate.header.format)) continue;
+      try {
+        variant = ktx::load(candidate.path);
+        break;
+      } catch(const std::exception& e) {
+        std::cerr << "[texture] skipping " << candidate.path.string() << ": " << e.what() << "\n";
+      }
+    }
+    if(variant) {
+      auto& texture = textures[0];
+      texture.format = variant->format;
+      texture.mip_levels = static_cast<uint32_t>(variant->levels.size());
+
+      create_image(
+        variant->width, variant->height, texture.mip_levels,
+        texture.format,
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        texture.image,
+        texture.memory
+      );
+      uploader.upload_image_levels(texture.image, variant->data.data(), variant->data.size(), variant->levels);
+      texture.ready = true;
+    } else {
+      texture_decoder.request(0, TEXTURE_PATH);
+    }
+    texture_variants.clear();
+  }
 
-  vkDestroyShaderModule(device, vertex_shader, nullptr);
-  vkDestroyShaderModule(device, fragment_shader, nullptr);
+  std::cout << "[texture] " << textures.size() << " texture(s), " << texture_decoder.outstanding() << " streaming on "
+            << decode_pool->size() << " decode thread(s), mipmaps " << (blit_mipmaps ? "blitted on the gpu" : "generated on the cpu") << "\n";
 }
 
-auto VulkanApplication::create_framebuffers(void) -> void {
-  swap_chain_framebuffers.resize(swap_chain_image_views.size());
-
-  for(std::size_t i = 0; i < swap_chain_image_views.size(); i++) {
-    VkImageView attachments[] = { swap_chain_image_views[i] };
-
-    VkFramebufferCreateInfo framebuffer_info{};
-    framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-    framebuffer_info.renderPass = render_pass;
-    framebuffer_info.attachmentCount = 1;
-    framebuffer_info.pAttachments = attachments;
-    framebuffer_info.width = swap_chain_extent.width;
-    framebuffer_info.height = swap_chain_extent.height;
-    framebuffer_info.layers = 1;
-
-    if(vkCreateFramebuffer(device, &framebuffer_info, nullptr, &swap_chain_framebuffers[i]) != VK_SUCCESS)
-      throw std::runtime_error("Error - failed to create framebuffer");
+// cooked textures carry every mip level already, they are staged straight out of the pack
+auto VulkanApplication::create_pack_textures(void) -> void {
+  textures.clear();
+  for(const auto& entry : assets.entries()) {
+    if(entry.type != asset_pack::AssetType::Texture) continue;
+
+    auto& texture = textures.emplace_back();
+    texture.format = static_cast<VkFormat>(entry.format);
+    texture.mip_levels = entry.mip_levels;
+
+    create_image(
+      entry.width, entry.height, texture.mip_levels,
+      texture.format,
+      VK_IMAGE_TILING_OPTIMAL,
+      VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      texture.image,
+      texture.memory
+    );
+    uploader.upload_image_levels(texture.image, assets.data(entry), entry.size, asset_pack::texture_levels(entry));
+    texture.ready = true;
   }
+  std::cout << "[texture] " << textures.size() << " texture(s) from " << config.asset_pack_path << ", mipmaps cooked\n";
 }
 
-auto VulkanApplication::create_command_pool(void) -> void {
-  QueueFamilyIndices queue_family_indices = find_queue_families(physical_device);
-
-  VkCommandPoolCreateInfo pool_info{};
-  pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-  pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-  pool_info.queueFamilyIndex = queue_family_indices.graphics_family.value();
-
-  if(vkCreateCommandPool(device, &pool_info, nullptr, &command_pool) != VK_SUCCESS)
-    throw std::runtime_error("Error - failed to create command pool");
+// streamed textures get theirs once uploaded
+auto VulkanApplication::create_texture_image_views(void) -> void {
+  placeholder_texture.view = create_image_view(placeholder_texture.image, placeholder_texture.format);
+  for(auto& texture : textures) {
+    if(texture.image != VK_NULL_HANDLE)
+      texture.view = create_image_view(texture.image, texture.format, VK_IMAGE_ASPECT_COLOR_BIT, texture.mip_levels);
+  }
 }
 
-auto VulkanApplication::create_texture_image(void) -> void {
-  int tex_width, tex_height, tex_channels;
-  auto* pixels = stbi_load("../textures/example_a.jpg", &tex_width, &tex_height, &tex_channels, STBI_rgb_alpha);
-  VkDeviceSize image_size = tex_width * tex_height * 4;
-  
-  if(!pixels)
-    throw std::runtime_error("Error - failed to load texture image");
+// runs at the top of every frame, after its fence. decoded images are uploaded together in one batch,
+// up to STREAM_UPLOAD_BUDGET bytes a frame so a burst of decodes cannot stall the frame on staging
+// space; once a batch has landed its textures are sampled from the next frame recorded. no descriptor
+// a frame in flight may be reading is written: bindless textures take a fresh slot, otherwise the
+// materials move over to sets made for the new texture
+auto VulkanApplication::stream_textures(void) -> void {
+  if(bindless_capacity != 0)
+    texture_slots.next_frame(); // this frame's previous submission is done with anything freed back then
+  texture_decoder.take_completed(streamed_textures);
+
+  VkDeviceSize staged = 0;
+  auto first_swap = texture_swaps.size();
+  std::size_t taken = 0;
+  for(; taken < streamed_textures.size(); ++taken) {
+    auto& [id, image, error] = streamed_textures[taken];
+    if(!error.empty()) {
+      std::cerr << "[texture] " << error << ", keeping the placeholder\n";
+      continue;
+    }
+    if(staged != 0 && staged + image.pixels.size() > STREAM_UPLOAD_BUDGET) break;
+
+    auto& texture = textures[id];
+    texture.mip_levels = image.levels.empty() ? upload::mip_level_count(image.width, image.height) : static_cast<uint32_t>(image.levels.size());
+    create_image(
+      image.width, image.height, texture.mip_levels,
+      TEXTURE_FORMAT,
+      VK_IMAGE_TILING_OPTIMAL,
+      VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, // blits read from the image too
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      texture.image,
+      texture.memory
+    );
+
+    if(image.levels.empty())
+      uploader.upload_image(texture.image, image.pixels.data(), image.pixels.size(), image.width, image.height, texture.mip_levels);
+    else
+      uploader.upload_image_levels(texture.image, image.pixels.data(), image.pixels.size(), image.levels);
+    texture.view = create_image_view(texture.image, texture.format, VK_IMAGE_ASPECT_COLOR_BIT, texture.mip_levels);
+
+    staged += image.pixels.size();
+    texture_swaps.push_back({static_cast<uint32_t>(id), 0});
+  }
+  streamed_textures.erase(streamed_textures.begin(), streamed_textures.begin() + static_cast<std::ptrdiff_t>(taken));
 
-  VkBuffer staging_buffer;
-  VkDeviceMemory staging_buffer_memory;
-  create_buffer(
-    image_size, 
-    VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-    staging_buffer, 
-    staging_buffer_memory
-  );
+  if(texture_swaps.size() != first_swap) {
+    auto ticket = uploader.submit();
+    for(auto i = first_swap; i < texture_swaps.size(); ++i)
+      texture_swaps[i].ticket = ticket;
+  }
 
-  void* data;
-  vkMapMemory(device, staging_buffer_memory, 0, image_size, 0, &data);
-  memcpy(data, pixels, static_cast<size_t>(image_size));
-  vkUnmapMemory(device, staging_buffer_memory);
+  for(const auto& swap : texture_swaps) {
+    if(!uploader.is_complete(swap.ticket)) continue;
+    auto& texture = textures[swap.texture];
+    texture.ready = true;
+    if(bindless_capacity != 0)
+      texture.slot = write_texture_slot(texture.view);
+    else
+      update_material_sets(swap.texture);
+  }
+  std::erase_if(texture_swaps, [this](const TextureSwap& swap) { return textures[swap.texture].ready; });
 
-  stbi_image_free(pixels);
+  if(!texture_stream_duration && texture_decoder.outstanding() == 0 && streamed_textures.empty() && texture_swaps.empty()) {
+    texture_stream_duration = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - stream_start).count();
+    std::cout << "[texture] streaming finished after " << *texture_stream_duration << " ms\n";
+  }
+}
 
-  create_image(
-    tex_width, tex_height,
-    VK_FORMAT_R8G8B8A8_SRGB,
-    VK_IMAGE_TILING_OPTIMAL,
-    VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 
-    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
-    texture_image, 
-    texture_image_memory
-  );
+// the placeholder until the texture has been uploaded
+auto VulkanApplication::texture_view(uint32_t texture) const -> VkImageView {
+  return textures[texture].ready ? textures[texture].view : placeholder_texture.view;
+}
 
-  transition_image_layout(texture_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-  copy_buffer_to_image(staging_buffer, texture_image, static_cast<uint32_t>(tex_width), static_cast<uint32_t>(tex_height));
-  // one last transition to prepare for shader access
-  transition_image_layout(texture_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+// every material sampling texture, in every frame, moves to the set for its current view. frames in
+// flight keep the set they were recorded with, which is never written again
+auto VulkanApplication::update_material_sets(uint32_t texture) -> void {
+  auto materials = material_textures.size();
+  for(std::size_t material = 0; material < materials; ++material) {
+    if(material_textures[material] != texture) continue;
+    for(uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; ++frame)
+      descriptor_sets[frame * materials + material] = material_set(frame, texture);
+  }
+}
 
-  vkDestroyBuffer(device, staging_buffer, nullptr);
-  vkFreeMemory(device, staging_buffer_memory, nullptr);
+// the placeholder's slot until the texture has been uploaded
+auto VulkanApplication::texture_slot(uint32_t texture) const -> uint32_t {
+  return textures[texture].ready ? textures[texture].slot : placeholder_texture.slot;
 }
 
-auto VulkanApplication::create_texture_image_view(void) -> void {
-  texture_image_view = create_image_view(texture_image, VK_FORMAT_R8G8B8A8_SRGB);
+// into a newly allocated slot of the bindless array, which is returned
+auto VulkanApplication::write_texture_slot(VkImageView view) -> uint32_t {
+  auto slot = texture_slots.allocate();
+  if(!slot)
+    throw std::runtime_error("Error - bindless texture array is full (" + std::to_string(bindless_capacity) + " slots)");
+
+  VkDescriptorImageInfo image_info{};
+  image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  image_info.imageView = view;
+  image_info.sampler = texture_sampler;
+
+  VkWriteDescriptorSet descriptor_write{};
+  descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  descriptor_write.dstSet = bindless_set;
+  descriptor_write.dstBinding = 0;
+  descriptor_write.dstArrayElement = *slot;
+  descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  descriptor_write.descriptorCount = 1;
+  descriptor_write.pImageInfo = &image_info;
+
+  vkUpdateDescriptorSets(device, 1, &descriptor_write, 0, nullptr);
+  return *slot;
 }
 
 auto VulkanApplication::create_texture_sampler(void) -> void {
@@ -933,8 +1415,10 @@ auto VulkanApplication::create_texture_sampler(void) -> void {
   sampler_info.compareOp = VK_COMPARE_OP_ALWAYS;
   sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
   sampler_info.mipLodBias = 0.0f;
+  // no clamp, every level an image view exposes can be sampled; a texture that is still streaming in
+  // only has a view over its resident levels, so the one sampler suits every texture
   sampler_info.minLod = 0.0f;
-  sampler_info.maxLod = 0.0f;
+  sampler_info.maxLod = VK_LOD_CLAMP_NONE;
 
   if(vkCreateSampler(device, &sampler_info, nullptr, &texture_sampler) != VK_SUCCESS)
     throw std::runtime_error("failed to create texture sampler!");
@@ -942,78 +1426,105 @@ auto VulkanApplication::create_texture_sampler(void) -> void {
   VkPhysicalDeviceFeatures device_features{};
 }
 
-auto VulkanApplication::create_vertex_buffer(void) -> void {
-  VkDeviceSize buffer_size = sizeof(vulkan_vertices[0]) * vulkan_vertices.size();
+// every mesh goes into one vertex and one index buffer; a draw picks its mesh with the first index
+// and vertex offset, so nothing is rebound between meshes
+auto VulkanApplication::create_mesh_buffers(void) -> void {
+  std::vector<VulkanVertex> vertices;
+  std::vector<uint16_t> indices;
 
-  VkBuffer staging_buffer;
-  VkDeviceMemory staging_buffer_memory;
-  create_buffer(
-    buffer_size, 
-    VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-    staging_buffer, staging_buffer_memory
-  );
+  meshes.clear();
+  if(assets.count(asset_pack::AssetType::Mesh) != 0) {
+    create_pack_meshes();
+    return;
+  }
+  if(config.scene_meshes == 0) {
+    vertices = vulkan_vertices;
+    indices = vulkan_indices;
+    meshes.push_back({0, static_cast<uint32_t>(indices.size()), 0});
+  } else {
+    for(std::size_t i = 0; i < config.scene_meshes; ++i)
+      meshes.push_back(generate_mesh(i, vertices, indices));
+  }
 
-  // map buffer memory into cpu accessible memory
-  void* data;
-  uint32_t flags = 0;
-  // access a region of the specified memory resource defined by an offset and size (VK_WHOLE_SIZE maps whole region)
-  vkMapMemory(device, staging_buffer_memory, 0, buffer_size, flags, &data);
-  memcpy(data, vulkan_vertices.data(),  static_cast<std::size_t>(buffer_size)); // copy vulkan_vertices into buffer memory (and therefore buffer)
-  vkUnmapMemory(device, staging_buffer_memory); // unmap memory object once host access to it is no longer needed, memory is now initialized
+  VkDeviceSize vertex_buffer_size = sizeof(vertices[0]) * vertices.size();
 
   create_buffer(
-    buffer_size, 
+    vertex_buffer_size, 
     VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
     vertex_buffer, vertex_buffer_memory
   );
 
-  // src, dest, size
-  copy_buffer(staging_buffer, vertex_buffer, buffer_size);
+  // vertices go through the staging ring, the copy is recorded into the loading batch
+  uploader.upload_buffer(vertex_buffer, vertices.data(), vertex_buffer_size);
 
-  vkDestroyBuffer(device, staging_buffer, nullptr);
-  vkFreeMemory(device, staging_buffer_memory, nullptr);
-}
+  VkDeviceSize index_buffer_size = sizeof(indices[0]) * indices.size();
 
-auto VulkanApplication::create_index_buffer(void) -> void {
-  VkDeviceSize buffer_size = sizeof(vulkan_indices[0]) * vulkan_indices.size();
-
-  VkBuffer staging_buffer;
-  VkDeviceMemory staging_buffer_memory;
   create_buffer(
-    buffer_size, 
-    VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-    staging_buffer, staging_buffer_memory
+    index_buffer_size, 
+    VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, 
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
+    index_buffer, index_buffer_memory
   );
 
-  void* data;
-  vkMapMemory(device, staging_buffer_memory, 0, buffer_size, 0, &data);
   // dest, src, size
-  memcpy(data, vulkan_indices.data(), static_cast<std::size_t>(buffer_size));
-  vkUnmapMemory(device, staging_buffer_memory);
+  uploader.upload_buffer(index_buffer, indices.data(), index_buffer_size);
+}
 
+// cooked meshes are already in the vertex layout, each is staged straight out of the pack into its
+// place in the shared buffers
+auto VulkanApplication::create_pack_meshes(void) -> void {
+  static_assert(sizeof(asset_pack::Vertex) == sizeof(VulkanVertex), "cooked vertices must match the bound layout");
+  static_assert(offsetof(asset_pack::Vertex, colour) == offsetof(VulkanVertex, col) && offsetof(asset_pack::Vertex, uv) == offsetof(VulkanVertex, tex), "cooked vertices must match the bound layout");
+
+  VkDeviceSize vertex_buffer_size = 0;
+  VkDeviceSize index_buffer_size = 0;
+  for(const auto& entry : assets.entries()) {
+    if(entry.type != asset_pack::AssetType::Mesh) continue;
+    meshes.push_back({static_cast<uint32_t>(index_buffer_size / sizeof(uint16_t)), entry.index_count, static_cast<int32_t>(vertex_buffer_size / sizeof(VulkanVertex))});
+    vertex_buffer_size += entry.vertex_count * sizeof(VulkanVertex);
+    index_buffer_size += entry.index_count * sizeof(uint16_t);
+  }
+
+  // only ever written by the transfer queue's copies, so both live in device memory
   create_buffer(
-    buffer_size, 
-    VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, 
-    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
+    vertex_buffer_size,
+    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+    vertex_buffer, vertex_buffer_memory
+  );
+  create_buffer(
+    index_buffer_size,
+    VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
     index_buffer, index_buffer_memory
   );
 
-  // src, dest, size
-  copy_buffer(staging_buffer, index_buffer, buffer_size);
-
-  vkDestroyBuffer(device, staging_buffer, nullptr);
-  vkFreeMemory(device, staging_buffer_memory, nullptr);
+  std::size_t mesh = 0;
+  for(const auto& entry : assets.entries()) {
+    if(entry.type != asset_pack::AssetType::Mesh) continue;
+    const auto& range = meshes[mesh++];
+    VkDeviceSize vertex_bytes = entry.vertex_count * sizeof(VulkanVertex);
+    uploader.upload_buffer(vertex_buffer, assets.data(entry), vertex_bytes, static_cast<VkDeviceSize>(range.vertex_offset) * sizeof(VulkanVertex));
+    uploader.upload_buffer(index_buffer, assets.data(entry) + vertex_bytes, entry.index_count * sizeof(uint16_t), range.first_index * sizeof(uint16_t));
+  }
+  std::cout << "[mesh] " << meshes.size() << " mesh(es) from " << config.asset_pack_path << "\n";
 }
 
 auto VulkanApplication::create_uniform_buffers(void) -> void {
-  VkDeviceSize buffer_size = sizeof(UniformBufferObject);
+  // every dynamic offset handed to vkCmdBindDescriptorSets must be a multiple of this
+  VkPhysicalDeviceProperties properties{};
+  vkGetPhysicalDeviceProperties(physical_device, &properties);
+  min_uniform_alignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 1);
+
+  // big enough for one aligned ubo per object in the scene when transforms are not pushed
+  auto ubo_stride = (sizeof(ObjectUniformBufferObject) + min_uniform_alignment - 1) / min_uniform_alignment * min_uniform_alignment;
+  VkDeviceSize buffer_size = push_transforms ? UNIFORM_ARENA_SIZE : std::max<VkDeviceSize>(UNIFORM_ARENA_SIZE, ubo_stride * object_positions.size());
 
   uniform_buffers.resize(MAX_FRAMES_IN_FLIGHT);
   uniform_buffers_memory.resize(MAX_FRAMES_IN_FLIGHT);
   uniform_buffers_mapped.resize(MAX_FRAMES_IN_FLIGHT);
+  uniform_arenas.assign(MAX_FRAMES_IN_FLIGHT, memory::LinearAllocator(buffer_size));
 
   for(std::size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
     create_buffer(
@@ -1022,7 +1533,7 @@ auto VulkanApplication::create_uniform_buffers(void) -> void {
       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
       uniform_buffers[i],
       uniform_buffers_memory[i]);
-    vkMapMemory(device, uniform_buffers_memory[i], 0, buffer_size, 0, &uniform_buffers_mapped[i]);
+    uniform_buffers_mapped[i] = uniform_buffers_memory[i].mapped;
   }
 }
 
@@ -1037,6 +1548,69 @@ auto VulkanApplication::create_command_buffers(void) -> void {
 
   if(vkAllocateCommandBuffers(device, &alloc_info, command_buffers.data()) != VK_SUCCESS)
     throw std::runtime_error("Error - failed to allocate command buffers");
+
+  auto partitions = std::max<std::size_t>(config.record_threads, 1);
+  if(partitions == 1) return;
+
+  QueueFamilyIndices queue_family_indices = find_queue_families(physical_device);
+
+  // command pools are externally synchronized; a partition is only ever recorded by one job at a
+  // time, so every partition gets its own pool for each frame in flight. a whole pool is reset at
+  // once when its frame comes around again, which is cheaper than per buffer
+  record_partitions = partitions;
+  record_command_pools.resize(MAX_FRAMES_IN_FLIGHT * partitions);
+  secondary_command_buffers.resize(MAX_FRAMES_IN_FLIGHT * subpass_count * partitions);
+
+  for(std::size_t i = 0; i < record_command_pools.size(); ++i) {
+    auto frame = i / partitions;
+    auto partition = i % partitions;
+
+    VkCommandPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    pool_info.queueFamilyIndex = queue_family_indices.graphics_family.value();
+
+    if(vkCreateCommandPool(device, &pool_info, nullptr, &record_command_pools[i]) != VK_SUCCESS)
+      throw std::runtime_error("Error - failed to create recording command pool");
+
+    VkCommandBufferAllocateInfo secondary_info{};
+    secondary_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    secondary_info.commandPool = record_command_pools[i];
+    secondary_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY; // executed from the primary, not submitted
+    secondary_info.commandBufferCount = 1;
+
+    // one per subpass; a subpass's partitions sit next to each other, to be executed together
+    for(uint32_t subpass = 0; subpass < subpass_count; ++subpass) {
+      auto index = (frame * subpass_count + subpass) * partitions + partition;
+      if(vkAllocateCommandBuffers(device, &secondary_info, &secondary_command_buffers[index]) != VK_SUCCESS)
+        throw std::runtime_error("Error - failed to allocate secondary command buffers");
+    }
+  }
+}
+
+// lays config.object_count objects out on a square grid around the origin; neighbours get different
+// meshes and materials, materials different textures
+auto VulkanApplication::create_scene(void) -> void {
+  auto count = std::max<std::size_t>(config.object_count, 1);
+  auto side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+  auto centre = (static_cast<float>(side) - 1.0f) / 2.0f;
+
+  material_textures.resize(std::max<std::size_t>(config.scene_materials, 1));
+  for(std::size_t i = 0; i < material_textures.size(); ++i)
+    material_textures[i] = static_cast<uint32_t>(i % textures.size());
+
+  object_positions.clear();
+  object_positions.reserve(count);
+  object_draws.clear();
+  object_draws.reserve(count);
+  for(std::size_t i = 0; i < count; ++i) {
+    auto x = static_cast<float>(i % side) - centre;
+    auto y = static_cast<float>(i / side) - centre;
+    object_positions.emplace_back(x * 1.2f, y * 1.2f, 0.0f);
+    object_draws.push_back({static_cast<uint32_t>(i % meshes.size()), static_cast<uint32_t>(i % material_textures.size())});
+  }
+  if(!push_transforms)
+    object_uniform_offsets.reserve(count);
 }
 
 auto VulkanApplication::create_sync_objects(void) -> void {
@@ -1065,6 +1639,17 @@ auto VulkanApplication::create_sync_objects(void) -> void {
   }
 }
 
+auto VulkanApplication::create_readback(void) -> void {
+  if(config.export_format == readback::ExportFormat::None) return;
+
+  readback.create(device, allocator, swap_chain_extent, swap_chain_image_format, MAX_FRAMES_IN_FLIGHT, config.export_format, config.export_path);
+  std::cout << "[readback] exporting frames to " << config.export_path << "\n";
+}
+
+auto VulkanApplication::create_gpu_profiler(void) -> void {
+  gpu_profiler.create(physical_device, device, graphics_family_index, MAX_FRAMES_IN_FLIGHT);
+}
+
 auto VulkanApplication::create_debug_utils_messenger_ext(
   VkInstance instance, 
   const VkDebugUtilsMessengerCreateInfoEXT* p_create_info, 
@@ -1095,35 +1680,56 @@ auto VulkanApplication::find_queue_families(VkPhysicalDevice device) -> QueueFam
   std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
   vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, queue_families.data());
 
-  for(std::size_t i = 0; const auto& queue_family : queue_families) {
-    if(queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+  // every family is visited, the dedicated ones can come after graphics and present
+  for(uint32_t i = 0; const auto& queue_family : queue_families) {
+    auto flags = queue_family.queueFlags;
+    if(!indices.graphics_family.has_value() && (flags & VK_QUEUE_GRAPHICS_BIT))
       indices.graphics_family = i;
-    if(indices.is_complete()) break;
+    if(!indices.transfer_family.has_value() && (flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+      indices.transfer_family = i;
+    if(!indices.compute_family.has_value() && (flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT))
+      indices.compute_family = i;
     
     VkBool32 present_support = false;
-    vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present_support);
-    if(present_support)
+    if(surface != VK_NULL_HANDLE)
+      vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present_support);
+    if(!indices.present_family.has_value() && present_support)
       indices.present_family = i;
 
     ++i;
   }
 
+  // no dma engine; an async compute family can still copy without stealing graphics time,
+  // otherwise (e.g. lavapipe, a single family) uploads stay on the graphics queue
+  if(!indices.transfer_family.has_value())
+    indices.transfer_family = indices.compute_family.has_value() ? indices.compute_family : indices.graphics_family;
+  if(!indices.compute_family.has_value())
+    indices.compute_family = indices.graphics_family;
+  // headless; nothing is presented, present_queue just aliases graphics
+  if(surface == VK_NULL_HANDLE)
+    indices.present_family = indices.graphics_family;
+
   return indices;
 }
 
 auto VulkanApplication::is_device_suitable(VkPhysicalDevice device) -> bool {
-  auto extensions_supported = check_device_extension_support(device);
   auto indices = find_queue_families(device);
 
+  VkPhysicalDeviceFeatures supported_features;
+  vkGetPhysicalDeviceFeatures(device, &supported_features);
+
+  // any device that can draw will do; e.g. lavapipe on a machine without a gpu
+  if(config.headless)
+    return indices.graphics_family.has_value() && supported_features.samplerAnisotropy;
+
+  auto extensions_supported = check_device_extension_support(device);
+
   auto swap_chain_adequate = false;
   if(extensions_supported) {
     SwapChainSupportDetails swap_chain_support = query_swap_chain_support(device);
     swap_chain_adequate = !swap_chain_support.formats.empty() && !swap_chain_support.present_modes.empty();
   }
 
-  VkPhysicalDeviceFeatures supported_features;
-  vkGetPhysicalDeviceFeatures(device, &supported_features);
-
   return indices.is_complete() && extensions_supported && swap_chain_adequate && supported_features.samplerAnisotropy;
 }
 
@@ -1166,6 +1772,38 @@ auto VulkanApplication::query_swap_chain_support(VkPhysicalDevice device) -> Swa
   return details;
 }
 
+// vkCmdBlitImage with a linear filter needs all three on optimal tiling images
+auto VulkanApplication::format_supports_linear_blit(VkFormat format) -> bool {
+  VkFormatProperties properties;
+  vkGetPhysicalDeviceFormatProperties(physical_device, format, &properties);
+
+  VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+  return (properties.optimalTilingFeatures & required) == required;
+}
+
+// block compressed formats are only reported once their feature (bc, etc2, astc) is enabled
+auto VulkanApplication::format_supports_sampling(VkFormat format) -> bool {
+  VkFormatProperties properties;
+  vkGetPhysicalDeviceFormatProperties(physical_device, format, &properties);
+
+  VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+  return (properties.optimalTilingFeatures & required) == required;
+}
+
+// d32 first, reverse-z relies on float depth for its precision; the stencil formats are fallbacks
+// for devices without plain d32 (d24 is fixed point, so reverse-z gains it little)
+auto VulkanApplication::find_depth_format(void) -> VkFormat {
+  for(auto format : {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT}) {
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(physical_device, format, &properties);
+
+    if(properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+      return format;
+  }
+
+  throw std::runtime_error("Error - failed to find a supported depth format");
+}
+
 // writes the commands want to execute into a command buffer
 auto VulkanApplication::record_command_buffer(VkCommandBuffer command_buffer, uint32_t image_index) -> void {
   VkCommandBufferBeginInfo begin_info{};
@@ -1176,6 +1814,13 @@ auto VulkanApplication::record_command_buffer(VkCommandBuffer command_buffer, ui
   if(vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS)
     throw std::runtime_error("Error - failed to begin recording command buffer");
 
+  // this frame's fence was just waited on; its timestamps from last time round are read back here
+  gpu_profiler.begin_frame(command_buffer, current_frame);
+  auto frame_scope = gpu_profiler.begin_scope(command_buffer, "frame");
+
+  // take ownership of anything the transfer queue finished uploading, before the render pass uses it
+  frame_acquire.record(command_buffer);
+
   VkRenderPassBeginInfo render_pass_info{};
   render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
   render_pass_info.renderPass = render_pass;
@@ -1183,13 +1828,104 @@ auto VulkanApplication::record_command_buffer(VkCommandBuffer command_buffer, ui
   render_pass_info.renderArea.offset = {0, 0};
   render_pass_info.renderArea.extent = swap_chain_extent;
 
-  VkClearValue clear_color = {{{0.2f, 0.2f, 0.2f, 1.0f}}};
-  render_pass_info.clearValueCount = 1;
-  render_pass_info.pClearValues = &clear_color;
+  std::array<VkClearValue, 2> clear_values{};
+  clear_values[0].color = {{0.2f, 0.2f, 0.2f, 1.0f}};
+  clear_values[1].depthStencil = {0.0f, 0}; // reverse-z, 0 is infinitely far away
+  render_pass_info.clearValueCount = static_cast<uint32_t>(clear_values.size());
+  render_pass_info.pClearValues = clear_values.data();
+
+  // with parallel recording the subpass only holds vkCmdExecuteCommands, the draws live in secondaries
+  auto parallel = !secondary_command_buffers.empty();
+  auto contents = parallel ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE;
 
   // dictate the render pass and graphics pipeline objects used
-  vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
-  vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipeline);
+  auto render_pass_scope = gpu_profiler.begin_scope(command_buffer, "render_pass");
+  vkCmdBeginRenderPass(command_buffer, &render_pass_info, contents);
+
+  // still compiling; clear the frame and draw nothing rather than stall the render thread. the
+  // pre-pass draws the same objects into depth only, the colour subpass then shades what survived
+  auto pipeline = pipelines.get(graphics_pipeline);
+  auto depth = config.depth_prepass ? pipelines.get(depth_pipeline) : VK_NULL_HANDLE;
+  auto ready = pipeline != VK_NULL_HANDLE && (!config.depth_prepass || depth != VK_NULL_HANDLE);
+  if(ready && parallel)
+    record_secondary_command_buffers(image_index, depth, pipeline);
+
+  auto partitions = static_cast<uint32_t>(record_partitions);
+  for(uint32_t subpass = 0; subpass < subpass_count; ++subpass) {
+    if(subpass > 0)
+      vkCmdNextSubpass(command_buffer, contents);
+    if(!ready) continue;
+
+    auto subpass_pipeline = subpass + 1 < subpass_count ? depth : pipeline;
+    if(parallel)
+      vkCmdExecuteCommands(command_buffer, partitions, &secondary_command_buffers[(current_frame * subpass_count + subpass) * partitions]);
+    else
+      record_draws(command_buffer, subpass_pipeline, 0, frame_snapshot->object_transforms.size());
+  }
+
+  vkCmdEndRenderPass(command_buffer);
+  gpu_profiler.end_scope(command_buffer, render_pass_scope);
+
+  // picked up a few frames later, once this frame's fence has been waited on anyway
+  if(readback.enabled()) {
+    auto layout = config.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; // render pass finalLayout
+    auto readback_scope = gpu_profiler.begin_scope(command_buffer, "readback");
+    readback.record_copy(command_buffer, swap_chain_images[image_index], layout, current_frame);
+    gpu_profiler.end_scope(command_buffer, readback_scope);
+  }
+  gpu_profiler.end_scope(command_buffer, frame_scope);
+
+  if(vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
+    throw std::runtime_error("Error - failed to record command buffer");
+}
+
+// splits the draw list into one contiguous range per partition, each recorded as a job into the
+// partition's own pool; the render thread records too while it waits for the rest
+// with the depth pre-pass a partition records its range twice, once per subpass (depth is only
+// used then, and is VK_NULL_HANDLE otherwise)
+auto VulkanApplication::record_secondary_command_buffers(uint32_t image_index, VkPipeline depth, VkPipeline pipeline) -> void {
+  auto partitions = record_partitions;
+  auto draws = frame_snapshot->object_transforms.size();
+  auto per_partition = (draws + partitions - 1) / partitions;
+
+  jobs->parallel_for(0, partitions, 1, [this, image_index, depth, pipeline, partitions, draws, per_partition](std::size_t begin, std::size_t end) {
+    for(auto partition = begin; partition < end; ++partition) {
+      auto scope = cpu_profiler::Scope("record_partition");
+      vkResetCommandPool(device, record_command_pools[current_frame * partitions + partition], 0);
+
+      for(uint32_t subpass = 0; subpass < subpass_count; ++subpass) {
+        // secondaries recorded inside a render pass must say which one, and may name the framebuffer
+        VkCommandBufferInheritanceInfo inheritance_info{};
+        inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance_info.renderPass = render_pass;
+        inheritance_info.subpass = subpass;
+        inheritance_info.framebuffer = swap_chain_framebuffers[image_index];
+
+        VkCommandBufferBeginInfo begin_info{};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        begin_info.pInheritanceInfo = &inheritance_info;
+
+        auto command_buffer = secondary_command_buffers[(current_frame * subpass_count + subpass) * partitions + partition];
+        if(vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS)
+          throw std::runtime_error("Error - failed to begin recording secondary command buffer");
+
+        // an empty range still has to be a valid (empty) secondary, it is executed like the rest
+        auto first = std::min(partition * per_partition, draws);
+        auto count = std::min(per_partition, draws - first);
+        if(count > 0)
+          record_draws(command_buffer, subpass + 1 < subpass_count ? depth : pipeline, first, count);
+
+        if(vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
+          throw std::runtime_error("Error - failed to record secondary command buffer");
+      }
+    }
+  });
+}
+
+// binds everything a draw needs (nothing is inherited into secondaries) and draws a range of objects
+auto VulkanApplication::record_draws(VkCommandBuffer command_buffer, VkPipeline pipeline, std::size_t first_object, std::size_t object_count) -> void {
+  vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 
   VkBuffer vertex_buffers[] = {vertex_buffer};
   VkDeviceSize offsets[] = {0};
@@ -1210,17 +1946,57 @@ auto VulkanApplication::record_command_buffer(VkCommandBuffer command_buffer, ui
   scissor.extent = swap_chain_extent;
   vkCmdSetScissor(command_buffer, 0, 1, &scissor);
   // pipeline to use (computer or graphics), layout descriptor sets are based on, index of first desc set, #sets to bind, array to bind 
-  vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &descriptor_sets[current_frame], 0, nullptr);
-  //vkCmdDraw(command_buffer, static_cast<uint32_t>(vulkan_vertices.size()), 1, 0, 0);
-  // cmd_buf, number of indices, number of instances (not using instancing, so just 1)
-  vkCmdDrawIndexed(command_buffer, static_cast<uint32_t>(vulkan_indices.size()), 1, 0, 0, 0);
-  vkCmdEndRenderPass(command_buffer);
+  // with pushed transforms a set is only bound when the material's differs from the last one, and
+  // bindless there is a single bind for the frame's camera and the texture array; the model matrix
+  // (and bindless, the texture) is pushed per draw. otherwise the material's set is rebound per
+  // object along with its dynamic offset into the uniform arena, and bindless only the offset moves
+  auto bindless = bindless_capacity != 0;
+  auto* frame_sets = &descriptor_sets[current_frame * (descriptor_sets.size() / MAX_FRAMES_IN_FLIGHT)];
+  if(bindless && push_transforms) {
+    std::array<VkDescriptorSet, 2> sets = {frame_sets[0], bindless_set};
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, static_cast<uint32_t>(sets.size()), sets.data(), 1, &camera_uniform_offset);
+  } else if(bindless) {
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 1, 1, &bindless_set, 0, nullptr);
+  }
 
-  if(vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
-    throw std::runtime_error("Error - failed to record command buffer");
+  auto push_stages = bindless ? VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT : VK_SHADER_STAGE_VERTEX_BIT;
+  auto push_size = bindless ? DRAW_PUSH_SIZE : MODEL_PUSH_SIZE;
+  const auto& transforms = frame_snapshot->object_transforms;
+  VkDescriptorSet bound_set = VK_NULL_HANDLE;
+  for(auto i = first_object; i < first_object + object_count; ++i) {
+    const auto& draw = object_draws[i];
+    DrawPushConstants constants{};
+    if(bindless)
+      constants.texture_index = texture_slot(material_textures[draw.material]);
+
+    if(push_transforms) {
+      constants.model = transforms[i];
+      if(!bindless && frame_sets[draw.material] != bound_set) {
+        bound_set = frame_sets[draw.material];
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &bound_set, 1, &camera_uniform_offset);
+      }
+      vkCmdPushConstants(command_buffer, pipeline_layout, push_stages, 0, push_size, &constants);
+    } else {
+      auto offset = object_uniform_offsets[i];
+      vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &frame_sets[bindless ? 0 : draw.material], 1, &offset);
+      if(bindless)
+        vkCmdPushConstants(command_buffer, pipeline_layout, VK_SHADER_STAGE_FRAGMENT_BIT, TEXTURE_PUSH_OFFSET, sizeof(uint32_t), &constants.texture_index);
+    }
+    //vkCmdDraw(command_buffer, static_cast<uint32_t>(vulkan_vertices.size()), 1, 0, 0);
+    // cmd_buf, number of indices, number of instances (not using instancing, so just 1), first index, vertex offset, first instance
+    const auto& mesh = meshes[draw.mesh];
+    vkCmdDrawIndexed(command_buffer, mesh.index_count, 1, mesh.first_index, mesh.vertex_offset, 0);
+  }
+}
+
+auto VulkanApplication::should_close(void) const -> bool {
+  if(close_requested.load(std::memory_order_relaxed)) return true;
+  return !config.headless && glfwWindowShouldClose(window);
 }
 
 auto VulkanApplication::recreate_swap_chain(void) -> void {
+  auto scope = cpu_profiler::Scope("recreate_swap_chain");
+
   // if the window is minimized (width=0 & height=0), pause until it is in foreground again 
   int width = 0, height = 0;
   glfwGetFramebufferSize(window, &width, &height);
@@ -1236,9 +2012,11 @@ auto VulkanApplication::recreate_swap_chain(void) -> void {
 
   create_swap_chain();
   create_image_views(); // based on swap chain images
+  create_depth_resources(); // matches the swap chain extent
   create_render_pass(); // depends on format of swap chain images (rare to change, still good to handle)
   create_graphics_pipeline(); // viewport extent and scissor rectangle specified here
   create_framebuffers(); // directly depend on swap chain images
+  readback.resize(swap_chain_extent); // exports what is still in the ring at the old size first
 }
 
 auto VulkanApplication::cleanup_swap_chain(void) -> void {
@@ -1248,28 +2026,16 @@ auto VulkanApplication::cleanup_swap_chain(void) -> void {
   for(auto&& image_view : swap_chain_image_views)
     vkDestroyImageView(device, image_view, nullptr);
 
-  vkDestroySwapchainKHR(device, swap_chain, nullptr);
-}
+  vkDestroyImageView(device, depth_image_view, nullptr);
+  vkDestroyImage(device, depth_image, nullptr);
+  allocator.free(depth_image_memory);
 
-// "Graphics cards can offer different types of memory to allocate from. Each type of
-//  memory varies in terms of allowed operations and performance characteristics.
-//  Need to combine the requirements of the buffer and the application requirements
-//  to find the right type of memory to use"
-auto VulkanApplication::find_memory_type(uint32_t type_filter, VkMemoryPropertyFlags properties) -> uint32_t {
-  // structure has two arrays; memoryTypes and memoryHeaps (distinct memory resources, like dedicated VRAM or RAM swap sapce)
-  VkPhysicalDeviceMemoryProperties mem_properties;
-  vkGetPhysicalDeviceMemoryProperties(physical_device, &mem_properties);
-
-  for(std::size_t i = 0; i < mem_properties.memoryTypeCount; ++i)
-    // if a type matches the bitmask filter, then just go with that memory type
-    // assert that the memory type chosen is able to support writes from the CPU (need VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
-    if((type_filter & (1 << i)) && (mem_properties.memoryTypes[i].propertyFlags & properties) == properties)
-      return i;
-
-  throw std::runtime_error("Error - failed to find suitable memory type");
+  // offscreen images live until cleanup, they never need recreating
+  if(!config.headless)
+    vkDestroySwapchainKHR(device, swap_chain, nullptr);
 }
 
-auto VulkanApplication::create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& buffer_memory) -> void {
+auto VulkanApplication::create_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, memory::Allocation& buffer_memory) -> void {
   VkBufferCreateInfo buffer_info{};
   buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
   buffer_info.size = size;
@@ -1288,60 +2054,74 @@ auto VulkanApplication::create_buffer(VkDeviceSize size, VkBufferUsageFlags usag
   VkMemoryRequirements mem_requirements;
   vkGetBufferMemoryRequirements(device, buffer, &mem_requirements);
 
-  VkMemoryAllocateInfo alloc_info{};
-  alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  alloc_info.allocationSize = mem_requirements.size;
-  alloc_info.memoryTypeIndex = find_memory_type(mem_requirements.memoryTypeBits, properties);
-
-  // allocate the memory to the buffer memory region
-  if(vkAllocateMemory(device, &alloc_info, nullptr, &buffer_memory) != VK_SUCCESS)
-    throw std::runtime_error("Error - failed to allocate vertex buffer memory");
-
-  // if the allocation was successful, bind the buffer to the memory region
-  vkBindBufferMemory(device, buffer, buffer_memory, 0);
-}
-
-auto VulkanApplication::copy_buffer(VkBuffer src_buffer, VkBuffer dest_buffer, VkDeviceSize size) -> void {
-  // temporary command buffer allocation to perform transfer operation
-  VkCommandBuffer command_buffer = begin_single_time_commands();
+  // carve the memory out of a block of the matching memory type instead of one vkAllocateMemory per buffer
+  buffer_memory = allocator.allocate(mem_requirements, properties, memory::ResourceKind::Linear);
 
-  VkBufferCopy copy_region{};
-  copy_region.size = size;
-  // src, dest, arr_size, arr of regions to copy
-  vkCmdCopyBuffer(command_buffer, src_buffer, dest_buffer, 1, &copy_region);
-
-  end_single_time_commands(command_buffer);
+  // bind the buffer to its region of the (shared) memory object
+  vkBindBufferMemory(device, buffer, buffer_memory.memory, buffer_memory.offset);
 }
 
+// picks up the latest simulation snapshot and bumps this frame's uniforms into its arena; the fence
+// for this frame has signalled, so the gpu is done reading everything bumped into it last time. with
+// push_transforms that is just the camera, object transforms are pushed from the snapshot as the draws
+// are recorded; otherwise it is every object's transforms
 auto VulkanApplication::update_uniform_buffer(uint32_t current_image_index) -> void {
-  static auto start_time = std::chrono::high_resolution_clock::now();
-
-  auto current_time = std::chrono::high_resolution_clock::now();
-  auto time = std::chrono::duration<float, std::chrono::seconds::period>(current_time - start_time).count();
+  frame_snapshot = &frame_states.read();
 
   UniformBufferObject ubo{};
 
-  auto trans = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 0.0f)); // apply no transformation currently
-  ubo.model = glm::rotate(trans, time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-  
   ubo.view = glm::lookAt(glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-  ubo.view = glm::translate(ubo.view, main_camera.position); // POSITION OBJECT RELATIVE TO CAMERA VIEW
+  ubo.view = glm::translate(ubo.view, frame_snapshot->camera_position); // POSITION OBJECT RELATIVE TO CAMERA VIEW
 
-  // projection matrix corrects aspect ratio; rectangle appears as a square, like it should
-  ubo.projection = glm::perspective(glm::radians(45.0f), swap_chain_extent.width / (float) swap_chain_extent.height, 0.01f, 50.0f);
+  // projection matrix corrects aspect ratio; rectangle appears as a square, like it should.
+  // reverse-z without a far plane, depth is cleared to 0 and nearer fragments have the larger depth
+  ubo.projection = camera::reverse_z_perspective(glm::radians(45.0f), swap_chain_extent.width / (float) swap_chain_extent.height, NEAR_PLANE);
   ubo.projection[1][1] *= -1; // in OpenGL, Y-clip-coordinate is inverted, so images will render upside down
 
-  memcpy(uniform_buffers_mapped[current_image_index], &ubo, sizeof(ubo));
+  auto& arena = uniform_arenas[current_image_index];
+  arena.reset();
+  auto* base = static_cast<char*>(uniform_buffers_mapped[current_image_index]);
+
+  if(push_transforms) {
+    auto offset = arena.allocate(sizeof(ubo), min_uniform_alignment);
+    if(!offset)
+      throw std::runtime_error("Error - per-frame uniform arena exhausted, raise UNIFORM_ARENA_SIZE");
+    memcpy(base + *offset, &ubo, sizeof(ubo));
+    camera_uniform_offset = static_cast<uint32_t>(*offset);
+    return;
+  }
+
+  // one bump for the whole scene, the objects then fill their aligned slots independently
+  const auto& snapshot = *frame_snapshot;
+  auto count = snapshot.object_transforms.size();
+  auto stride = (sizeof(ObjectUniformBufferObject) + min_uniform_alignment - 1) / min_uniform_alignment * min_uniform_alignment;
+  auto first_offset = arena.allocate(stride * count, min_uniform_alignment);
+  if(!first_offset)
+    throw std::runtime_error("Error - per-frame uniform arena exhausted, raise UNIFORM_ARENA_SIZE");
+  object_uniform_offsets.resize(count); // keeps its capacity, no allocation once the scene size settles
+
+  jobs->parallel_for(0, count, TRANSFORM_GRAIN, [&, base, first = *first_offset](std::size_t begin, std::size_t end) {
+    ObjectUniformBufferObject object_ubo{};
+    object_ubo.view = ubo.view;
+    object_ubo.projection = ubo.projection;
+    for(auto i = begin; i < end; ++i) {
+      auto offset = first + i * stride;
+      object_ubo.model = snapshot.object_transforms[i];
+
+      memcpy(base + offset, &object_ubo, sizeof(object_ubo));
+      object_uniform_offsets[i] = static_cast<uint32_t>(offset);
+    }
+  });
 }
 
-auto VulkanApplication::create_image(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& image_memory) -> void {
+auto VulkanApplication::create_image(uint32_t width, uint32_t height, uint32_t mip_levels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, memory::Allocation& image_memory) -> void {
   VkImageCreateInfo image_info{};
   image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
   image_info.imageType = VK_IMAGE_TYPE_2D;
   image_info.extent.width = width;
   image_info.extent.height = height;
   image_info.extent.depth = 1;
-  image_info.mipLevels = 1;
+  image_info.mipLevels = mip_levels;
   image_info.arrayLayers = 1;
   image_info.format = format;
   image_info.tiling = tiling;
@@ -1356,144 +2136,150 @@ auto VulkanApplication::create_image(uint32_t width, uint32_t height, VkFormat f
   VkMemoryRequirements mem_requirements;
   vkGetImageMemoryRequirements(device, image, &mem_requirements);
 
-  VkMemoryAllocateInfo alloc_info{};
-  alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  alloc_info.allocationSize = mem_requirements.size;
-  alloc_info.memoryTypeIndex = find_memory_type(mem_requirements.memoryTypeBits, properties);
-
-  if(vkAllocateMemory(device, &alloc_info, nullptr, &image_memory) != VK_SUCCESS)
-    throw std::runtime_error("Error - failed to allocate image memory");
+  // linear tiling images share pages with buffers freely, optimal ones need bufferImageGranularity spacing
+  auto kind = (tiling == VK_IMAGE_TILING_OPTIMAL) ? memory::ResourceKind::Optimal : memory::ResourceKind::Linear;
+  image_memory = allocator.allocate(mem_requirements, properties, kind);
 
-  vkBindImageMemory(device, image, image_memory, 0);
+  vkBindImageMemory(device, image, image_memory.memory, image_memory.offset);
 }
 
-auto VulkanApplication::begin_single_time_commands(void) -> VkCommandBuffer {
-  VkCommandBufferAllocateInfo alloc_info{};
-  alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  alloc_info.commandPool = command_pool;
-  alloc_info.commandBufferCount = 1;
+auto VulkanApplication::create_image_view(VkImage image, VkFormat format, VkImageAspectFlags aspect, uint32_t mip_levels) -> VkImageView {
+  VkImageViewCreateInfo view_info{};
+  view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+  view_info.image = image;
+  view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+  view_info.format = format;
+  view_info.subresourceRange.aspectMask = aspect;
+  view_info.subresourceRange.baseMipLevel = 0;
+  view_info.subresourceRange.levelCount = mip_levels;
+  view_info.subresourceRange.baseArrayLayer = 0;
+  view_info.subresourceRange.layerCount = 1;
 
-  VkCommandBuffer command_buffer;
-  vkAllocateCommandBuffers(device, &alloc_info, &command_buffer);
+  VkImageView image_view;
+  if(vkCreateImageView(device, &view_info, nullptr, &image_view) != VK_SUCCESS)
+    throw std::runtime_error("Error - failed to create texture image view");
 
-  VkCommandBufferBeginInfo begin_info{};
-  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT; // only using once, good compiler hint
+  return image_view;
+}
 
-  // start recording the command buffer
-  vkBeginCommandBuffer(command_buffer, &begin_info);
+// the first snapshot is produced here, so the render thread always has one to read
+auto VulkanApplication::start_simulation(void) -> void {
+  simulate(0.0);
 
-  return command_buffer;
+  simulation_stopping = false;
+  simulation_thread = std::thread([this]{ simulation_loop(); });
 }
 
-auto VulkanApplication::end_single_time_commands(VkCommandBuffer command_buffer) -> void {
-  // command buffer only contains copy command, stop recording
-  vkEndCommandBuffer(command_buffer);
-
-  VkSubmitInfo submit_info{};
-  submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  submit_info.commandBufferCount = 1;
-  submit_info.pCommandBuffers = &command_buffer;
-
-  vkQueueSubmit(graphics_queue, 1, &submit_info, VK_NULL_HANDLE);
-  vkQueueWaitIdle(graphics_queue); // wait for transfer to complete, fences could allow multiple queues
-
-  vkFreeCommandBuffers(device, command_pool, 1, &command_buffer);
-}
-
-auto VulkanApplication::transition_image_layout(VkImage image, VkFormat format, VkImageLayout old_layout, VkImageLayout new_layout) -> void {
-  VkCommandBuffer command_buffer = begin_single_time_commands();
-
-  VkImageMemoryBarrier barrier{};
-  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-  barrier.oldLayout = old_layout; // can use VK_IMAGE_LAYOUT_UNDEFINED if dont care about existing image contents
-  barrier.newLayout = new_layout;
-  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED; // both must be explicitly ignored
-  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-  barrier.image = image; // **
-  barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-  barrier.subresourceRange.baseMipLevel = 0;
-  barrier.subresourceRange.levelCount = 1;
-  barrier.subresourceRange.baseArrayLayer = 0;
-  barrier.subresourceRange.layerCount = 1;
-  barrier.srcAccessMask = 0; // TODO BELOW
-  barrier.dstAccessMask = 0; // TODO BELOW
-
-  // set access masks for pipeline stages based on layouts in the transition
-  // two transitions need to handle;
-  // - undefined -> transfer destination: transfer writes that don't need to wait
-  // - transfer destination -> shader reading: shader reads should wait on transfer writes,
-  //   specifically shader reads in fragment shader, because thats where texture is used
-  // NOTES: 
-  // - transfer writes must occur in the pipeline transfer stage
-  // - VK_PIPELINE_STAGE_TRANSFER_BIT is not a real stage, it is a pseudo-stage where transfers happen
-  // - image will be written in the same pipeline stage and subsequently read by the fragment shader
-  //   (this is why specify shader reading access in the fragment shader pipeline stage)
-  VkPipelineStageFlags source_stage;
-  VkPipelineStageFlags destination_stage;
-
-  if(old_layout == VK_IMAGE_LAYOUT_UNDEFINED && new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-    barrier.srcAccessMask = 0;
-    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-    source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-    destination_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-
-  } else if (old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-    source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-    destination_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+auto VulkanApplication::stop_simulation(void) -> void {
+  simulation_stopping = true;
+  if(simulation_thread.joinable())
+    simulation_thread.join();
+}
 
-  } else {
-    throw std::invalid_argument("Error - unsupported layout transition");
+// fixed timestep; a tick that runs late is caught up on straight away, so the simulated time
+// tracks the wall clock no matter how fast frames are rendered or presented
+auto VulkanApplication::simulation_loop(void) -> void {
+  using Clock = std::chrono::steady_clock;
+  cpu_profiler::set_thread_name("simulation");
+
+  auto step = 1.0 / std::max(config.simulation_hz, 1.0);
+  auto step_duration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(step));
+  auto next_tick = Clock::now() + step_duration;
+
+  try {
+    while(!simulation_stopping.load(std::memory_order_relaxed)) {
+      std::this_thread::sleep_until(next_tick);
+      simulate(step);
+      next_tick += step_duration;
+
+      // stalled for a long time (debugger, suspended machine); skip ahead rather than replaying it all
+      auto now = Clock::now();
+      if(now - next_tick > step_duration * MAX_SIMULATION_BACKLOG)
+        next_tick = now;
+    }
+  } catch(...) {
+    simulation_error = std::current_exception();
+    close_requested = true;
   }
-
-  vkCmdPipelineBarrier(command_buffer, source_stage, destination_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-  end_single_time_commands(command_buffer);
 }
 
-auto VulkanApplication::copy_buffer_to_image(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) -> void {
-  VkCommandBuffer command_buffer = begin_single_time_commands();
-
-  VkBufferImageCopy region{};
-  region.bufferOffset = 0;
-  region.bufferRowLength = 0;
-  region.bufferImageHeight = 0;
+// advances the world by one tick and publishes it; runs on the simulation thread (and once on the
+// render thread before it starts)
+auto VulkanApplication::simulate(double step_seconds) -> void {
+  auto scope = cpu_profiler::Scope("simulate");
+  const float camera_move_speed = 20.0f;
+  auto distance = camera_move_speed * static_cast<float>(step_seconds);
+  auto keys = held_keys.load(std::memory_order_relaxed);
+
+  glm::vec3 movement{0.0f};
+  if(keys & KEY_FORWARD)  movement.z += distance;
+  if(keys & KEY_BACKWARD) movement.z -= distance;
+  if(keys & KEY_LEFT)     movement.x += distance;
+  if(keys & KEY_RIGHT)    movement.x -= distance;
+  // y-axis is inverted compared to OpenGL
+  if(keys & KEY_UP)       movement.y -= distance;
+  if(keys & KEY_DOWN)     movement.y += distance;
+  main_camera.move(movement);
+
+  simulation_time += step_seconds;
+  ++simulation_tick;
+
+  auto& snapshot = frame_states.write_slot();
+  snapshot.tick = simulation_tick;
+  snapshot.time = simulation_time;
+  snapshot.camera_position = main_camera.position;
+  snapshot.object_transforms.resize(object_positions.size()); // no allocation once all three slots have grown
+
+  auto angle = static_cast<float>(simulation_time) * glm::radians(90.0f);
+  jobs->parallel_for(0, object_positions.size(), TRANSFORM_GRAIN, [&](std::size_t begin, std::size_t end) {
+    auto scope = cpu_profiler::Scope("transforms");
+    for(auto i = begin; i < end; ++i) {
+      auto trans = glm::translate(glm::mat4(1.0f), object_positions[i]);
+      snapshot.object_transforms[i] = glm::rotate(trans, angle, glm::vec3(0.0f, 0.0f, 1.0f));
+    }
+  });
 
-  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-  region.imageSubresource.mipLevel = 0;
-  region.imageSubresource.baseArrayLayer = 0;
-  region.imageSubresource.layerCount = 1;
+  frame_states.publish();
+}
 
-  region.imageOffset = {0, 0, 0};
-  region.imageExtent = {width, height, 1};
+// glfw key state can only be queried on the main (render) thread
+auto VulkanApplication::sample_input(void) -> void {
+  uint32_t keys = 0;
+  if(glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)          keys |= KEY_FORWARD;
+  if(glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)          keys |= KEY_BACKWARD;
+  if(glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)          keys |= KEY_LEFT;
+  if(glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)          keys |= KEY_RIGHT;
+  if(glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)      keys |= KEY_UP;
+  if(glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) keys |= KEY_DOWN;
+  held_keys.store(keys, std::memory_order_relaxed);
+}
 
-  vkCmdCopyBufferToImage(command_buffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+auto VulkanApplication::create_shader_watcher(void) -> void {
+  if(!enable_shader_hot_reload) return;
 
-  end_single_time_commands(command_buffer);
+  shader_changes.create(SHADER_DIRECTORY, worker_pool);
+  std::cout << "[shader] watching " << SHADER_DIRECTORY << " for changes\n";
 }
 
-auto VulkanApplication::create_image_view(VkImage image, VkFormat format) -> VkImageView {
-  VkImageViewCreateInfo view_info{};
-  view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-  view_info.image = image;
-  view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
-  view_info.format = format;
-  view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-  view_info.subresourceRange.baseMipLevel = 0;
-  view_info.subresourceRange.levelCount = 1;
-  view_info.subresourceRange.baseArrayLayer = 0;
-  view_info.subresourceRange.layerCount = 1;
+// rebuilds the pipelines using any .spv that changed; a module that fails to load or link makes
+// the build throw, and the pipeline manager keeps the previous pipeline bound
+auto VulkanApplication::reload_changed_shaders(void) -> void {
+  if(!enable_shader_hot_reload) return;
 
-  VkImageView image_view;
-  if(vkCreateImageView(device, &view_info, nullptr, &image_view) != VK_SUCCESS)
-    throw std::runtime_error("Error - failed to create texture image view");
+  changed_shaders.clear();
+  shader_changes.poll(changed_shaders);
 
-  return image_view;
+  auto graphics_affected = std::any_of(changed_shaders.begin(), changed_shaders.end(), [](const auto& path) {
+    return path.filename() == std::filesystem::path(VERTEX_SHADER_PATH).filename()
+        || path.filename() == std::filesystem::path(VERTEX_ARENA_SHADER_PATH).filename()
+        || path.filename() == std::filesystem::path(FRAGMENT_SHADER_PATH).filename()
+        || path.filename() == std::filesystem::path(FRAGMENT_BINDLESS_SHADER_PATH).filename();
+  });
+
+  if(graphics_affected) {
+    std::cout << "[shader] rebuilding graphics pipeline\n";
+    create_graphics_pipeline();
+  }
 }
 
 auto VulkanApplication::update_glfw_delta_time(void) -> void {
@@ -1515,45 +2301,98 @@ auto VulkanApplication::update_glfw_delta_time(void) -> void {
 // ---- Rendering ----
 auto VulkanApplication::draw_frame(void) -> void {
   // wait for previous frame to finish so command buffer and semaphores are available to use
-  vkWaitForFences(device, 1, &fences_in_flight[current_frame], VK_TRUE, UINT64_MAX); // UINT64_MAX timeout
+  {
+    auto phase = frame_stats::Phase(frame_stats, "wait_fence", frame_stats::Metric::FenceWait);
+    vkWaitForFences(device, 1, &fences_in_flight[current_frame], VK_TRUE, UINT64_MAX); // UINT64_MAX timeout
+  }
+  readback.frame_complete(current_frame); // the copy this frame recorded last time has landed, export it
+  // upload semaphores this frame waited on last time are unsignalled again, hand them back
+  uploader.recycle_semaphores(upload_semaphores_in_flight[current_frame]);
+  pipelines.collect(); // pipelines replaced long enough ago are no longer referenced
+  reload_changed_shaders(); // frame boundary; rebuilt pipelines are swapped in once compiled
+  {
+    auto phase = frame_stats::Phase(frame_stats, "stream_textures");
+    stream_textures(); // this frame's descriptor sets are no longer in use either
+  }
+
+  // headless; the offscreen image belonging to this frame in flight is free once its fence is
+  uint32_t image_index = current_frame;
+  if(!config.headless) {
+    // aquire image from chosen device and swap chain, signal sem_image_available_render when finished
+    auto phase = frame_stats::Phase(frame_stats, "acquire", frame_stats::Metric::Acquire);
+    auto result = vkAcquireNextImageKHR(device, swap_chain, UINT64_MAX, semaphores_image_available_render[current_frame], VK_NULL_HANDLE, &image_index);
+    if(result == VK_ERROR_OUT_OF_DATE_KHR) {
+      recreate_swap_chain(); return; // recreate swap chain, try again on next call of draw_frame
+    } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+      throw std::runtime_error("Error - failed to acquire swap chain image");
+    }
+  }
 
-  uint32_t image_index;
-  // aquire image from chosen device and swap chain, signal sem_image_available_render when finished
-  auto result = vkAcquireNextImageKHR(device, swap_chain, UINT64_MAX, semaphores_image_available_render[current_frame], VK_NULL_HANDLE, &image_index);
-  if(result == VK_ERROR_OUT_OF_DATE_KHR) {
-    recreate_swap_chain(); return; // recreate swap chain, try again on next call of draw_frame
-  } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-    throw std::runtime_error("Error - failed to acquire swap chain image");
+  {
+    auto phase = frame_stats::Phase(frame_stats, "update_uniforms");
+    update_uniform_buffer(current_frame);
   }
+  // polls, recycling staging space of finished batches
+  if(uploader.is_complete(upload_ticket) && !upload_duration)
+    upload_duration = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - upload_start).count();
 
-  update_uniform_buffer(current_frame);
+  frame_acquire.clear();
+  uploader.take_acquires(frame_acquire);
 
   // reset fence to unsignaled state when done waiting, only submit when doing work
   vkResetFences(device, 1, &fences_in_flight[current_frame]);
 
   // ensure command buffer can be recorded by resetting
   vkResetCommandBuffer(command_buffers[current_frame], 0);
-  record_command_buffer(command_buffers[current_frame], image_index);
+  auto record_start = std::chrono::high_resolution_clock::now();
+  {
+    auto phase = frame_stats::Phase(frame_stats, "record");
+    record_command_buffer(command_buffers[current_frame], image_index);
+  }
+  // begin_frame just read back what this frame in flight rendered last time round
+  if(auto gpu_milliseconds = gpu_profiler.latest("frame"))
+    frame_stats.record(frame_stats::Metric::Gpu, static_cast<uint64_t>(*gpu_milliseconds * 1e6));
+  auto record_end = std::chrono::high_resolution_clock::now();
+  record_microseconds_total += std::chrono::duration<double, std::micro>(record_end - record_start).count();
+  ++recorded_frames;
 
   // queue submission and synchronization
-  VkSemaphore wait_semaphores[] = {semaphores_image_available_render[current_frame]}; // sems to wait for
+  // sems to wait for; the swap chain image, then any uploads whose ownership is acquired this frame
+  wait_semaphores.clear();
+  wait_stages.clear();
+  if(!config.headless) {
+    wait_semaphores.push_back(semaphores_image_available_render[current_frame]);
+    // render pass will wait for VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT (subpass in create_render_pass)
+    wait_stages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+  }
+  for(auto semaphore : frame_acquire.semaphores) {
+    wait_semaphores.push_back(semaphore);
+    wait_stages.push_back(upload::Acquire::STAGES);
+    upload_semaphores_in_flight[current_frame].push_back(semaphore);
+  }
   VkSemaphore signal_semaphores[] = {semaphores_render_finished_present[current_frame]}; // sems to signal
-  // render pass will wait for VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT (subpass in create_render_pass)
-  VkPipelineStageFlags wait_stages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
 
   VkSubmitInfo submit_info{};
   submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  submit_info.waitSemaphoreCount = 1;
-  submit_info.pWaitSemaphores = wait_semaphores; // wait until done
-  submit_info.pWaitDstStageMask = wait_stages;
+  submit_info.waitSemaphoreCount = static_cast<uint32_t>(wait_semaphores.size());
+  submit_info.pWaitSemaphores = wait_semaphores.data(); // wait until done
+  submit_info.pWaitDstStageMask = wait_stages.data();
   submit_info.commandBufferCount = 1;
   submit_info.pCommandBuffers = &command_buffers[current_frame];
-  submit_info.signalSemaphoreCount = 1;
+  submit_info.signalSemaphoreCount = config.headless ? 0 : 1; // nobody presents it
   submit_info.pSignalSemaphores = signal_semaphores; // signal when done
 
   // signal fence once command buffer finishes execution -> wait during next frame to finish
-  if(vkQueueSubmit(graphics_queue, 1, &submit_info, fences_in_flight[current_frame]) != VK_SUCCESS)
-    throw std::runtime_error("Error - failed to submit draw command buffer");
+  {
+    auto phase = frame_stats::Phase(frame_stats, "submit");
+    if(vkQueueSubmit(graphics_queue, 1, &submit_info, fences_in_flight[current_frame]) != VK_SUCCESS)
+      throw std::runtime_error("Error - failed to submit draw command buffer");
+  }
+
+  if(config.headless) {
+    current_frame = (current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
+    return;
+  }
 
   VkSwapchainKHR swap_chains[] = {swap_chain};
 
@@ -1566,7 +2405,11 @@ auto VulkanApplication::draw_frame(void) -> void {
   present_info.pImageIndices = &image_index;
   present_info.pResults = nullptr; // optional
 
-  result = vkQueuePresentKHR(present_queue, &present_info);
+  VkResult result;
+  {
+    auto phase = frame_stats::Phase(frame_stats, "present");
+    result = vkQueuePresentKHR(present_queue, &present_info);
+  }
   if(result == VK_ERROR_OUT_OF_DATE_KHR || 
      result == VK_SUBOPTIMAL_KHR || 
      framebuffer_resized) {
@@ -1606,12 +2449,16 @@ static auto check_validation_layer_support(void) -> bool {
   return true;
 }
 
-static auto message_callback_get_required_extensions(void) -> std::vector<const char*> {
-  uint32_t glfw_extension_count = 0;
-  const char** glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
-  std::vector<const char*> extensions(glfw_extensions, glfw_extensions + glfw_extension_count);
+static auto message_callback_get_required_extensions(bool with_surface, bool with_validation) -> std::vector<const char*> {
+  std::vector<const char*> extensions;
+  // surface extensions for the window; glfw is not even initialized when headless
+  if(with_surface) {
+    uint32_t glfw_extension_count = 0;
+    const char** glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
+    extensions.assign(glfw_extensions, glfw_extensions + glfw_extension_count);
+  }
 
-  if(vulkan::enable_validation_layers)
+  if(with_validation)
     extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 
   return extensions;
@@ -1721,7 +2568,276 @@ static auto create_shader_module(VkDevice device, const std::vector<char>& code)
   return shader_module;
 }
 
+// an empty fragment_path builds a depth only pipeline, for a subpass without colour attachments
+static auto build_graphics_pipeline(VkDevice device, VkPipelineCache cache, VkPipelineLayout pipeline_layout, VkRenderPass render_pass, uint32_t subpass, bool depth_write, const std::string& vertex_path, const std::string& fragment_path) -> VkPipeline {
+  auto depth_only = fragment_path.empty();
+
+  // src/vulkan.cpp -> shaders/vert.spv & shaders/frag.spv
+  auto vertex_shader_bytecode = read_file(vertex_path);
+  auto vertex_shader = create_shader_module(device, vertex_shader_bytecode);
+  auto fragment_shader = depth_only ? VK_NULL_HANDLE : create_shader_module(device, read_file(fragment_path));
+
+  VkPipelineShaderStageCreateInfo vert_shader_stage_info{};
+  vert_shader_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  vert_shader_stage_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
+  vert_shader_stage_info.module = vertex_shader;
+  vert_shader_stage_info.pName = "main"; // shader entry point -> can have different if so choose
+
+  VkPipelineShaderStageCreateInfo frag_shader_stage_info{};
+  frag_shader_stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  frag_shader_stage_info.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+  frag_shader_stage_info.module = fragment_shader;
+  frag_shader_stage_info.pName = "main";
+
+  VkPipelineShaderStageCreateInfo shader_stages[] = {vert_shader_stage_info, frag_shader_stage_info};
+  auto binding_description = VulkanVertex::get_vulkan_binding_description();
+  auto attribute_descriptions = VulkanVertex::get_vulkan_attribute_descriptions();
+
+  VkPipelineVertexInputStateCreateInfo vertex_input_info{};
+  vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+  vertex_input_info.vertexBindingDescriptionCount = 1;
+  vertex_input_info.pVertexBindingDescriptions = &binding_description; // optional
+  vertex_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(attribute_descriptions.size());
+  vertex_input_info.pVertexAttributeDescriptions = attribute_descriptions.data(); // optional
+
+  VkPipelineInputAssemblyStateCreateInfo input_assembly{};
+  input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+  input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+  input_assembly.primitiveRestartEnable = VK_FALSE;
+
+  // both viewport and scissor are dynamic states
+  // would use the following setup if they were static states
+  /*
+  VkViewport viewport{};
+  viewport.x = 0.f;
+  viewport.y = 0.f;
+  viewport.width = (float) swap_chain_extent.width;
+  viewport.height = (float) swap_chain_extent.height;
+  viewport.minDepth = 0.f;
+  viewport.maxDepth = 1.f;
+
+  VkRect2D scissor{}; // truncates framebuffer to specified extent, can be a dynamic state
+  scissor.offset = {0, 0};
+  scissor.extent = swap_chain_extent; // cover entire framebuffer with scissor
+
+  VkPipelineViewportStateCreateInfo viewport_state{};
+  viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+  viewport_state.viewportCount = 1;
+  viewport_state.pViewports = &viewport;
+  viewport_state.scissorCount = 1;
+  viewport_state.pScissors = &scissor;
+  */
+  VkPipelineViewportStateCreateInfo viewport_state{};
+  viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+  viewport_state.viewportCount = 1;
+  viewport_state.scissorCount = 1;
+
+  VkPipelineRasterizationStateCreateInfo rasterizer{};
+  rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+  rasterizer.depthClampEnable = VK_FALSE;
+  rasterizer.rasterizerDiscardEnable = VK_FALSE; // turning this on basically discards output to framebuffer
+  // fragment geometry generation
+  // can be;
+  // - VK_POLYGON_MODE_FILL
+  // - VK_POLYGON_MODE_LINE
+  // - VK_POLYGON_MODE_POINT
+  rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+  rasterizer.lineWidth = 1.0f; // 1 is max lineWidth without gpu feature
+  rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+  // front face counter clockwise, as glm y-coord representation of vertices passed as uniform must be inverted
+  rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE; //VK_FRONT_FACE_CLOCKWISE
+  rasterizer.depthBiasEnable = VK_FALSE; // allows to alter depth values
+  rasterizer.depthBiasConstantFactor = 0.0f; // optional
+  rasterizer.depthBiasClamp = 0.0f; // optional
+  rasterizer.depthBiasSlopeFactor = 0.0f; // optional
+
+  VkPipelineMultisampleStateCreateInfo multisampling{};
+  multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+  multisampling.sampleShadingEnable = VK_FALSE;
+  multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+  multisampling.minSampleShading = 1.0f; // optional
+  multisampling.pSampleMask = nullptr; // optional
+  multisampling.alphaToCoverageEnable = VK_FALSE; // optional
+  multisampling.alphaToOneEnable = VK_FALSE; // optional
+
+  // reverse-z; nearer is larger. or equal, so the colour subpass after a pre-pass passes exactly
+  // the fragments that wrote the depth
+  VkPipelineDepthStencilStateCreateInfo depth_stencil{};
+  depth_stencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+  depth_stencil.depthTestEnable = VK_TRUE;
+  depth_stencil.depthWriteEnable = depth_write ? VK_TRUE : VK_FALSE;
+  depth_stencil.depthCompareOp = VK_COMPARE_OP_GREATER_OR_EQUAL;
+  depth_stencil.depthBoundsTestEnable = VK_FALSE;
+  depth_stencil.stencilTestEnable = VK_FALSE;
+
+  // combine fragment shader color with color already in framebuffer (single framebuffer example)
+  VkPipelineColorBlendAttachmentState color_blend_attachment{}; // VkPipelineColorBlendStateCreateInfo contains GLOBAL color blending settings
+  // entire setup looks like the following;
+  // if (blendEnable) {
+  //   final_colour.rgb = (srcColorBlendFactor * new_colour.rgb) <colorBlendOp> (dstColorBlendFactor * old_colour.rgb);
+  //   final_colour.a = (srcAlphaBlendFactor * new_colour.a) <alphaBlendOp> (dstAlphaBlendFactor * old_colour.a);
+  // } else {
+  //     final_colour = new_colour;
+  // }
+  // final_colour = final_colour & colorWriteMask;
+  // -------------------------------------------
+  // currently imitating alpha blending;
+  // final_color.rgb = new_alpha * new_color + (1 - new_alpha) * old_color;
+  // final_color.a = new_alpha.a;
+  color_blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+  color_blend_attachment.blendEnable = VK_TRUE;
+  color_blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+  color_blend_attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+  color_blend_attachment.colorBlendOp = VK_BLEND_OP_ADD;
+  color_blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+  color_blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+  color_blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+  // references the array of structures for all of the framebuffers and allows to set 
+  // blend constants that can be used as blend factors in the above calculations
+  VkPipelineColorBlendStateCreateInfo color_blending{};
+  color_blending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+  color_blending.logicOpEnable = VK_FALSE;
+  color_blending.logicOp = VK_LOGIC_OP_COPY; // optional
+  color_blending.attachmentCount = depth_only ? 0 : 1;
+  color_blending.pAttachments = &color_blend_attachment;
+  color_blending.blendConstants[0] = 0.0f; // optional
+  color_blending.blendConstants[1] = 0.0f; // optional
+  color_blending.blendConstants[2] = 0.0f; // optional
+  color_blending.blendConstants[3] = 0.0f; // optional
+
+  std::vector<VkDynamicState> dynamic_states = {
+    VK_DYNAMIC_STATE_VIEWPORT,
+    VK_DYNAMIC_STATE_SCISSOR
+  };
+
+  VkPipelineDynamicStateCreateInfo dynamic_state{};
+  dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+  dynamic_state.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
+  dynamic_state.pDynamicStates = dynamic_states.data();
+
+  VkGraphicsPipelineCreateInfo pipeline_info{};
+  pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+  pipeline_info.stageCount = depth_only ? 1 : 2; // the vertex stage comes first
+  pipeline_info.pStages = shader_stages;
+  pipeline_info.pVertexInputState = &vertex_input_info;
+  pipeline_info.pInputAssemblyState = &input_assembly;
+  pipeline_info.pViewportState = &viewport_state;
+  pipeline_info.pRasterizationState = &rasterizer;
+  pipeline_info.pMultisampleState = &multisampling;
+  pipeline_info.pDepthStencilState = &depth_stencil;
+  pipeline_info.pColorBlendState = &color_blending;
+  pipeline_info.pDynamicState = &dynamic_state;
+  pipeline_info.layout = pipeline_layout;
+  pipeline_info.renderPass = render_pass;
+  pipeline_info.subpass = subpass;
+
+  // the cache lets the driver skip compiling anything it has seen before, including on previous launches
+  VkPipeline graphics_pipeline;
+  auto result = vkCreateGraphicsPipelines(device, cache, 1, &pipeline_info, nullptr, &graphics_pipeline);
+
+  vkDestroyShaderModule(device, vertex_shader, nullptr);
+  if(!depth_only)
+    vkDestroyShaderModule(device, fragment_shader, nullptr);
+
+  if(result != VK_SUCCESS)
+    throw std::runtime_error("Error - failed to create graphics pipeline");
+
+  return graphics_pipeline;
+}
+
 static auto framebuffer_resize_callback(GLFWwindow* window, int width, int height) -> void {
   auto app = reinterpret_cast<vulkan::VulkanApplication*>(glfwGetWindowUserPointer(window));
   app->framebuffer_resized = true;
 }
+
+// a disc of rings around a centre vertex; the index picks the tessellation, so meshes differ in size
+static auto generate_mesh(std::size_t index, std::vector<VulkanVertex>& vertices, std::vector<uint16_t>& indices) -> vulkan::MeshRange {
+  auto sides = static_cast<uint32_t>(3 + (index * 5) % 30);
+  auto rings = static_cast<uint32_t>(1 + index % 4);
+
+  vulkan::MeshRange mesh{};
+  mesh.first_index = static_cast<uint32_t>(indices.size());
+  mesh.vertex_offset = static_cast<int32_t>(vertices.size()); // indices are relative to it
+
+  auto colour = glm::vec3((index * 37 % 256) / 255.0f, (index * 91 % 256) / 255.0f, (index * 173 % 256) / 255.0f);
+  vertices.emplace_back(glm::vec3(0.0f), colour, glm::vec2(0.5f));
+  for(uint32_t ring = 1; ring <= rings; ++ring) {
+    auto radius = 0.5f * static_cast<float>(ring) / static_cast<float>(rings);
+    for(uint32_t side = 0; side < sides; ++side) {
+      auto angle = glm::two_pi<float>() * static_cast<float>(side) / static_cast<float>(sides);
+      auto position = glm::vec3(std::cos(angle) * radius, std::sin(angle) * radius, 0.0f);
+      vertices.emplace_back(position, colour, glm::vec2(position) + 0.5f);
+    }
+  }
+
+  // counter-clockwise, like the quad; a fan around the centre, then a strip of quads per ring
+  auto first_of_ring = [sides](uint32_t ring) { return 1 + (ring - 1) * sides; };
+  for(uint32_t side = 0; side < sides; ++side) {
+    auto next = (side + 1) % sides;
+    for(auto i : {0u, first_of_ring(1) + side, first_of_ring(1) + next})
+      indices.push_back(static_cast<uint16_t>(i));
+
+    for(uint32_t ring = 2; ring <= rings; ++ring) {
+      auto inner = first_of_ring(ring - 1);
+      auto outer = first_of_ring(ring);
+      for(auto i : {inner + side, outer + side, outer + next, outer + next, inner + next, inner + side})
+        indices.push_back(static_cast<uint16_t>(i));
+    }
+  }
+
+  mesh.index_count = static_cast<uint32_t>(indices.size()) - mesh.first_index;
+  return mesh;
+}
+
+// rgba8 checkerboard of 8x8 cells in a colour picked by the index
+static auto generate_texture(std::size_t index, uint32_t size) -> std::vector<unsigned char> {
+  std::array<unsigned char, 3> colour = {
+    static_cast<unsigned char>(index * 67 % 256),
+    static_cast<unsigned char>(index * 131 % 256),
+    static_cast<unsigned char>(index * 199 % 256)
+  };
+  auto cell = std::max<uint32_t>(size / 8, 1);
+
+  std::vector<unsigned char> pixels(static_cast<std::size_t>(size) * size * 4);
+  for(uint32_t y = 0; y < size; ++y) {
+    for(uint32_t x = 0; x < size; ++x) {
+      auto dark = ((x / cell) + (y / cell)) % 2 == 1;
+      auto* pixel = &pixels[(static_cast<std::size_t>(y) * size + x) * 4];
+      for(std::size_t c = 0; c < 3; ++c)
+        pixel[c] = dark ? static_cast<unsigned char>(colour[c] / 4) : colour[c];
+      pixel[3] = 255;
+    }
+  }
+  return pixels;
+}
+
+// <stem>.<anything>.ktx2 beside the source image (example_a.bc7.ktx2, example_a.astc.ktx2, ...). only
+// their headers are read here, the levels of the one chosen are loaded once the device is known;
+// best format first (ktx::format_preference), then name order. one with a bad header is skipped
+static auto find_texture_variants(const std::string& path) -> std::vector<vulkan::TextureVariant> {
+  auto source = std::filesystem::path(path);
+  auto prefix = source.stem().string() + ".";
+
+  std::vector<std::filesystem::path> candidates;
+  std::error_code error;
+  for(const auto& entry : std::filesystem::directory_iterator(source.parent_path(), error)) {
+    auto name = entry.path().filename().string();
+    if(entry.path().extension() == ".ktx2" && name.starts_with(prefix))
+      candidates.push_back(entry.path());
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  std::vector<vulkan::TextureVariant> variants;
+  for(const auto& candidate : candidates) {
+    try {
+      variants.push_back({candidate, ktx::load_header(candidate)});
+    } catch(const std::exception& e) {
+      std::cerr << "[texture] skipping " << candidate.string() << ": " << e.what() << "\n";
+    }
+  }
+  std::stable_sort(variants.begin(), variants.end(), [](const auto& a, const auto& b) {
+    return ktx::format_preference(a.header.format) < ktx::format_preference(b.header.format);
+  });
+  return variants;
+}
@@ -0,0 +1,157 @@
+#include <filesystem>
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "asset_pack.h"
+
+TEST(test_asset_pack, test_asset_pack_parse_obj) {
+  // a quad as one polygon with texture coordinates, then a triangle reusing two of its corners
+  std::string obj =
+    "# quad\n"
+    "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+    "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+    "vn 0 0 1\n"
+    "f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+    "f -4/1 -2/3 -1/4\n";
+
+  std::vector<asset_pack::Vertex> vertices;
+  std::vector<uint16_t> indices;
+  asset_pack::parse_obj(obj, vertices, indices);
+
+  ASSERT_EQ(vertices.size(), 4u); // corners are shared between faces
+  EXPECT_EQ(indices, (std::vector<uint16_t>{0, 1, 2, 0, 2, 3, 0, 2, 3}));
+  EXPECT_FLOAT_EQ(vertices[2].position[0], 1.0f);
+  EXPECT_FLOAT_EQ(vertices[2].uv[1], 0.0f); // flipped to the top left origin
+  EXPECT_FLOAT_EQ(vertices[0].colour[0], 1.0f);
+
+  EXPECT_THROW(asset_pack::parse_obj("v 0 0 0\nf 1 2 3\n", vertices, indices), std::runtime_error);
+  EXPECT_THROW(asset_pack::parse_obj("v 0 0 0\nv 1 0 0\nf 1 2\n", vertices, indices), std::runtime_error);
+}
+
+TEST(test_asset_pack, test_asset_pack_round_trip) {
+  auto path = (std::filesystem::temp_directory_path() / "test_asset_pack_round_trip.pack").string();
+
+  std::vector<unsigned char> pixels(5 * 3 * 4, 200);
+  std::vector<asset_pack::Vertex> vertices(3);
+  vertices[1].position[0] = 2.0f;
+  std::vector<uint16_t> indices = {0, 1, 2};
+
+  std::vector<asset_pack::CookedAsset> cooked = {
+    asset_pack::cook_texture("wall.png", 7, pixels.data(), 5, 3),
+    asset_pack::cook_mesh("tri.obj", 9, vertices, indices)
+  };
+  asset_pack::write(path, cooked);
+
+  asset_pack::Pack pack;
+  pack.create(path);
+  ASSERT_EQ(pack.entries().size(), 2u);
+  EXPECT_EQ(pack.count(asset_pack::AssetType::Texture), 1u);
+  EXPECT_EQ(pack.find("missing"), nullptr);
+
+  const auto* texture = pack.find("wall.png");
+  ASSERT_NE(texture, nullptr);
+  EXPECT_EQ(texture->source_hash, 7u);
+  EXPECT_EQ(texture->mip_levels, 3u); // 5x3, 2x1, 1x1
+  EXPECT_EQ(texture->offset % asset_pack::DATA_ALIGNMENT, 0u);
+
+  auto levels = asset_pack::texture_levels(*texture);
+  ASSERT_EQ(levels.size(), 3u);
+  EXPECT_EQ(levels.back().offset + levels.back().size, texture->size);
+  EXPECT_EQ(memcmp(pack.data(*texture), cooked[0].data.data(), cooked[0].data.size()), 0);
+
+  const auto* mesh = pack.find("tri.obj");
+  ASSERT_NE(mesh, nullptr);
+  EXPECT_EQ(mesh->offset % asset_pack::DATA_ALIGNMENT, 0u);
+  EXPECT_EQ(mesh->vertex_count, 3u);
+  EXPECT_EQ(mesh->index_count, 3u);
+  asset_pack::Vertex second{};
+  memcpy(&second, pack.data(*mesh) + sizeof(asset_pack::Vertex), sizeof(second));
+  EXPECT_FLOAT_EQ(second.position[0], 2.0f);
+
+  pack.destroy();
+  EXPECT_FALSE(pack.is_open());
+  std::filesystem::remove(path);
+}
+
+TEST(test_asset_pack, test_asset_pack_rejects_truncated) {
+  auto path = (std::filesystem::temp_directory_path() / "test_asset_pack_truncated.pack").string();
+
+  std::vector<unsigned char> pixels(4 * 4 * 4, 0);
+  asset_pack::write(path, {asset_pack::cook_texture("a.png", 1, pixels.data(), 4, 4)});
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8); // into the table
+
+  asset_pack::Pack pack;
+  EXPECT_THROW(pack.create(path), std::runtime_error);
+  EXPECT_THROW(pack.create(path + ".missing"), std::runtime_error);
+  std::filesystem::remove(path);
+}
+
+TEST(test_asset_pack, test_asset_pack_rejects_corrupt_entries) {
+  auto path = (std::filesystem::temp_directory_path() / "test_asset_pack_corrupt.pack").string();
+
+  std::vector<unsigned char> pixels(4 * 4 * 4, 0);
+  std::vector<asset_pack::Vertex> vertices(3);
+  std::vector<uint16_t> indices = {0, 1, 2};
+  auto texture = asset_pack::cook_texture("a.png", 1, pixels.data(), 4, 4);
+  auto mesh = asset_pack::cook_mesh("a.obj", 2, vertices, indices);
+
+  auto rejects = [&path](const asset_pack::CookedAsset& asset) {
+    asset_pack::write(path, {asset});
+    asset_pack::Pack pack;
+    EXPECT_THROW(pack.create(path), std::runtime_error);
+    EXPECT_FALSE(pack.is_open());
+  };
+
+  auto corrupt = texture;
+  corrupt.entry.mip_levels = 4; // 4x4 has 3
+  rejects(corrupt);
+
+  corrupt.entry.mip_levels = 40; // would shift the width past 32 bits
+  rejects(corrupt);
+
+  corrupt = texture;
+  corrupt.entry.format = VK_FORMAT_BC7_SRGB_BLOCK;
+  rejects(corrupt);
+
+  corrupt = texture;
+  corrupt.data.resize(corrupt.data.size() - 4); // a texel short of its last level
+  rejects(corrupt);
+
+  corrupt = mesh;
+  corrupt.entry.vertex_count += 1;
+  rejects(corrupt);
+
+  corrupt = mesh;
+  corrupt.entry.type = static_cast<asset_pack::AssetType>(7);
+  rejects(corrupt);
+
+  std::filesystem::remove(path);
+}
+
+TEST(test_asset_pack, test_asset_pack_map_matches_read) {
+  auto path = (std::filesystem::temp_directory_path() / "test_asset_pack_map.pack").string();
+
+  std::vector<unsigned char> pixels(8 * 8 * 4);
+  for(std::size_t i = 0; i < pixels.size(); ++i)
+    pixels[i] = static_cast<unsigned char>(i);
+  asset_pack::write(path, {asset_pack::cook_texture("a.png", 1, pixels.data(), 8, 8)});
+
+  asset_pack::Pack mapped, read;
+  mapped.create(path, asset_pack::LoadMode::Map);
+  read.create(path, asset_pack::LoadMode::Read);
+
+  EXPECT_EQ(mapped.bytes_copied(), 0u);
+  EXPECT_EQ(read.bytes_copied(), read.size());
+  ASSERT_EQ(mapped.size(), read.size());
+
+  const auto& entry = mapped.entries()[0];
+  EXPECT_EQ(memcmp(mapped.data(entry), read.data(read.entries()[0]), static_cast<std::size_t>(entry.size)), 0);
+
+  mapped.destroy();
+  read.destroy();
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,37 @@
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "bindless.h"
+
+TEST(test_bindless, test_bindless_slots_in_order) {
+  auto slots = bindless::SlotAllocator(3, 2);
+
+  EXPECT_EQ(slots.allocate(), 0u);
+  EXPECT_EQ(slots.allocate(), 1u);
+  EXPECT_EQ(slots.allocate(), 2u);
+  EXPECT_FALSE(slots.allocate().has_value());
+  EXPECT_EQ(slots.in_use(), 3u);
+  EXPECT_EQ(slots.high_water_mark(), 3u);
+
+  EXPECT_THROW(bindless::SlotAllocator(3, 2).free(0), std::runtime_error);
+}
+
+TEST(test_bindless, test_bindless_slots_retire) {
+  auto slots = bindless::SlotAllocator(2, 2);
+  auto a = slots.allocate();
+  auto b = slots.allocate();
+  ASSERT_TRUE(a.has_value() && b.has_value());
+
+  // frames in flight may still sample the slot, it is not handed out again until they are done
+  slots.free(*a);
+  EXPECT_FALSE(slots.allocate().has_value());
+  slots.next_frame();
+  EXPECT_FALSE(slots.allocate().has_value());
+  slots.next_frame();
+  EXPECT_EQ(slots.in_use(), 1u);
+
+  EXPECT_EQ(slots.allocate(), a);
+  EXPECT_EQ(slots.high_water_mark(), 2u); // reused, the array did not grow
+}
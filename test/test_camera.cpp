@@ -24,4 +24,26 @@ TEST(test_camera, test_camera_move) {
 
   auto test = glm::vec3(2.0f, 4.0f, 6.0f);
   EXPECT_EQ(cam.position, test);
-}
\ No newline at end of file
+}
+TEST(test_camera, test_camera_reverse_z_depth) {
+  auto projection = camera::reverse_z_perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f);
+  auto depth = [&](float distance) {
+    auto clip = projection * glm::vec4(0.0f, 0.0f, -distance, 1.0f);
+    return clip.z / clip.w;
+  };
+
+  EXPECT_FLOAT_EQ(depth(0.1f), 1.0f); // near plane
+  EXPECT_FLOAT_EQ(depth(1000.0f), 0.0001f);
+  EXPECT_GT(depth(10.0f), depth(10.01f)); // nearer is larger
+  EXPECT_GT(depth(1e6f), 0.0f); // no far plane to clip against
+}
+
+TEST(test_camera, test_camera_reverse_z_aspect) {
+  auto projection = camera::reverse_z_perspective(glm::radians(90.0f), 2.0f, 0.1f);
+
+  // 90 degrees vertically: the top edge of the frustum is as far up as it is away
+  auto top = projection * glm::vec4(0.0f, 5.0f, -5.0f, 1.0f);
+  EXPECT_FLOAT_EQ(top.y / top.w, 1.0f);
+  auto right = projection * glm::vec4(10.0f, 0.0f, -5.0f, 1.0f);
+  EXPECT_FLOAT_EQ(right.x / right.w, 1.0f);
+}
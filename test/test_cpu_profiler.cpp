@@ -0,0 +1,153 @@
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "cpu_profiler.h"
+
+static auto occurrences(const std::string& text, const std::string& pattern) -> std::size_t {
+  std::size_t count = 0;
+  for(auto at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + pattern.size()))
+    ++count;
+  return count;
+}
+
+TEST(test_cpu_profiler, test_cpu_profiler_scope) {
+  auto begin = cpu_profiler::now_nanoseconds();
+  cpu_profiler::set_thread_name("test \"main\"");
+  {
+    auto outer = cpu_profiler::Scope("test_scope_outer");
+    auto inner = cpu_profiler::Scope("test_scope_inner");
+  }
+  auto end = cpu_profiler::now_nanoseconds();
+
+  auto trace = std::ostringstream();
+  EXPECT_GE(cpu_profiler::write_chrome_trace(trace, begin, end + 1), 2u);
+  EXPECT_EQ(occurrences(trace.str(), "\"name\":\"test_scope_outer\",\"ph\":\"X\""), 1u);
+  EXPECT_EQ(occurrences(trace.str(), "\"name\":\"test_scope_inner\",\"ph\":\"X\""), 1u);
+  EXPECT_EQ(occurrences(trace.str(), "\"args\":{\"name\":\"test \\\"main\\\"\"}"), 1u);
+
+  // outside the range, nothing
+  auto later = std::ostringstream();
+  cpu_profiler::write_chrome_trace(later, end + 1, end + 2);
+  EXPECT_EQ(occurrences(later.str(), "test_scope_outer"), 0u);
+}
+
+TEST(test_cpu_profiler, test_cpu_profiler_ticks_to_nanoseconds) {
+  auto begin_ticks = cpu_profiler::now_ticks();
+  auto begin = cpu_profiler::now_nanoseconds();
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  auto end = cpu_profiler::now_nanoseconds();
+  auto end_ticks = cpu_profiler::now_ticks();
+
+  // the tick span holds the clock span, give or take the calibration's error
+  auto elapsed = static_cast<double>(cpu_profiler::ticks_to_nanoseconds(end_ticks - begin_ticks));
+  EXPECT_NEAR(elapsed, static_cast<double>(end - begin), 0.05 * static_cast<double>(end - begin));
+}
+
+TEST(test_cpu_profiler, test_cpu_profiler_disabled) {
+  auto begin = cpu_profiler::now_nanoseconds();
+  cpu_profiler::set_enabled(false);
+  {
+    auto scope = cpu_profiler::Scope("test_scope_disabled");
+  }
+  cpu_profiler::set_enabled(true);
+
+  auto trace = std::ostringstream();
+  cpu_profiler::write_chrome_trace(trace, begin, cpu_profiler::now_nanoseconds() + 1);
+  EXPECT_EQ(occurrences(trace.str(), "test_scope_disabled"), 0u);
+}
+
+TEST(test_cpu_profiler, test_cpu_profiler_ring_overwrites) {
+  auto begin = cpu_profiler::now_nanoseconds();
+  auto total = cpu_profiler::ThreadBuffer::CAPACITY + 100;
+
+  // a fresh thread, so its buffer only holds these
+  auto writer = std::thread([total] {
+    for(std::size_t i = 0; i < total; ++i)
+      auto scope = cpu_profiler::Scope("test_scope_ring");
+  });
+  writer.join();
+
+  auto trace = std::ostringstream();
+  cpu_profiler::write_chrome_trace(trace, begin, cpu_profiler::now_nanoseconds() + 1);
+  EXPECT_EQ(occurrences(trace.str(), "\"test_scope_ring\""), cpu_profiler::ThreadBuffer::CAPACITY);
+}
+
+TEST(test_cpu_profiler, test_cpu_profiler_concurrent_dump) {
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> writers;
+  for(int t = 0; t < 3; ++t) {
+    writers.emplace_back([&stop] {
+      // wraps the ring a few times over; yields now and then so the dumps get a look in on small machines
+      for(std::size_t i = 0; i < cpu_profiler::ThreadBuffer::CAPACITY * 4 && !stop.load(std::memory_order_relaxed); ++i) {
+        auto scope = cpu_profiler::Scope("test_scope_concurrent");
+        if(i % 256 == 0) std::this_thread::yield();
+      }
+    });
+  }
+
+  // every event read while the writers wrap around their rings is either whole or left out
+  for(int i = 0; i < 5; ++i) {
+    auto trace = std::ostringstream();
+    cpu_profiler::write_chrome_trace(trace, 0, UINT64_MAX);
+    EXPECT_EQ(occurrences(trace.str(), "\"name\":null"), 0u);
+    EXPECT_EQ(trace.str().substr(trace.str().size() - 4), "\n]}\n");
+  }
+
+  stop = true;
+  for(auto& writer : writers)
+    writer.join();
+}
+
+TEST(test_cpu_profiler, test_cpu_profiler_capture) {
+  auto path = std::filesystem::temp_directory_path() / "test_cpu_profiler_capture.json";
+  std::filesystem::remove(path);
+
+  auto capture = cpu_profiler::Capture();
+  EXPECT_FALSE(capture.active());
+  capture.start(3, path);
+
+  for(int frame = 0; frame < 3; ++frame) {
+    EXPECT_TRUE(capture.active());
+    {
+      auto scope = cpu_profiler::Scope("test_scope_frame");
+    }
+    EXPECT_EQ(capture.frame(), frame == 2);
+  }
+  EXPECT_FALSE(capture.active());
+  EXPECT_FALSE(capture.frame());
+
+  auto file = std::ifstream(path);
+  auto contents = std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  EXPECT_EQ(contents.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0u);
+  EXPECT_EQ(occurrences(contents, "\"test_scope_frame\""), 3u);
+  std::filesystem::remove(path);
+}
+
+TEST(test_cpu_profiler, test_cpu_profiler_capture_finish) {
+  auto path = std::filesystem::temp_directory_path() / "test_cpu_profiler_capture_finish.json";
+  std::filesystem::remove(path);
+
+  // stopped after 1 of 10 frames; what was captured is still written
+  auto capture = cpu_profiler::Capture();
+  capture.start(10, path);
+  {
+    auto scope = cpu_profiler::Scope("test_scope_finish");
+  }
+  EXPECT_FALSE(capture.frame());
+  EXPECT_TRUE(capture.finish());
+  EXPECT_FALSE(capture.active());
+  EXPECT_FALSE(capture.finish());
+
+  auto file = std::ifstream(path);
+  auto contents = std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  EXPECT_EQ(occurrences(contents, "\"test_scope_finish\""), 1u);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,60 @@
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "descriptors.h"
+
+static auto make_binding(uint32_t binding, VkDescriptorType type, VkShaderStageFlags stages) -> VkDescriptorSetLayoutBinding {
+  VkDescriptorSetLayoutBinding layout_binding{};
+  layout_binding.binding = binding;
+  layout_binding.descriptorType = type;
+  layout_binding.descriptorCount = 1;
+  layout_binding.stageFlags = stages;
+  return layout_binding;
+}
+
+TEST(test_descriptors, test_descriptors_pool_growth) {
+  auto sizes = descriptors::pool_sizes({{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1}, {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4}}, 8);
+  ASSERT_EQ(sizes.size(), 2u);
+  EXPECT_EQ(sizes[0].descriptorCount, 8u);
+  EXPECT_EQ(sizes[1].descriptorCount, 32u);
+
+  EXPECT_EQ(descriptors::next_pool_sets(8), 16u);
+  EXPECT_EQ(descriptors::next_pool_sets(descriptors::MAX_POOL_SETS), descriptors::MAX_POOL_SETS);
+}
+
+TEST(test_descriptors, test_descriptors_layout_key) {
+  auto ubo = make_binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT);
+  auto sampler = make_binding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+
+  // the order bindings are listed in does not matter
+  auto a = descriptors::make_layout_key({ubo, sampler});
+  auto b = descriptors::make_layout_key({sampler, ubo});
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(descriptors::LayoutKeyHash{}(a), descriptors::LayoutKeyHash{}(b));
+  EXPECT_EQ(a.bindings[0].binding, 0u);
+
+  auto other_stage = sampler;
+  other_stage.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+  EXPECT_FALSE(a == descriptors::make_layout_key({ubo, other_stage}));
+  EXPECT_FALSE(a == descriptors::make_layout_key({ubo, sampler}, {0, VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT}));
+  EXPECT_THROW(descriptors::make_layout_key({ubo, sampler}, {0}), std::runtime_error);
+}
+
+TEST(test_descriptors, test_descriptors_set_key) {
+  descriptors::SetWrite uniforms{};
+  uniforms.binding = 0;
+  uniforms.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+  uniforms.range = 192;
+
+  descriptors::SetKey a{};
+  a.writes = {uniforms};
+  auto b = a;
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(descriptors::SetKeyHash{}(a), descriptors::SetKeyHash{}(b));
+
+  b.writes[0].range = 64;
+  EXPECT_FALSE(a == b);
+  EXPECT_NE(descriptors::SetKeyHash{}(a), descriptors::SetKeyHash{}(b));
+}
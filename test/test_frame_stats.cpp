@@ -0,0 +1,126 @@
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "frame_stats.h"
+
+TEST(test_frame_stats, test_frame_stats_buckets) {
+  using frame_stats::Histogram;
+
+  // exact below SUB_BUCKETS
+  for(uint64_t value = 0; value < Histogram::SUB_BUCKETS; ++value) {
+    EXPECT_EQ(Histogram::bucket_for(value), value);
+    EXPECT_EQ(Histogram::highest_in_bucket(Histogram::bucket_for(value)), value);
+  }
+
+  // above, every value lands in a bucket that contains it and is no wider than 1/64 of it
+  for(uint64_t value = Histogram::SUB_BUCKETS; value < (1ull << 36); value = value * 3 / 2 + 7) {
+    auto bucket = Histogram::bucket_for(value);
+    auto highest = Histogram::highest_in_bucket(bucket);
+    auto lowest = bucket == 0 ? 0 : Histogram::highest_in_bucket(bucket - 1) + 1;
+    EXPECT_LE(lowest, value);
+    EXPECT_GE(highest, value);
+    EXPECT_LE(highest - lowest, value / 64);
+  }
+
+  // clamped at the top
+  EXPECT_EQ(Histogram::bucket_for(UINT64_MAX), Histogram::BUCKET_COUNT - 1);
+}
+
+TEST(test_frame_stats, test_frame_stats_percentiles) {
+  auto histogram = frame_stats::Histogram();
+  EXPECT_EQ(histogram.percentile(50.0), 0u);
+
+  // 1..1000 microseconds
+  for(uint64_t i = 1; i <= 1000; ++i)
+    histogram.record(i * 1000);
+
+  EXPECT_EQ(histogram.count(), 1000u);
+  EXPECT_EQ(histogram.min(), 1000u);
+  EXPECT_EQ(histogram.max(), 1000000u);
+  EXPECT_DOUBLE_EQ(histogram.mean(), 500500.0);
+
+  for(auto [percentile, expected] : {std::pair{50.0, 500000.0}, {95.0, 950000.0}, {99.0, 990000.0}, {100.0, 1000000.0}}) {
+    auto value = static_cast<double>(histogram.percentile(percentile));
+    EXPECT_NEAR(value, expected, expected / 64) << percentile;
+  }
+
+  histogram.reset();
+  EXPECT_EQ(histogram.count(), 0u);
+  EXPECT_EQ(histogram.max(), 0u);
+}
+
+TEST(test_frame_stats, test_frame_stats_hitches) {
+  auto stats = frame_stats::FrameStats();
+  stats.create({10.0, 0, {}});
+
+  // a normal frame, then one spending 20ms waiting on its fence
+  stats.record(frame_stats::Metric::FenceWait, 1000000);
+  stats.record_phase("wait_fence", 1000000);
+  EXPECT_FALSE(stats.end_frame(5000000));
+
+  auto captured = std::ostringstream();
+  auto* previous = std::cout.rdbuf(captured.rdbuf());
+  stats.record_phase("record", 2000000);
+  stats.record(frame_stats::Metric::FenceWait, 20000000);
+  stats.record_phase("wait_fence", 20000000);
+  auto hitch = stats.end_frame(25000000);
+  std::cout.rdbuf(previous);
+
+  EXPECT_TRUE(hitch);
+  EXPECT_EQ(stats.hitches(), 1u);
+  EXPECT_EQ(stats.frames(), 2u);
+  EXPECT_NE(captured.str().find("[hitch] frame 1: 25.00ms"), std::string::npos) << captured.str();
+  EXPECT_NE(captured.str().find("in wait_fence"), std::string::npos) << captured.str();
+
+  // metrics only count frames that recorded them
+  EXPECT_EQ(stats.histogram(frame_stats::Metric::CpuFrame).count(), 2u);
+  EXPECT_EQ(stats.histogram(frame_stats::Metric::FenceWait).count(), 2u);
+  EXPECT_EQ(stats.histogram(frame_stats::Metric::Gpu).count(), 0u);
+  stats.destroy();
+}
+
+TEST(test_frame_stats, test_frame_stats_phase) {
+  auto stats = frame_stats::FrameStats();
+  stats.create({1.0, 0, {}});
+
+  auto captured = std::ostringstream();
+  auto* previous = std::cout.rdbuf(captured.rdbuf());
+  {
+    auto phase = frame_stats::Phase(stats, "test_phase_sleep", frame_stats::Metric::Acquire);
+    std::this_thread::sleep_for(std::chrono::milliseconds(3));
+  }
+  stats.end_frame(4000000);
+  std::cout.rdbuf(previous);
+
+  EXPECT_GE(stats.histogram(frame_stats::Metric::Acquire).min(), 3000000u);
+  EXPECT_NE(captured.str().find("in test_phase_sleep"), std::string::npos) << captured.str();
+  stats.destroy();
+}
+
+TEST(test_frame_stats, test_frame_stats_csv) {
+  auto path = std::filesystem::temp_directory_path() / "test_frame_stats_csv.csv";
+  std::filesystem::remove(path);
+
+  auto stats = frame_stats::FrameStats();
+  stats.create({0.0, 10, path});
+  for(int frame = 0; frame < 25; ++frame) {
+    stats.record(frame_stats::Metric::Gpu, 1000000);
+    stats.end_frame(2000000);
+  }
+  stats.destroy(); // frames 20-24 are the last, partial, interval
+
+  auto file = std::ifstream(path);
+  auto contents = std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  EXPECT_EQ(contents.rfind("first_frame,last_frame,metric,", 0), 0u);
+  EXPECT_NE(contents.find("\n0,9,cpu_frame,10,2.0000,"), std::string::npos) << contents;
+  EXPECT_NE(contents.find("\n10,19,gpu,10,1.0000,"), std::string::npos) << contents;
+  EXPECT_NE(contents.find("\n20,24,cpu_frame,5,"), std::string::npos) << contents;
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+#include "gpu_profiler.h"
+
+TEST(test_gpu_profiler, test_gpu_profiler_rolling_stats) {
+  auto stats = gpu_profiler::RollingStats();
+  EXPECT_EQ(stats.count(), 0u);
+  EXPECT_EQ(stats.avg(), 0.0);
+
+  stats.push(2.0);
+  stats.push(4.0);
+  stats.push(3.0);
+  EXPECT_EQ(stats.count(), 3u);
+  EXPECT_DOUBLE_EQ(stats.min(), 2.0);
+  EXPECT_DOUBLE_EQ(stats.avg(), 3.0);
+  EXPECT_DOUBLE_EQ(stats.max(), 4.0);
+  EXPECT_DOUBLE_EQ(stats.last(), 3.0);
+}
+
+TEST(test_gpu_profiler, test_gpu_profiler_rolling_window) {
+  auto stats = gpu_profiler::RollingStats();
+
+  // one slow sample, then a full window of fast ones pushes it out
+  stats.push(100.0);
+  for(std::size_t i = 0; i < gpu_profiler::RollingStats::WINDOW; ++i)
+    stats.push(1.0);
+
+  EXPECT_EQ(stats.count(), gpu_profiler::RollingStats::WINDOW);
+  EXPECT_DOUBLE_EQ(stats.max(), 1.0);
+  EXPECT_DOUBLE_EQ(stats.avg(), 1.0);
+}
+
+TEST(test_gpu_profiler, test_gpu_profiler_elapsed) {
+  // 1000 ticks of 1.5ns
+  EXPECT_DOUBLE_EQ(gpu_profiler::elapsed_milliseconds(5000, 6000, 64, 1.5f), 0.0015);
+
+  // a 36 bit counter that wrapped between begin and end
+  uint64_t top = (1ull << 36) - 100;
+  EXPECT_DOUBLE_EQ(gpu_profiler::elapsed_milliseconds(top, 400, 36, 1.0f), 500.0 / 1e6);
+
+  // bits above the valid ones are garbage and ignored
+  EXPECT_DOUBLE_EQ(gpu_profiler::elapsed_milliseconds(0xFF00000000000010ull, 0x00AA000000000020ull, 32, 1.0f), 16.0 / 1e6);
+}
+
+TEST(test_gpu_profiler, test_gpu_profiler_disabled) {
+  // never created (or created on a queue without timestamps); everything is a no-op
+  auto profiler = gpu_profiler::GpuProfiler();
+  EXPECT_FALSE(profiler.enabled());
+
+  profiler.begin_frame(VK_NULL_HANDLE, 0);
+  {
+    auto scope = gpu_profiler::Scope(profiler, VK_NULL_HANDLE, "frame");
+    EXPECT_EQ(profiler.begin_scope(VK_NULL_HANDLE, "nested"), gpu_profiler::GpuProfiler::INVALID_SCOPE);
+  }
+  EXPECT_TRUE(profiler.scopes().empty());
+
+  auto out = std::ostringstream();
+  profiler.report(out);
+  EXPECT_TRUE(out.str().empty());
+  profiler.destroy();
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <stdexcept>
+#include <atomic>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "job_system.h"
+
+TEST(test_job_system, test_spawn_and_wait) {
+  auto jobs = job_system::JobSystem(4);
+  EXPECT_EQ(jobs.size(), 4);
+
+  std::atomic<int> sum{0};
+  job_system::Counter counter;
+  for(int i = 1; i <= 1000; ++i)
+    jobs.spawn([&sum, i]{ sum += i; }, &counter);
+
+  jobs.wait(counter);
+  EXPECT_TRUE(counter.done());
+  EXPECT_EQ(sum.load(), 500500);
+}
+
+TEST(test_job_system, test_parallel_for_covers_range_once) {
+  auto jobs = job_system::JobSystem(3);
+
+  std::vector<std::atomic<int>> hits(10007);
+  jobs.parallel_for(0, hits.size(), 64, [&hits](std::size_t begin, std::size_t end) {
+    for(auto i = begin; i < end; ++i)
+      ++hits[i];
+  });
+
+  for(const auto& hit : hits)
+    EXPECT_EQ(hit.load(), 1);
+}
+
+TEST(test_job_system, test_then_runs_after_dependency) {
+  auto jobs = job_system::JobSystem(2);
+
+  std::atomic<int> finished{0};
+  std::atomic<int> seen_by_continuation{-1};
+  job_system::Counter first, second;
+
+  for(int i = 0; i < 100; ++i)
+    jobs.spawn([&finished]{ ++finished; }, &first);
+  jobs.then(first, [&]{ seen_by_continuation = finished.load(); }, &second);
+
+  jobs.wait(second);
+  EXPECT_EQ(seen_by_continuation.load(), 100);
+}
+
+TEST(test_job_system, test_no_workers_runs_on_caller) {
+  auto jobs = job_system::JobSystem(0);
+
+  int sum = 0;
+  jobs.parallel_for(0, 100, 7, [&sum](std::size_t begin, std::size_t end) {
+    for(auto i = begin; i < end; ++i)
+      sum += static_cast<int>(i);
+  });
+  EXPECT_EQ(sum, 4950);
+}
+
+TEST(test_job_system, test_parallel_for_rethrows) {
+  auto jobs = job_system::JobSystem(2);
+
+  EXPECT_THROW(jobs.parallel_for(0, 100, 1, [](std::size_t begin, std::size_t) {
+    if(begin == 42) throw std::runtime_error("Error - expected");
+  }), std::runtime_error);
+}
@@ -0,0 +1,127 @@
+#include <iostream>
+#include <stdexcept>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ktx.h"
+
+// a minimal ktx2 container: header, level index and the levels stored smallest first; no data
+// format descriptor or key/value data, which the loader never reads
+static auto make_ktx2(VkFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<unsigned char>>& levels, uint32_t supercompression = 0) -> std::vector<unsigned char> {
+  std::vector<unsigned char> bytes(80 + levels.size() * 24);
+  const unsigned char identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+  memcpy(bytes.data(), identifier, sizeof(identifier));
+
+  auto write = [&bytes](std::size_t offset, auto value) { memcpy(bytes.data() + offset, &value, sizeof(value)); };
+  write(12, static_cast<uint32_t>(format));
+  write(16, uint32_t{1}); // type size
+  write(20, width);
+  write(24, height);
+  write(36, uint32_t{1}); // faces
+  write(40, static_cast<uint32_t>(levels.size()));
+  write(44, supercompression);
+
+  for(auto level = levels.size(); level-- > 0;) {
+    write(80 + level * 24, static_cast<uint64_t>(bytes.size()));
+    write(80 + level * 24 + 8, static_cast<uint64_t>(levels[level].size()));
+    write(80 + level * 24 + 16, static_cast<uint64_t>(levels[level].size()));
+    bytes.insert(bytes.end(), levels[level].begin(), levels[level].end());
+  }
+  return bytes;
+}
+
+TEST(test_ktx, test_ktx_level_size) {
+  auto bc1 = *ktx::format_info(VK_FORMAT_BC1_RGBA_SRGB_BLOCK);
+  EXPECT_EQ(ktx::level_size(bc1, 256, 256), 64u * 64 * 8);
+  EXPECT_EQ(ktx::level_size(bc1, 1, 1), 8u); // partial blocks are stored whole
+
+  auto astc = *ktx::format_info(VK_FORMAT_ASTC_10x6_SRGB_BLOCK);
+  EXPECT_EQ(ktx::level_size(astc, 25, 12), 3u * 2 * 16);
+
+  EXPECT_FALSE(ktx::format_info(VK_FORMAT_R32G32B32A32_SFLOAT).has_value());
+}
+
+TEST(test_ktx, test_ktx_parse_levels) {
+  // 8x8 bc7: 4 blocks, 1 block, 1 block
+  std::vector<std::vector<unsigned char>> levels = {
+    std::vector<unsigned char>(64, 1),
+    std::vector<unsigned char>(16, 2),
+    std::vector<unsigned char>(16, 3)
+  };
+  auto bytes = make_ktx2(VK_FORMAT_BC7_SRGB_BLOCK, 8, 8, levels);
+  auto texture = ktx::parse(bytes.data(), bytes.size());
+
+  EXPECT_EQ(texture.format, VK_FORMAT_BC7_SRGB_BLOCK);
+  ASSERT_EQ(texture.levels.size(), 3u);
+  EXPECT_EQ(texture.levels[1].width, 4u);
+  EXPECT_EQ(texture.levels[2].width, 2u);
+  EXPECT_EQ(texture.levels[1].offset, 64u);
+  EXPECT_EQ(texture.data.size(), 96u);
+
+  // repacked largest first
+  EXPECT_EQ(texture.data[0], 1);
+  EXPECT_EQ(texture.data[texture.levels[1].offset], 2);
+  EXPECT_EQ(texture.data[texture.levels[2].offset], 3);
+}
+
+TEST(test_ktx, test_ktx_rejects) {
+  std::vector<std::vector<unsigned char>> levels = {std::vector<unsigned char>(16, 0)};
+
+  auto bytes = make_ktx2(VK_FORMAT_BC3_SRGB_BLOCK, 4, 4, levels);
+  bytes[1] = 'X';
+  EXPECT_THROW(ktx::parse(bytes.data(), bytes.size()), std::runtime_error);
+
+  bytes = make_ktx2(VK_FORMAT_BC3_SRGB_BLOCK, 4, 4, levels, 2); // zstd
+  EXPECT_THROW(ktx::parse(bytes.data(), bytes.size()), std::runtime_error);
+
+  bytes = make_ktx2(VK_FORMAT_BC1_RGB_SRGB_BLOCK, 4, 4, levels); // bc1 is 8 bytes a block
+  EXPECT_THROW(ktx::parse(bytes.data(), bytes.size()), std::runtime_error);
+
+  bytes = make_ktx2(VK_FORMAT_BC3_SRGB_BLOCK, 4, 4, levels);
+  bytes.resize(bytes.size() - 1);
+  EXPECT_THROW(ktx::parse(bytes.data(), bytes.size()), std::runtime_error);
+}
+
+TEST(test_ktx, test_ktx_parse_header) {
+  std::vector<std::vector<unsigned char>> levels = {std::vector<unsigned char>(64, 0), std::vector<unsigned char>(16, 0)};
+  auto bytes = make_ktx2(VK_FORMAT_ASTC_4x4_SRGB_BLOCK, 8, 8, levels);
+
+  // the header is all that is read, the levels need not be there
+  auto header = ktx::parse_header(bytes.data(), 80);
+  EXPECT_EQ(header.format, VK_FORMAT_ASTC_4x4_SRGB_BLOCK);
+  EXPECT_EQ(header.width, 8u);
+  EXPECT_EQ(header.level_count, 2u);
+  EXPECT_THROW(ktx::parse(bytes.data(), 80), std::runtime_error);
+
+  bytes = make_ktx2(VK_FORMAT_BC7_SRGB_BLOCK, 4, 4, {std::vector<unsigned char>(16, 0)});
+  uint32_t too_many = 4; // 4x4 has 3 levels
+  memcpy(bytes.data() + 40, &too_many, sizeof(too_many));
+  EXPECT_THROW(ktx::parse_header(bytes.data(), bytes.size()), std::runtime_error);
+}
+
+TEST(test_ktx, test_ktx_format_preference) {
+  EXPECT_LT(ktx::format_preference(VK_FORMAT_BC7_SRGB_BLOCK), ktx::format_preference(VK_FORMAT_ASTC_6x6_SRGB_BLOCK));
+  EXPECT_LT(ktx::format_preference(VK_FORMAT_ASTC_4x4_SRGB_BLOCK), ktx::format_preference(VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK));
+  EXPECT_LT(ktx::format_preference(VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK), ktx::format_preference(VK_FORMAT_BC1_RGB_SRGB_BLOCK));
+  EXPECT_LT(ktx::format_preference(VK_FORMAT_BC3_SRGB_BLOCK), ktx::format_preference(VK_FORMAT_R8G8B8A8_SRGB));
+}
+
+TEST(test_ktx, test_ktx_generates_missing_levels) {
+  // a level count of 0 stores level 0 alone
+  std::vector<std::vector<unsigned char>> levels = {std::vector<unsigned char>(4 * 4 * 4, 200)};
+  auto bytes = make_ktx2(VK_FORMAT_R8G8B8A8_UNORM, 4, 4, levels);
+  memset(bytes.data() + 40, 0, sizeof(uint32_t));
+
+  auto texture = ktx::parse(bytes.data(), bytes.size());
+  ASSERT_EQ(texture.levels.size(), 3u);
+  EXPECT_EQ(texture.levels[2].width, 1u);
+  EXPECT_EQ(texture.data.size(), (16u + 4 + 1) * 4);
+  EXPECT_EQ(texture.data[texture.levels[2].offset], 200); // a flat image filters to itself
+
+  // block compressed levels cannot be generated
+  bytes = make_ktx2(VK_FORMAT_BC7_SRGB_BLOCK, 4, 4, {std::vector<unsigned char>(16, 0)});
+  memset(bytes.data() + 40, 0, sizeof(uint32_t));
+  EXPECT_THROW(ktx::parse_header(bytes.data(), bytes.size()), std::runtime_error);
+}
@@ -0,0 +1,124 @@
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "memory.h"
+
+TEST(test_memory, test_block_allocator_creation) {
+  auto block = memory::BlockAllocator(1024);
+
+  auto stats = block.stats();
+  EXPECT_EQ(stats.capacity, 1024);
+  EXPECT_EQ(stats.free_bytes, 1024);
+  EXPECT_EQ(stats.largest_free_range, 1024);
+  EXPECT_TRUE(block.empty());
+}
+
+TEST(test_memory, test_block_allocator_alignment) {
+  auto block = memory::BlockAllocator(4096);
+
+  auto a = block.allocate(10, 1, memory::ResourceKind::Linear);
+  auto b = block.allocate(100, 256, memory::ResourceKind::Linear);
+  ASSERT_TRUE(a.has_value());
+  ASSERT_TRUE(b.has_value());
+
+  EXPECT_EQ(a->offset, 0);
+  EXPECT_EQ(b->offset % 256, 0);
+  EXPECT_GE(b->offset, a->offset + a->size);
+}
+
+TEST(test_memory, test_block_allocator_exhaustion) {
+  auto block = memory::BlockAllocator(1024);
+
+  EXPECT_TRUE(block.allocate(1024, 1, memory::ResourceKind::Linear).has_value());
+  EXPECT_FALSE(block.allocate(1, 1, memory::ResourceKind::Linear).has_value());
+  EXPECT_FALSE(memory::BlockAllocator(1024).allocate(2048, 1, memory::ResourceKind::Linear).has_value());
+}
+
+TEST(test_memory, test_block_allocator_coalescing) {
+  auto block = memory::BlockAllocator(1 << 20);
+
+  std::vector<memory::BlockRange> ranges;
+  for(int i = 0; i < 64; ++i) {
+    auto range = block.allocate(1000 + i, 16, memory::ResourceKind::Linear);
+    ASSERT_TRUE(range.has_value());
+    ranges.push_back(*range);
+  }
+
+  // free every other range first to force splintering, then the rest
+  for(std::size_t i = 0; i < ranges.size(); i += 2)
+    block.free(ranges[i].node);
+  EXPECT_GT(block.stats().fragmentation(), 0.0);
+
+  for(std::size_t i = 1; i < ranges.size(); i += 2)
+    block.free(ranges[i].node);
+
+  auto stats = block.stats();
+  EXPECT_TRUE(block.empty());
+  EXPECT_EQ(stats.free_range_count, 1);
+  EXPECT_EQ(stats.largest_free_range, 1 << 20);
+  EXPECT_EQ(stats.fragmentation(), 0.0);
+
+  // everything merged back, so the full block is available again
+  EXPECT_TRUE(block.allocate(1 << 20, 1, memory::ResourceKind::Linear).has_value());
+}
+
+TEST(test_memory, test_block_allocator_granularity) {
+  auto block = memory::BlockAllocator(1 << 16, 1024);
+
+  auto buffer = block.allocate(100, 4, memory::ResourceKind::Linear);
+  auto image = block.allocate(100, 4, memory::ResourceKind::Optimal);
+  auto next_buffer = block.allocate(100, 4, memory::ResourceKind::Linear);
+  ASSERT_TRUE(buffer && image && next_buffer);
+
+  // the image owns whole 1024 byte pages, so neither buffer can share one with it
+  EXPECT_EQ(image->offset % 1024, 0);
+  EXPECT_EQ(image->size % 1024, 0);
+  EXPECT_GE(image->offset, (buffer->offset + buffer->size + 1023) / 1024 * 1024);
+  EXPECT_TRUE(next_buffer->offset >= image->offset + image->size || next_buffer->offset + next_buffer->size <= image->offset);
+
+  // rounding the image up to a page is accounted as waste
+  EXPECT_EQ(block.stats().wasted_bytes(), 1024 - 100);
+}
+
+TEST(test_memory, test_block_allocator_reuse) {
+  auto block = memory::BlockAllocator(1 << 16);
+
+  auto a = block.allocate(4096, 1, memory::ResourceKind::Linear);
+  auto b = block.allocate(4096, 1, memory::ResourceKind::Linear);
+  ASSERT_TRUE(a && b);
+  block.free(a->node);
+
+  // the freed range is the exact fit, so it gets handed out again
+  auto c = block.allocate(4096, 1, memory::ResourceKind::Linear);
+  ASSERT_TRUE(c.has_value());
+  EXPECT_EQ(c->offset, a->offset);
+  EXPECT_EQ(block.stats().allocation_count, 2);
+
+  block.free(c->node);
+  EXPECT_THROW(block.free(c->node), std::invalid_argument);
+}
+
+TEST(test_memory, test_linear_allocator) {
+  auto arena = memory::LinearAllocator(1024);
+
+  auto a = arena.allocate(100, 256);
+  auto b = arena.allocate(100, 256);
+  ASSERT_TRUE(a && b);
+  EXPECT_EQ(*a, 0);
+  EXPECT_EQ(*b, 256);
+  EXPECT_EQ(arena.used(), 356);
+
+  // 512 is aligned but 512 + 600 does not fit
+  EXPECT_FALSE(arena.allocate(600, 256).has_value());
+  EXPECT_TRUE(arena.allocate(512, 256).has_value());
+  EXPECT_EQ(arena.used(), 1024);
+
+  // reset recycles everything at once, the high water mark survives it
+  arena.reset();
+  EXPECT_EQ(arena.used(), 0);
+  EXPECT_EQ(arena.high_water_mark(), 1024);
+  EXPECT_EQ(*arena.allocate(8, 256), 0);
+}
@@ -0,0 +1,71 @@
+#include <iostream>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "pipeline_cache.h"
+
+static auto make_properties(void) -> VkPhysicalDeviceProperties {
+  VkPhysicalDeviceProperties properties{};
+  properties.vendorID = 0x10de;
+  properties.deviceID = 0x2484;
+  properties.driverVersion = 42;
+  for(uint8_t i = 0; i < VK_UUID_SIZE; ++i)
+    properties.pipelineCacheUUID[i] = i;
+  return properties;
+}
+
+// what a driver would hand back from vkGetPipelineCacheData
+static auto make_blob(const VkPhysicalDeviceProperties& properties) -> std::vector<char> {
+  VkPipelineCacheHeaderVersionOne header{};
+  header.headerSize = sizeof(header);
+  header.headerVersion = VK_PIPELINE_CACHE_HEADER_VERSION_ONE;
+  header.vendorID = properties.vendorID;
+  header.deviceID = properties.deviceID;
+  memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+  std::vector<char> blob(sizeof(header) + 64, 'x');
+  memcpy(blob.data(), &header, sizeof(header));
+  return blob;
+}
+
+TEST(test_pipeline_cache, test_round_trip) {
+  auto properties = make_properties();
+  auto blob = make_blob(properties);
+
+  auto unwrapped = pipeline_cache::unwrap(pipeline_cache::wrap(blob, properties), properties);
+  ASSERT_TRUE(unwrapped.has_value());
+  EXPECT_EQ(*unwrapped, blob);
+}
+
+TEST(test_pipeline_cache, test_rejects_other_device_or_driver) {
+  auto properties = make_properties();
+  auto file = pipeline_cache::wrap(make_blob(properties), properties);
+
+  auto new_driver = properties;
+  new_driver.driverVersion += 1;
+  EXPECT_FALSE(pipeline_cache::unwrap(file, new_driver).has_value());
+
+  auto other_device = properties;
+  other_device.deviceID += 1;
+  EXPECT_FALSE(pipeline_cache::unwrap(file, other_device).has_value());
+
+  auto other_uuid = properties;
+  other_uuid.pipelineCacheUUID[0] ^= 0xff;
+  EXPECT_FALSE(pipeline_cache::unwrap(file, other_uuid).has_value());
+}
+
+TEST(test_pipeline_cache, test_rejects_corruption) {
+  auto properties = make_properties();
+  auto file = pipeline_cache::wrap(make_blob(properties), properties);
+
+  auto truncated = std::vector<char>(file.begin(), file.end() - 1);
+  EXPECT_FALSE(pipeline_cache::unwrap(truncated, properties).has_value());
+
+  auto flipped = file;
+  flipped.back() ^= 1;
+  EXPECT_FALSE(pipeline_cache::unwrap(flipped, properties).has_value());
+
+  EXPECT_FALSE(pipeline_cache::unwrap({}, properties).has_value());
+}
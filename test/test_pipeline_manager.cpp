@@ -0,0 +1,39 @@
+#include <iostream>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+
+#include "pipeline_manager.h"
+
+// builds never reach the driver here, any non-null handle stands in for a pipeline
+static auto fake_pipeline(uintptr_t value) -> VkPipeline {
+  return reinterpret_cast<VkPipeline>(value);
+}
+
+TEST(test_pipeline_manager, test_request_becomes_ready) {
+  auto pool = thread_pool::ThreadPool(2);
+  auto manager = pipeline_manager::PipelineManager();
+  manager.create(VK_NULL_HANDLE, VK_NULL_HANDLE, pool, 2);
+
+  auto handle = manager.request([](VkPipelineCache) { return fake_pipeline(0x10); });
+  EXPECT_EQ(manager.resolve(pipeline_manager::INVALID_PIPELINE, fake_pipeline(0x20)), fake_pipeline(0x20));
+
+  manager.wait(handle);
+  EXPECT_EQ(manager.state(handle), pipeline_manager::PipelineState::Ready);
+  EXPECT_EQ(manager.get(handle), fake_pipeline(0x10));
+  EXPECT_EQ(manager.pending_count(), 0);
+}
+
+TEST(test_pipeline_manager, test_failed_build) {
+  auto pool = thread_pool::ThreadPool(1);
+  auto manager = pipeline_manager::PipelineManager();
+  manager.create(VK_NULL_HANDLE, VK_NULL_HANDLE, pool, 2);
+
+  auto handle = manager.request([](VkPipelineCache) -> VkPipeline { throw std::runtime_error("Error - bad shader"); });
+  manager.wait(handle);
+
+  // nothing to bind, callers fall back
+  EXPECT_EQ(manager.state(handle), pipeline_manager::PipelineState::Failed);
+  EXPECT_EQ(manager.get(handle), VK_NULL_HANDLE);
+  EXPECT_EQ(manager.resolve(handle, fake_pipeline(0x20)), fake_pipeline(0x20));
+}
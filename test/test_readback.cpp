@@ -0,0 +1,135 @@
+#include <filesystem>
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <atomic>
+#include <vector>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "readback.h"
+
+static auto read_file(const std::filesystem::path& path) -> std::vector<uint8_t> {
+  auto file = std::ifstream(path, std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static auto read_u32_be(const uint8_t* data) -> uint32_t {
+  return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | uint32_t(data[3]);
+}
+
+TEST(test_readback, test_readback_crc32) {
+  const std::string iend = "IEND";
+  EXPECT_EQ(readback::crc32(reinterpret_cast<const uint8_t*>(iend.data()), iend.size()), 0xAE426082u);
+
+  // continuing a crc over a second buffer matches one pass over both
+  const std::string text = "123456789";
+  auto* bytes = reinterpret_cast<const uint8_t*>(text.data());
+  EXPECT_EQ(readback::crc32(bytes, text.size()), 0xCBF43926u);
+  EXPECT_EQ(readback::crc32(bytes + 4, 5, readback::crc32(bytes, 4)), 0xCBF43926u);
+}
+
+TEST(test_readback, test_readback_encode_png) {
+  // 2x1 bgra: pure red, pure blue
+  std::vector<uint8_t> pixels{0, 0, 255, 255, 255, 0, 0, 255};
+  auto frame = readback::Frame{pixels.data(), 2, 1, readback::PixelOrder::Bgra, 0};
+  auto png = readback::encode_png(frame);
+
+  const std::vector<uint8_t> signature{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  ASSERT_GT(png.size(), 8u + 25u);
+  EXPECT_TRUE(std::equal(signature.begin(), signature.end(), png.begin()));
+
+  // IHDR comes first: 13 bytes, then width, height, 8 bit truecolour
+  EXPECT_EQ(read_u32_be(png.data() + 8), 13u);
+  EXPECT_EQ(std::string(png.begin() + 12, png.begin() + 16), "IHDR");
+  EXPECT_EQ(read_u32_be(png.data() + 16), 2u);
+  EXPECT_EQ(read_u32_be(png.data() + 20), 1u);
+  EXPECT_EQ(png[24], 8);
+  EXPECT_EQ(png[25], 2);
+  EXPECT_EQ(read_u32_be(png.data() + 29), readback::crc32(png.data() + 12, 17));
+
+  // the only IDAT holds one stored block: filter byte, then the pixels swizzled to rgb
+  EXPECT_EQ(std::string(png.begin() + 37, png.begin() + 41), "IDAT");
+  const std::vector<uint8_t> scanline{0, 255, 0, 0, 0, 0, 255};
+  EXPECT_TRUE(std::equal(scanline.begin(), scanline.end(), png.begin() + 41 + 2 + 5));
+
+  EXPECT_EQ(std::string(png.end() - 8, png.end() - 4), "IEND");
+  EXPECT_EQ(read_u32_be(png.data() + png.size() - 4), 0xAE426082u);
+}
+
+TEST(test_readback, test_readback_encode_png_many_blocks) {
+  // rows longer than one stored block (65535 bytes) split across several
+  const uint32_t width = 30000, height = 3;
+  std::vector<uint8_t> pixels(width * height * 4, 7);
+  auto png = readback::encode_png(readback::Frame{pixels.data(), width, height, readback::PixelOrder::Rgba, 0});
+
+  auto idat_size = read_u32_be(png.data() + 33);
+  auto scanline_bytes = (width * 3 + 1) * height;
+  auto blocks = (scanline_bytes + 65534) / 65535;
+  EXPECT_EQ(idat_size, 2 + blocks * 5 + scanline_bytes + 4);
+}
+
+TEST(test_readback, test_readback_encode_ppm) {
+  std::vector<uint8_t> pixels{1, 2, 3, 255, 4, 5, 6, 255};
+  auto ppm = readback::encode_ppm(readback::Frame{pixels.data(), 1, 2, readback::PixelOrder::Rgba, 0});
+
+  const std::string header = "P6\n1 2\n255\n";
+  ASSERT_EQ(ppm.size(), header.size() + 6);
+  EXPECT_EQ(std::string(ppm.begin(), ppm.begin() + header.size()), header);
+  EXPECT_EQ(std::vector<uint8_t>(ppm.begin() + header.size(), ppm.end()), (std::vector<uint8_t>{1, 2, 3, 4, 5, 6}));
+}
+
+TEST(test_readback, test_readback_exporter_files) {
+  auto directory = std::filesystem::temp_directory_path() / "test_readback_exporter_files";
+  std::filesystem::remove_all(directory);
+
+  std::vector<uint8_t> pixels(4 * 4 * 4, 128);
+  std::atomic<int> released{0};
+  {
+    auto exporter = readback::FrameExporter();
+    exporter.create(readback::ExportFormat::Ppm, directory);
+    for(uint64_t number = 0; number < 3; ++number)
+      exporter.submit(readback::Frame{pixels.data(), 4, 4, readback::PixelOrder::Rgba, number}, [&released]{ ++released; });
+    exporter.wait_idle();
+    EXPECT_EQ(exporter.frames_written(), 3u);
+  }
+
+  EXPECT_EQ(released.load(), 3);
+  for(auto name : {"frame_000000.ppm", "frame_000001.ppm", "frame_000002.ppm"}) {
+    auto contents = read_file(directory / name);
+    EXPECT_EQ(contents.size(), std::string("P6\n4 4\n255\n").size() + 4 * 4 * 3) << name;
+  }
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST(test_readback, test_readback_exporter_stream) {
+  auto file = std::filesystem::temp_directory_path() / "test_readback_exporter_stream.raw";
+
+  std::vector<uint8_t> first(2 * 2 * 4, 1), second(2 * 2 * 4, 2);
+  {
+    auto exporter = readback::FrameExporter();
+    exporter.create(readback::ExportFormat::Stream, file);
+    exporter.submit(readback::Frame{first.data(), 2, 2, readback::PixelOrder::Rgba, 0}, nullptr);
+    exporter.submit(readback::Frame{second.data(), 2, 2, readback::PixelOrder::Rgba, 1}, nullptr);
+    // destroy() writes what was submitted before returning
+  }
+
+  // frames back to back in submission order, no headers
+  auto contents = read_file(file);
+  ASSERT_EQ(contents.size(), first.size() + second.size());
+  EXPECT_TRUE(std::equal(first.begin(), first.end(), contents.begin()));
+  EXPECT_TRUE(std::equal(second.begin(), second.end(), contents.begin() + first.size()));
+
+  std::filesystem::remove(file);
+}
+
+TEST(test_readback, test_readback_exporter_rejects_stdout) {
+  // stdout carries the log, frames streamed there would be corrupted by it
+  auto exporter = readback::FrameExporter();
+  EXPECT_THROW(exporter.create(readback::ExportFormat::Stream, "-"), std::runtime_error);
+#ifdef __linux__
+  EXPECT_THROW(exporter.create(readback::ExportFormat::Stream, "/dev/stdout"), std::runtime_error);
+#endif
+}
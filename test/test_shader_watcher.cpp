@@ -0,0 +1,44 @@
+#include <filesystem>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "shader_watcher.h"
+
+TEST(test_shader_watcher, test_stage_and_output) {
+  EXPECT_EQ(shader_watcher::stage_for("../shaders/vert.glsl"), "vertex");
+  EXPECT_EQ(shader_watcher::stage_for("../shaders/frag.glsl"), "fragment");
+  EXPECT_EQ(shader_watcher::stage_for("cull_comp.glsl"), std::nullopt);
+  EXPECT_EQ(shader_watcher::output_for("../shaders/frag.glsl"), std::filesystem::path("../shaders/frag.spv"));
+}
+
+TEST(test_shader_watcher, test_reports_changed_spirv) {
+  auto directory = std::filesystem::temp_directory_path() / "test_shader_watcher";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+
+  auto pool = thread_pool::ThreadPool(1);
+  auto watcher = shader_watcher::ShaderWatcher();
+  watcher.create(directory, pool);
+
+#ifndef __linux__
+  std::this_thread::sleep_for(std::chrono::milliseconds(300)); // let the polling fallback take its first look
+#endif
+  std::ofstream(directory / "frag.spv") << "not really spir-v";
+  std::ofstream(directory / "notes.txt") << "ignored";
+
+  std::vector<std::filesystem::path> changed;
+  for(int i = 0; i < 40 && changed.empty(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    watcher.poll(changed);
+  }
+
+  ASSERT_EQ(changed.size(), 1);
+  EXPECT_EQ(changed[0].filename(), "frag.spv");
+
+  watcher.destroy();
+  std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,63 @@
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "texture_loader.h"
+
+static auto solid_image(uint32_t size) -> texture_loader::Image {
+  return texture_loader::Image{std::vector<unsigned char>(static_cast<std::size_t>(size) * size * 4, 255), size, size, {}};
+}
+
+TEST(test_texture_loader, test_texture_loader_completes_every_request) {
+  thread_pool::ThreadPool pool(3);
+  texture_loader::TextureLoader loader;
+  loader.create(pool, false);
+
+  for(std::size_t i = 0; i < 16; ++i)
+    loader.request(i, [] { return solid_image(8); });
+  loader.request(16, [] () -> texture_loader::Image { throw std::runtime_error("Error - broken"); });
+  loader.wait();
+  EXPECT_EQ(loader.outstanding(), 17u); // finished, not taken yet
+
+  std::vector<texture_loader::Completed> completed;
+  loader.take_completed(completed);
+  EXPECT_EQ(loader.outstanding(), 0u);
+  ASSERT_EQ(completed.size(), 17u);
+
+  std::sort(completed.begin(), completed.end(), [](const auto& a, const auto& b) { return a.id < b.id; });
+  for(std::size_t i = 0; i < 16; ++i) {
+    EXPECT_EQ(completed[i].id, i);
+    EXPECT_TRUE(completed[i].error.empty());
+    EXPECT_EQ(completed[i].image.pixels.size(), 8u * 8 * 4);
+    EXPECT_TRUE(completed[i].image.levels.empty()); // level 0 only, the gpu blits the rest
+  }
+  EXPECT_EQ(completed[16].error, "Error - broken");
+  EXPECT_TRUE(completed[16].image.pixels.empty());
+
+  loader.destroy();
+}
+
+TEST(test_texture_loader, test_texture_loader_generates_mips) {
+  thread_pool::ThreadPool pool(2);
+  texture_loader::TextureLoader loader;
+  loader.create(pool, true);
+
+  loader.request(0, [] { return solid_image(16); });
+  loader.request(1, "does/not/exist.png");
+  loader.wait();
+
+  std::vector<texture_loader::Completed> completed;
+  loader.take_completed(completed);
+  std::sort(completed.begin(), completed.end(), [](const auto& a, const auto& b) { return a.id < b.id; });
+  ASSERT_EQ(completed.size(), 2u);
+
+  const auto& image = completed[0].image;
+  ASSERT_EQ(image.levels.size(), 5u); // 16, 8, 4, 2, 1
+  EXPECT_EQ(image.pixels.size(), image.levels.back().offset + image.levels.back().size);
+  EXPECT_FALSE(completed[1].error.empty());
+
+  loader.destroy();
+}
@@ -0,0 +1,29 @@
+#include <iostream>
+#include <atomic>
+
+#include "gtest/gtest.h"
+
+#include "thread_pool.h"
+
+TEST(test_thread_pool, test_thread_pool_runs_everything) {
+  auto pool = thread_pool::ThreadPool(4);
+  EXPECT_EQ(pool.size(), 4);
+
+  std::atomic<int> sum{0};
+  for(int i = 1; i <= 1000; ++i)
+    pool.submit([&sum, i]{ sum += i; });
+
+  pool.wait_idle();
+  EXPECT_EQ(sum.load(), 500500);
+}
+
+TEST(test_thread_pool, test_thread_pool_survives_throwing_task) {
+  auto pool = thread_pool::ThreadPool(1);
+
+  std::atomic<bool> ran{false};
+  pool.submit([]{ throw std::runtime_error("Error - expected"); });
+  pool.submit([&ran]{ ran = true; });
+
+  pool.wait_idle();
+  EXPECT_TRUE(ran.load());
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "triple_buffer.h"
+
+TEST(test_triple_buffer, test_triple_buffer_latest_wins) {
+  auto buffer = triple_buffer::TripleBuffer<int>(0);
+  EXPECT_FALSE(buffer.has_fresh());
+  EXPECT_EQ(buffer.read(), 0);
+
+  buffer.write_slot() = 1;
+  buffer.publish();
+  buffer.write_slot() = 2;
+  buffer.publish();
+  EXPECT_TRUE(buffer.has_fresh());
+
+  // 1 was never read, only the latest value is handed over
+  EXPECT_EQ(buffer.read(), 2);
+  EXPECT_FALSE(buffer.has_fresh());
+  EXPECT_EQ(buffer.read(), 2);
+}
+
+TEST(test_triple_buffer, test_triple_buffer_no_torn_reads) {
+  struct Snapshot {
+    uint64_t sequence{0};
+    std::vector<uint64_t> values;
+  };
+
+  auto buffer = triple_buffer::TripleBuffer<Snapshot>(Snapshot{0, std::vector<uint64_t>(64, 0)});
+  constexpr uint64_t LAST = 100000;
+
+  auto producer = std::thread([&buffer] {
+    for(uint64_t sequence = 1; sequence <= LAST; ++sequence) {
+      auto& slot = buffer.write_slot();
+      slot.sequence = sequence;
+      for(auto& value : slot.values)
+        value = sequence;
+      buffer.publish();
+    }
+  });
+
+  // every snapshot seen is whole, and never older than the one before it
+  uint64_t last_seen = 0;
+  while(last_seen != LAST) {
+    const auto& snapshot = buffer.read();
+    for(auto value : snapshot.values)
+      ASSERT_EQ(value, snapshot.sequence);
+    ASSERT_GE(snapshot.sequence, last_seen);
+    last_seen = snapshot.sequence;
+  }
+
+  producer.join();
+}
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "upload.h"
+
+TEST(test_upload, test_staging_ring_alignment) {
+  auto ring = upload::StagingRing(1024);
+
+  auto a = ring.allocate(10, 16);
+  auto b = ring.allocate(10, 16);
+  ASSERT_TRUE(a && b);
+  EXPECT_EQ(*a, 0);
+  EXPECT_EQ(*b, 16);
+  EXPECT_EQ(ring.in_use(), 26);
+}
+
+TEST(test_upload, test_staging_ring_wrap) {
+  auto ring = upload::StagingRing(1024);
+
+  ASSERT_TRUE(ring.allocate(600, 16).has_value());
+  auto first_batch = ring.head();
+
+  // the second range does not fit behind the first, and nothing is released yet
+  EXPECT_FALSE(ring.allocate(600, 16).has_value());
+
+  // once the first batch completes the ring wraps; the range starts back at 0, never straddling the end
+  ring.release(first_batch);
+  auto wrapped = ring.allocate(600, 16);
+  ASSERT_TRUE(wrapped.has_value());
+  EXPECT_EQ(*wrapped, 0);
+  EXPECT_EQ(ring.in_use(), 1024); // the skipped tail counts as used until this batch is released
+}
+
+TEST(test_upload, test_staging_ring_oversized) {
+  auto ring = upload::StagingRing(1024);
+
+  EXPECT_FALSE(ring.allocate(2048, 16).has_value());
+  EXPECT_TRUE(ring.allocate(1024, 16).has_value());
+  EXPECT_FALSE(ring.allocate(1, 1).has_value());
+}
+
+TEST(test_upload, test_mip_level_count) {
+  EXPECT_EQ(upload::mip_level_count(1, 1), 1u);
+  EXPECT_EQ(upload::mip_level_count(256, 256), 9u);
+  EXPECT_EQ(upload::mip_level_count(512, 64), 10u); // the larger side decides
+  EXPECT_EQ(upload::mip_level_count(5, 3), 3u); // 5x3, 2x1, 1x1
+}
+
+TEST(test_upload, test_generate_mip_chain_layout) {
+  std::vector<unsigned char> pixels(5 * 3 * 4, 255);
+  std::vector<upload::ImageLevel> levels;
+  auto chain = upload::generate_mip_chain(pixels.data(), 5, 3, false, levels);
+
+  ASSERT_EQ(levels.size(), 3u);
+  EXPECT_EQ(levels[1].width, 2u);
+  EXPECT_EQ(levels[1].height, 1u);
+  EXPECT_EQ(levels[1].offset, 5u * 3 * 4);
+  EXPECT_EQ(levels[2].offset, levels[1].offset + 2 * 1 * 4);
+  EXPECT_EQ(chain.size(), levels[2].offset + levels[2].size);
+  EXPECT_TRUE(std::all_of(chain.begin(), chain.end(), [](auto value) { return value == 255; }));
+}
+
+TEST(test_upload, test_generate_mip_chain_filtering) {
+  // a black and white checkerboard of 2x2 rgba texels; alpha is opaque everywhere
+  std::vector<unsigned char> pixels = {
+      0,   0,   0, 255,  255, 255, 255, 255,
+    255, 255, 255, 255,    0,   0,   0, 255
+  };
+  std::vector<upload::ImageLevel> levels;
+
+  auto linear = upload::generate_mip_chain(pixels.data(), 2, 2, false, levels);
+  ASSERT_EQ(levels.size(), 2u);
+  EXPECT_EQ(linear[levels[1].offset], 128);
+  EXPECT_EQ(linear[levels[1].offset + 3], 255);
+
+  // half the light is 50% linear, which is much brighter than 128 once encoded as srgb
+  auto srgb = upload::generate_mip_chain(pixels.data(), 2, 2, true, levels);
+  EXPECT_EQ(srgb[levels[1].offset], 188);
+  EXPECT_EQ(srgb[levels[1].offset + 3], 255);
+}
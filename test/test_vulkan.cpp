@@ -1,4 +1,5 @@
 
+#include <filesystem>
 #include <iostream>
 #include <stdexcept>
 
@@ -15,4 +16,128 @@ TEST(test_vulkan, test_app_creation) {
     std::cerr << e.what() << std::endl;
     EXPECT_TRUE(false);
   }
-}
\ No newline at end of file
+}
+
+TEST(test_vulkan, test_app_parallel_recording) {
+  try {
+    vulkan::ApplicationConfig config{};
+    config.record_threads = 4;
+    config.object_count = 1000;
+    config.frame_limit = 10;
+
+    vulkan::VulkanApplication app(config);
+    app.run();
+    EXPECT_GT(app.average_record_microseconds(), 0.0);
+  } catch(const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    EXPECT_TRUE(false);
+  }
+}
+
+TEST(test_vulkan, test_app_headless) {
+  try {
+    vulkan::ApplicationConfig config{};
+    config.headless = true;
+    config.frame_limit = 60;
+
+    vulkan::VulkanApplication app(config);
+    app.run();
+    EXPECT_GT(app.frames_per_second(), 0.0);
+    EXPECT_EQ(app.frame_statistics().frames(), 60u);
+    EXPECT_EQ(app.frame_statistics().histogram(frame_stats::Metric::CpuFrame).count(), 60u);
+    EXPECT_EQ(app.frame_statistics().histogram(frame_stats::Metric::Acquire).count(), 0u); // nothing to acquire headless
+  } catch(const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    EXPECT_TRUE(false);
+  }
+}
+
+TEST(test_vulkan, test_app_headless_synthetic_scene) {
+  try {
+    vulkan::ApplicationConfig config{};
+    config.headless = true;
+    config.frame_limit = 10;
+    config.object_count = 64;
+    config.scene_meshes = 5;
+    config.scene_textures = 3;
+    config.scene_materials = 4;
+    config.scene_texture_size = 64;
+
+    vulkan::VulkanApplication app(config);
+    app.run();
+    EXPECT_EQ(app.frame_statistics().frames(), 10u);
+    EXPECT_GT(app.upload_milliseconds(), 0.0);
+    EXPECT_GT(app.memory_usage().allocation_count, 0u);
+    EXPECT_GE(app.memory_usage().capacity, app.memory_usage().allocated_bytes);
+  } catch(const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    EXPECT_TRUE(false);
+  }
+}
+
+TEST(test_vulkan, test_app_headless_depth_prepass) {
+  try {
+    vulkan::ApplicationConfig config{};
+    config.headless = true;
+    config.frame_limit = 10;
+    config.object_count = 64;
+    config.scene_meshes = 3;
+    config.depth_prepass = true;
+    config.record_threads = 2; // the pre-pass has its own secondaries
+
+    vulkan::VulkanApplication app(config);
+    app.run();
+    EXPECT_EQ(app.frame_statistics().frames(), 10u);
+  } catch(const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    EXPECT_TRUE(false);
+  }
+}
+
+TEST(test_vulkan, test_app_headless_bindless) {
+  try {
+    vulkan::ApplicationConfig config{};
+    config.headless = true;
+    config.frame_limit = 10;
+    config.object_count = 64;
+    config.scene_textures = 3;
+    config.scene_materials = 4;
+    config.scene_texture_size = 64;
+    config.bindless = true; // falls back to a set per material without descriptor indexing
+
+    vulkan::VulkanApplication app(config);
+    app.run();
+    EXPECT_EQ(app.frame_statistics().frames(), 10u);
+  } catch(const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    EXPECT_TRUE(false);
+  }
+}
+
+TEST(test_vulkan, test_app_headless_export) {
+  auto directory = std::filesystem::temp_directory_path() / "test_app_headless_export";
+  std::filesystem::remove_all(directory);
+
+  try {
+    vulkan::ApplicationConfig config{};
+    config.headless = true;
+    config.frame_limit = 5;
+    config.export_format = readback::ExportFormat::Ppm;
+    config.export_path = directory.string();
+
+    vulkan::VulkanApplication app(config);
+    app.run();
+  } catch(const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    EXPECT_TRUE(false);
+  }
+
+  // every rendered frame, including the ones still in flight when the loop stopped
+  std::size_t files = 0;
+  for(auto& entry : std::filesystem::directory_iterator(directory)) {
+    EXPECT_EQ(entry.path().extension(), ".ppm");
+    ++files;
+  }
+  EXPECT_EQ(files, 5u);
+  std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,158 @@
+#include <filesystem>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <set>
+
+#include "stb_image.h"
+
+#include "asset_pack.h"
+
+static auto read_source(const std::filesystem::path& path) -> std::vector<unsigned char>;
+static auto collect_inputs(const std::vector<std::string>& arguments) -> std::vector<std::filesystem::path>;
+static auto is_texture(const std::filesystem::path& path) -> bool;
+static auto is_mesh(const std::filesystem::path& path) -> bool;
+static auto cook(const std::filesystem::path& path, const std::vector<unsigned char>& source, uint64_t hash) -> asset_pack::CookedAsset;
+
+// cooks textures (jpg, png, tga, bmp through stb_image) and obj meshes into one asset pack that
+// vulkan_run loads with --pack. each source is hashed; when the pack already holds an asset of the
+// same name and hash it is carried over as it is, and when nothing changed the pack is left alone
+//
+// asset_cooker --output path [--force] inputs...   (inputs are files or directories, not recursed)
+auto main(int argc, char** argv) -> int {
+  std::string output;
+  bool force = false;
+  std::vector<std::string> arguments;
+
+  for(int i = 1; i < argc; ++i) {
+    if(std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+      output = argv[++i];
+    } else if(std::strcmp(argv[i], "--force") == 0) {
+      force = true; // cook everything again, e.g. after changing the cooker
+    } else {
+      arguments.push_back(argv[i]);
+    }
+  }
+  if(output.empty() || arguments.empty()) {
+    std::cerr << "usage: " << argv[0] << " --output path [--force] inputs..." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  try {
+    asset_pack::Pack previous;
+    if(!force && std::filesystem::exists(output)) {
+      try {
+        previous.create(output);
+      } catch(const std::exception& e) {
+        std::cout << "[cooker] cooking everything, " << e.what() << "\n";
+      }
+    }
+
+    std::vector<asset_pack::CookedAsset> assets;
+    std::size_t cooked = 0;
+    std::set<std::string> names;
+
+    for(const auto& path : collect_inputs(arguments)) {
+      auto name = path.filename().string();
+      if(!names.insert(name).second)
+        throw std::runtime_error("Error - two inputs are named " + name);
+
+      auto source = read_source(path);
+      auto hash = asset_pack::content_hash(source.data(), source.size());
+
+      const auto* existing = previous.find(name);
+      if(existing != nullptr && existing->source_hash == hash) {
+        auto& asset = assets.emplace_back();
+        asset.entry = *existing;
+        asset.data.assign(previous.data(*existing), previous.data(*existing) + existing->size);
+        continue;
+      }
+
+      assets.push_back(cook(path, source, hash));
+      ++cooked;
+      std::cout << "[cooker] cooked " << name << "\n";
+    }
+
+    if(cooked == 0 && previous.is_open() && assets.size() == previous.entries().size()) {
+      std::cout << "[cooker] " << output << " is up to date, " << assets.size() << " asset(s)\n";
+      return EXIT_SUCCESS;
+    }
+
+    asset_pack::write(output, assets);
+    std::cout << "[cooker] wrote " << output << ": " << assets.size() << " asset(s), " << cooked << " cooked, "
+              << (assets.size() - cooked) << " unchanged, " << std::filesystem::file_size(output) << " bytes\n";
+  } catch(const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+static auto read_source(const std::filesystem::path& path) -> std::vector<unsigned char> {
+  std::ifstream file(path, std::ios::ate | std::ios::binary);
+  if(!file.is_open())
+    throw std::runtime_error("Error - unable to open " + path.string());
+
+  std::vector<unsigned char> bytes(static_cast<std::size_t>(file.tellg()));
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+  return bytes;
+}
+
+// directories contribute the textures and meshes directly inside them, in name order, so the pack
+// (and the index every asset ends up with at runtime) does not depend on the directory listing
+static auto collect_inputs(const std::vector<std::string>& arguments) -> std::vector<std::filesystem::path> {
+  std::vector<std::filesystem::path> inputs;
+  for(const auto& argument : arguments) {
+    if(!std::filesystem::is_directory(argument)) {
+      inputs.emplace_back(argument);
+      continue;
+    }
+
+    std::vector<std::filesystem::path> found;
+    for(const auto& entry : std::filesystem::directory_iterator(argument)) {
+      if(entry.is_regular_file() && (is_texture(entry.path()) || is_mesh(entry.path())))
+        found.push_back(entry.path());
+    }
+    std::sort(found.begin(), found.end());
+    inputs.insert(inputs.end(), found.begin(), found.end());
+  }
+  return inputs;
+}
+
+static auto is_texture(const std::filesystem::path& path) -> bool {
+  auto extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".tga" || extension == ".bmp";
+}
+
+static auto is_mesh(const std::filesystem::path& path) -> bool {
+  return path.extension() == ".obj";
+}
+
+static auto cook(const std::filesystem::path& path, const std::vector<unsigned char>& source, uint64_t hash) -> asset_pack::CookedAsset {
+  auto name = path.filename().string();
+
+  if(is_mesh(path)) {
+    std::vector<asset_pack::Vertex> vertices;
+    std::vector<uint16_t> indices;
+    asset_pack::parse_obj(std::string(source.begin(), source.end()), vertices, indices);
+    return asset_pack::cook_mesh(name, hash, vertices, indices);
+  }
+
+  if(!is_texture(path))
+    throw std::runtime_error("Error - no cooker for " + path.string());
+
+  int width, height, channels;
+  auto* pixels = stbi_load_from_memory(source.data(), static_cast<int>(source.size()), &width, &height, &channels, STBI_rgb_alpha);
+  if(!pixels)
+    throw std::runtime_error("Error - failed to decode " + path.string() + ": " + stbi_failure_reason());
+
+  auto asset = asset_pack::cook_texture(name, hash, pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+  stbi_image_free(pixels);
+  return asset;
+}